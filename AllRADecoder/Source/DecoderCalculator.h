@@ -0,0 +1,686 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/HammerAitov.h"
+#include "../../resources/NewtonApple/NewtonApple_hull3D.h"
+#include "../../resources/ReferenceCountedDecoder.h"
+#include "../../resources/efficientSHvanilla.h"
+#include "TriangleLookup.h"
+#include "tDesign5200.h"
+#include <numeric>
+
+/**
+ Calculates AllRAD decoders on a background thread.
+ Each request gets a snapshot of the layout and a new generation number. Requesting another
+ decoder or calling cancel() makes the running calculation stale: it stops at the next check
+ and its results are dropped. A finished decoder is handed to the onDecoderCalculated callback
+ right away (on the background thread, without holding any lock), afterwards the energy and rE
+ preview is rendered on a coarse grid first and refined to full resolution. The previews are
+ picked up on the message thread with pullPreview().
+ */
+class DecoderCalculator : private juce::Thread
+{
+public:
+    struct Job
+    {
+        std::vector<R3> points;
+        std::vector<Tri> triangles;
+        int order = 1;
+        ReferenceCountedDecoder::Weights weights = ReferenceCountedDecoder::Weights::maxrE;
+    };
+
+    /**
+     Gets called on the background thread with each decoder which wasn't stale when it was
+     finished. It runs without the job lock, so requesting or cancelling a decoder never waits for
+     it; a decoder which becomes stale meanwhile still gets published, the next request replaces it.
+     */
+    std::function<void (ReferenceCountedDecoder::Ptr)> onDecoderCalculated;
+
+    DecoderCalculator (const int previewWidth, const int previewHeight) :
+        juce::Thread ("AllRADecoder Calculation"),
+        energyDistribution (juce::Image::PixelFormat::ARGB, previewWidth, previewHeight, true),
+        rEVector (juce::Image::PixelFormat::ARGB, previewWidth, previewHeight, true)
+    {
+        startThread();
+    }
+
+    ~DecoderCalculator() override { stopThread (4000); }
+
+    /** Queues a new calculation, replacing a queued or running one. */
+    void requestDecoder (Job newJob)
+    {
+        {
+            const juce::ScopedLock lock (jobLock);
+            pendingJob = std::move (newJob);
+            hasPendingJob = true;
+            ++generation;
+        }
+        notify();
+    }
+
+    /** Makes a queued or running calculation stale, e.g. when the layout has changed. */
+    void cancel()
+    {
+        const juce::ScopedLock lock (jobLock);
+        hasPendingJob = false;
+        ++generation;
+    }
+
+    /**
+     Copies the latest preview into the given images, which have to be of the preview's size.
+     Returns true if there was a new one. Call this from the message thread.
+     */
+    bool pullPreview (juce::Image& energyImage, juce::Image& rEImage)
+    {
+        const juce::ScopedLock lock (previewLock);
+        if (! newPreviewAvailable)
+            return false;
+
+        copyPixels (energyDistribution, energyImage);
+        copyPixels (rEVector, rEImage);
+        newPreviewAvailable = false;
+        return true;
+    }
+
+    /**
+     Renders the energy and rE maps of the latest decoder into the given images, e.g. at a higher
+     resolution for exporting them. Returns false if there's no decoder yet.
+     */
+    bool renderMaps (juce::Image& energyImage, juce::Image& rEImage)
+    {
+        MapSource::Ptr source;
+        {
+            const juce::ScopedLock lock (previewLock);
+            source = mapSource;
+        }
+
+        if (source == nullptr)
+            return false;
+
+        const int w = energyImage.getWidth();
+        const int h = energyImage.getHeight();
+        jassert (rEImage.getBounds() == energyImage.getBounds());
+
+        // the spherical harmonics are evaluated in bands of rows, so they don't take up much memory
+        constexpr int rowsPerBand = 16;
+        std::vector<float> levels (static_cast<size_t> (w * h));
+        std::vector<float> widths (static_cast<size_t> (w * h));
+        std::vector<float> gains;
+        for (int row = 0; row < h; row += rowsPerBand)
+        {
+            const SHGrid band (w, h, 1, source->order, row, juce::jmin (h, row + rowsPerBand));
+            evaluate (band,
+                      *source,
+                      0,
+                      band.getNumPoints(),
+                      gains,
+                      levels.data() + row * w,
+                      widths.data() + row * w);
+        }
+
+        const float meanLvl = std::accumulate (levels.begin(), levels.end(), 0.0f) / (w * h);
+
+        juce::Image::BitmapData energyData (energyImage, juce::Image::BitmapData::writeOnly);
+        juce::Image::BitmapData rEData (rEImage, juce::Image::BitmapData::writeOnly);
+        paintMaps (w, h, 1, levels.data(), widths.data(), meanLvl, energyData, rEData);
+        return true;
+    }
+
+private:
+    static constexpr int coarseStep = 4;
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            while (! threadShouldExit())
+            {
+                Job job;
+                int jobGeneration;
+                {
+                    const juce::ScopedLock lock (jobLock);
+                    if (! hasPendingJob)
+                        break;
+
+                    job = std::move (pendingJob);
+                    jobGeneration = generation;
+                    hasPendingJob = false;
+                }
+
+                calculate (job, jobGeneration);
+            }
+        }
+    }
+
+    bool isStale (const int jobGeneration) const
+    {
+        return threadShouldExit() || generation.load() != jobGeneration;
+    }
+
+    void calculate (const Job& job, const int jobGeneration)
+    {
+        auto newDecoder = calculateDecoder (job, jobGeneration);
+        if (newDecoder == nullptr)
+            return;
+
+        std::function<void (ReferenceCountedDecoder::Ptr)> publish;
+        {
+            const juce::ScopedLock lock (jobLock);
+            if (isStale (jobGeneration))
+                return;
+
+            publish = onDecoderCalculated;
+        }
+
+        if (publish != nullptr)
+            publish (newDecoder);
+
+        MapSource::Ptr newMapSource = new MapSource (job, newDecoder->getMatrix());
+        {
+            const juce::ScopedLock lock (previewLock);
+            mapSource = newMapSource;
+        }
+
+        for (const int step : { coarseStep, 1 })
+            if (! renderPreview (*newMapSource, step, jobGeneration))
+                return;
+    }
+
+    /** Returns nullptr if the calculation became stale. */
+    ReferenceCountedDecoder::Ptr calculateDecoder (const Job& job, const int jobGeneration)
+    {
+        const auto& points = job.points;
+        const auto& triangles = job.triangles;
+
+        const int N = job.order;
+        const int nCoeffs = juce::square (N + 1);
+        const int nLsps = (int) points.size();
+        int nRealLsps = 0;
+        for (const auto& point : points)
+            if (! point.isImaginary)
+                ++nRealLsps;
+
+        juce::dsp::Matrix<float> decoderMatrix (nRealLsps, nCoeffs);
+
+        triangleLookup.build (points, triangles);
+
+        // loudspeakers connected to each imaginary loudspeaker, the imaginary one's gain is
+        // distributed among them
+        std::vector<juce::Array<int>> connectedLspsOfImaginary (static_cast<size_t> (nLsps));
+        for (int i = 0; i < nLsps; ++i)
+        {
+            if (! points[i].isImaginary)
+                continue;
+
+            auto& connectedLsps = connectedLspsOfImaginary[static_cast<size_t> (i)];
+            for (const auto& probe : triangles)
+            {
+                if (probe.a == i || probe.b == i || probe.c == i)
+                {
+                    connectedLsps.addIfNotAlreadyThere (probe.a);
+                    connectedLsps.addIfNotAlreadyThere (probe.b);
+                    connectedLsps.addIfNotAlreadyThere (probe.c);
+                }
+            }
+            connectedLsps.removeFirstMatchingValue (i); // remove imaginary loudspeaker again
+        }
+
+        std::vector<float> sh;
+        sh.resize (nCoeffs);
+        juce::Array<float> gainVector;
+
+        for (int i = 0; i < 5200; ++i) //iterate over each tDesign point
+        {
+            if ((i & 255) == 0 && isStale (jobGeneration))
+                return nullptr;
+
+            const float* source = tDesign5200[i];
+            SHEval (N, source[0], source[1], source[2], &sh[0], false);
+
+            const auto found = triangleLookup.find (source[0], source[1], source[2]);
+            jassert (found.triangle >= 0);
+            if (found.triangle < 0)
+                continue;
+
+            const Tri& tri = triangles[static_cast<size_t> (found.triangle)];
+            const int triangleIndices[3] = { tri.a, tri.b, tri.c };
+
+            // we found the corresponding triangle!
+            const float foo =
+                1.0f
+                / std::sqrt (juce::square (found.gains[0]) + juce::square (found.gains[1])
+                             + juce::square (found.gains[2]));
+            float gains[3];
+            for (int j = 0; j < 3; ++j)
+                gains[j] = found.gains[j] * foo;
+
+            int imagGainIdx = -1; // which of the three corresponds to the imaginary loudspeaker
+            for (int j = 0; j < 3; ++j)
+                if (points[triangleIndices[j]].isImaginary)
+                {
+                    imagGainIdx = j;
+                    break;
+                }
+
+            if (imagGainIdx >= 0)
+            {
+                const int imaginaryLspIdx = triangleIndices[imagGainIdx];
+                const int realGainIndex[2] = { imagGainIdx == 0 ? 1 : 0,
+                                               imagGainIdx == 2 ? 1 : 2 };
+
+                const auto& connectedLsps =
+                    connectedLspsOfImaginary[static_cast<size_t> (imaginaryLspIdx)];
+                gainVector.resize (connectedLsps.size());
+
+                const float kappa = getKappa (gains[imagGainIdx],
+                                              gains[realGainIndex[0]],
+                                              gains[realGainIndex[1]],
+                                              connectedLsps.size());
+
+                gainVector.fill (gains[imagGainIdx] * (points[imaginaryLspIdx].gain) * kappa);
+
+                for (int j = 0; j < 2; ++j)
+                {
+                    const int idx = connectedLsps.indexOf (triangleIndices[realGainIndex[j]]);
+                    gainVector.set (idx, gainVector[idx] + gains[realGainIndex[j]]);
+                }
+
+                for (int n = 0; n < connectedLsps.size(); ++n)
+                    juce::FloatVectorOperations::addWithMultiply (
+                        &decoderMatrix (points[connectedLsps[n]].realLspNum, 0),
+                        &sh[0],
+                        gainVector[n],
+                        nCoeffs);
+            }
+            else
+            {
+                for (int j = 0; j < 3; ++j)
+                    juce::FloatVectorOperations::addWithMultiply (
+                        &decoderMatrix (points[triangleIndices[j]].realLspNum, 0),
+                        &sh[0],
+                        gains[j],
+                        nCoeffs);
+            }
+        }
+
+        // calculate max lsp gain
+        float maxGain = 0.0f;
+        for (int i = 0; i < nLsps; ++i)
+        {
+            const R3 point = points[i];
+            if (! point.isImaginary)
+            {
+                SHEval (N, point.x, point.y, point.z, &sh[0]); // encoding at loudspeaker position
+                float sumOfSquares = 0.0f;
+                for (int m = 0; m < nRealLsps; ++m)
+                {
+                    float sum = 0.0f;
+                    for (int n = 0; n < nCoeffs; ++n)
+                        sum += sh[n] * decoderMatrix (m, n);
+                    sumOfSquares += juce::square (sum);
+                }
+                sumOfSquares = sqrt (sumOfSquares);
+                if (sumOfSquares > maxGain)
+                    maxGain = sumOfSquares;
+            }
+        }
+
+        decoderMatrix = decoderMatrix * (1.0f / maxGain);
+
+        ReferenceCountedDecoder::Ptr newDecoder = new ReferenceCountedDecoder (
+            "Decoder",
+            "A " + getOrderString (N) + " order Ambisonics decoder using the AllRAD approach.",
+            (int) decoderMatrix.getSize()[0],
+            (int) decoderMatrix.getSize()[1]);
+        newDecoder->getMatrix() = decoderMatrix;
+        ReferenceCountedDecoder::Settings newSettings;
+        newSettings.expectedNormalization = ReferenceCountedDecoder::Normalization::n3d;
+        newSettings.weights = job.weights;
+        newSettings.weightsAlreadyApplied = false;
+
+        newDecoder->setSettings (newSettings);
+
+        juce::Array<int>& routing = newDecoder->getRoutingArrayReference();
+        routing.resize (nRealLsps);
+        for (int i = 0; i < nLsps; ++i)
+        {
+            if (! points[i].isImaginary)
+                routing.set (points[i].realLspNum, points[i].channel - 1); // zero count
+        }
+
+        return newDecoder;
+    }
+
+    /**
+     What the energy and rE maps get rendered from: the transposed decoder matrix with the
+     Ambisonic weights applied to its rows, and the directions of the real loudspeakers.
+     */
+    struct MapSource : public juce::ReferenceCountedObject
+    {
+        typedef juce::ReferenceCountedObjectPtr<MapSource> Ptr;
+
+        MapSource (const Job& job, const juce::dsp::Matrix<float>& decoderMatrix) :
+            order (job.order),
+            numLoudspeakers ((int) decoderMatrix.getSize()[0]),
+            decoderTransposed (decoderMatrix.getSize()[1], decoderMatrix.getSize()[0])
+        {
+            const int nCoeffs = juce::square (order + 1);
+            std::vector<float> weights (static_cast<size_t> (nCoeffs), 1.0f);
+            if (job.weights == ReferenceCountedDecoder::Weights::maxrE)
+                multiplyMaxRE (order, weights.data());
+            else if (job.weights == ReferenceCountedDecoder::Weights::inPhase)
+                multiplyInPhase (order, weights.data());
+
+            for (int n = 0; n < nCoeffs; ++n)
+                for (int m = 0; m < numLoudspeakers; ++m)
+                    decoderTransposed (n, m) = decoderMatrix (m, n) * weights[n];
+
+            x.resize (static_cast<size_t> (numLoudspeakers));
+            y.resize (static_cast<size_t> (numLoudspeakers));
+            z.resize (static_cast<size_t> (numLoudspeakers));
+            for (const auto& point : job.points)
+            {
+                if (point.isImaginary)
+                    continue;
+
+                const auto direction =
+                    juce::Vector3D<float> (point.x, point.y, point.z).normalised();
+                const auto idx = static_cast<size_t> (point.realLspNum); // zero count
+                x[idx] = direction.x;
+                y[idx] = direction.y;
+                z[idx] = direction.z;
+            }
+        }
+
+        const int order;
+        const int numLoudspeakers;
+        juce::dsp::Matrix<float> decoderTransposed;
+        std::vector<float> x, y, z;
+    };
+
+    /**
+     Spherical harmonics of the Hammer-Aitov map's pixels, evaluating every step-th pixel in
+     each direction within the rows [firstRow, endRow). Each evaluated pixel stands for the
+     block of step x step pixels it starts, its direction is the block's centre.
+     */
+    struct SHGrid
+    {
+        SHGrid (const int mapWidth,
+                const int mapHeight,
+                const int gridStep,
+                const int shOrder,
+                const int firstRow,
+                const int endRow) :
+            width (mapWidth),
+            height (mapHeight),
+            step (gridStep),
+            order (shOrder),
+            numCoeffs (juce::square (shOrder + 1)),
+            numColumns ((mapWidth + gridStep - 1) / gridStep),
+            numRows ((endRow - firstRow + gridStep - 1) / gridStep),
+            rowOffset (firstRow)
+        {
+            sh.resize (static_cast<size_t> (getNumPoints() * numCoeffs));
+
+            const float wHalf = width / 2;
+            const float hHalf = height / 2;
+            for (int p = 0; p < getNumPoints(); ++p)
+            {
+                const int xPos = getX (p);
+                const int yPos = getY (p);
+                const float xCentre = xPos + 0.5f * (juce::jmin (step, width - xPos) - 1);
+                const float yCentre = yPos + 0.5f * (juce::jmin (step, height - yPos) - 1);
+
+                float azimuth, elevation;
+                HammerAitov::XYToSpherical ((xCentre - wHalf) / wHalf,
+                                            (hHalf - yCentre) / hHalf,
+                                            azimuth,
+                                            elevation);
+                SHEval (order,
+                        std::cos (elevation) * std::cos (azimuth),
+                        std::cos (elevation) * std::sin (azimuth),
+                        std::sin (elevation),
+                        &sh[static_cast<size_t> (p * numCoeffs)]);
+            }
+        }
+
+        bool matches (const int mapWidth,
+                      const int mapHeight,
+                      const int gridStep,
+                      const int shOrder) const
+        {
+            return width == mapWidth && height == mapHeight && step == gridStep && order == shOrder
+                   && rowOffset == 0 && numRows * step >= height;
+        }
+
+        int getNumPoints() const { return numColumns * numRows; }
+        int getX (const int point) const { return (point % numColumns) * step; }
+        int getY (const int point) const { return rowOffset + (point / numColumns) * step; }
+
+        const int width, height, step, order, numCoeffs, numColumns, numRows, rowOffset;
+        std::vector<float> sh; // numPoints x numCoeffs
+    };
+
+    static constexpr int pointsPerBatch = 256;
+
+    /**
+     Calculates the level and the acos-rE source width of the grid's points [begin, end): the
+     loudspeaker gains of a batch of points are the product of their SH vectors and the
+     transposed decoder matrix.
+     */
+    static void evaluate (const SHGrid& grid,
+                          const MapSource& source,
+                          const int begin,
+                          const int end,
+                          std::vector<float>& gainsBuffer,
+                          float* levels,
+                          float* widths)
+    {
+        jassert (grid.order == source.order);
+        const int nLsps = source.numLoudspeakers;
+        const int nCoeffs = grid.numCoeffs;
+        const float* decoderRows = source.decoderTransposed.getRawDataPointer();
+        gainsBuffer.resize (static_cast<size_t> (pointsPerBatch * nLsps));
+
+        for (int batchStart = begin; batchStart < end; batchStart += pointsPerBatch)
+        {
+            const int batchSize = juce::jmin (pointsPerBatch, end - batchStart);
+
+            // gains (batchSize x nLsps) = sh (batchSize x nCoeffs) * decoderTransposed
+            for (int k = 0; k < batchSize; ++k)
+            {
+                const float* sh = &grid.sh[static_cast<size_t> ((batchStart + k) * nCoeffs)];
+                float* gains = &gainsBuffer[static_cast<size_t> (k * nLsps)];
+                juce::FloatVectorOperations::multiply (gains, decoderRows, sh[0], nLsps);
+                for (int n = 1; n < nCoeffs; ++n)
+                    juce::FloatVectorOperations::addWithMultiply (gains,
+                                                                  decoderRows + n * nLsps,
+                                                                  sh[n],
+                                                                  nLsps);
+            }
+
+            for (int k = 0; k < batchSize; ++k)
+            {
+                float* gains = &gainsBuffer[static_cast<size_t> (k * nLsps)];
+                juce::FloatVectorOperations::multiply (gains, gains, nLsps); // squared
+
+                float sumOfSquares = 0.0f;
+                juce::Vector3D<float> rE (0.0f, 0.0f, 0.0f);
+                for (int m = 0; m < nLsps; ++m)
+                {
+                    sumOfSquares += gains[m];
+                    rE.x += gains[m] * source.x[static_cast<size_t> (m)];
+                    rE.y += gains[m] * source.y[static_cast<size_t> (m)];
+                    rE.z += gains[m] * source.z[static_cast<size_t> (m)];
+                }
+
+                rE /= sumOfSquares + FLT_EPSILON;
+                const float width = 2.0f * std::acos (juce::jmin (1.0f, rE.length()));
+
+                const int p = batchStart + k;
+                levels[p] = 0.5f * juce::Decibels::gainToDecibels (sumOfSquares);
+                widths[p] = juce::jlimit (0.0f, 1.0f, width / juce::MathConstants<float>::pi);
+            }
+        }
+    }
+
+    /**
+     Colours the step x step pixel blocks of a map: the energy map shows the deviation of the
+     level from the mean level, the rE map the source width.
+     */
+    static void paintMaps (const int width,
+                           const int height,
+                           const int step,
+                           const float* levels,
+                           const float* widths,
+                           const float meanLvl,
+                           juce::Image::BitmapData& energyData,
+                           juce::Image::BitmapData& rEData)
+    {
+        constexpr float plusMinusRange = 1.5f;
+
+        const int numColumns = (width + step - 1) / step;
+        const int numPoints = numColumns * ((height + step - 1) / step);
+        for (int p = 0; p < numPoints; ++p)
+        {
+            const float map =
+                (juce::jlimit (-plusMinusRange, plusMinusRange, levels[p] - meanLvl)
+                 + plusMinusRange)
+                / (2 * plusMinusRange);
+            const juce::Colour pixelColour = juce::Colours::red.withMultipliedAlpha (map);
+            const juce::Colour rEPixelColour =
+                juce::Colours::limegreen.withMultipliedAlpha (widths[p]);
+
+            const int x0 = (p % numColumns) * step;
+            const int y0 = (p / numColumns) * step;
+            const int x1 = juce::jmin (x0 + step, width);
+            const int y1 = juce::jmin (y0 + step, height);
+            for (int y = y0; y < y1; ++y)
+                for (int x = x0; x < x1; ++x)
+                {
+                    energyData.setPixelColour (x, y, pixelColour);
+                    rEData.setPixelColour (x, y, rEPixelColour);
+                }
+        }
+    }
+
+    /**
+     Renders the preview maps on the grid with the given step. Returns false if the calculation
+     became stale.
+     */
+    bool renderPreview (const MapSource& source, const int step, const int jobGeneration)
+    {
+        const int w = energyDistribution.getWidth();
+        const int h = energyDistribution.getHeight();
+
+        // the grids don't depend on the layout, they only get recalculated for another order
+        auto& grid = previewGrids[step == 1 ? 1 : 0];
+        if (grid == nullptr || ! grid->matches (w, h, step, source.order))
+            grid = std::make_unique<SHGrid> (w, h, step, source.order, 0, h);
+
+        const int numPoints = grid->getNumPoints();
+        levelValues.resize (static_cast<size_t> (numPoints));
+        widthValues.resize (static_cast<size_t> (numPoints));
+
+        for (int begin = 0; begin < numPoints; begin += 8 * pointsPerBatch)
+        {
+            if (isStale (jobGeneration))
+                return false;
+
+            evaluate (*grid,
+                      source,
+                      begin,
+                      juce::jmin (numPoints, begin + 8 * pointsPerBatch),
+                      gainsBuffer,
+                      levelValues.data(),
+                      widthValues.data());
+        }
+
+        DBG ("min: " << *std::min_element (levelValues.begin(), levelValues.end())
+                     << " max: " << *std::max_element (levelValues.begin(), levelValues.end()));
+        const float meanLvl =
+            std::accumulate (levelValues.begin(), levelValues.end(), 0.0f) / numPoints;
+
+        juce::Image newEnergyDistribution (juce::Image::PixelFormat::ARGB, w, h, true);
+        juce::Image newREVector (juce::Image::PixelFormat::ARGB, w, h, true);
+        {
+            juce::Image::BitmapData energyData (newEnergyDistribution,
+                                                juce::Image::BitmapData::writeOnly);
+            juce::Image::BitmapData rEData (newREVector, juce::Image::BitmapData::writeOnly);
+            paintMaps (w,
+                       h,
+                       step,
+                       levelValues.data(),
+                       widthValues.data(),
+                       meanLvl,
+                       energyData,
+                       rEData);
+        }
+
+        const juce::ScopedLock lock (previewLock);
+        if (isStale (jobGeneration))
+            return false;
+
+        energyDistribution = newEnergyDistribution;
+        rEVector = newREVector;
+        newPreviewAvailable = true;
+        return true;
+    }
+
+    static void copyPixels (const juce::Image& source, juce::Image& destination)
+    {
+        jassert (source.getBounds() == destination.getBounds());
+        const juce::Image::BitmapData src (source, juce::Image::BitmapData::readOnly);
+        juce::Image::BitmapData dest (destination, juce::Image::BitmapData::writeOnly);
+        for (int y = 0; y < src.height; ++y)
+            std::memcpy (dest.getLinePointer (y),
+                         src.getLinePointer (y),
+                         static_cast<size_t> (src.width * src.pixelStride));
+    }
+
+    static float getKappa (float gIm, float gRe1, float gRe2, int N)
+    {
+        const float p = gIm * (gRe1 + gRe2) / (N * juce::square (gIm));
+        const float q =
+            (juce::square (gRe1) + juce::square (gRe2) - 1.0f) / (N * juce::square (gIm));
+        return -p + std::sqrt (juce::jmax (juce::square (p) - q, 0.0f));
+    }
+
+    juce::CriticalSection jobLock;
+    Job pendingJob;
+    bool hasPendingJob = false;
+    std::atomic<int> generation { 0 };
+
+    TriangleLookup triangleLookup;
+
+    std::unique_ptr<SHGrid> previewGrids[2]; // coarse and full resolution
+    std::vector<float> levelValues, widthValues, gainsBuffer;
+
+    juce::CriticalSection previewLock;
+    MapSource::Ptr mapSource;
+    juce::Image energyDistribution, rEVector;
+    bool newPreviewAvailable = false;
+};
@@ -122,7 +122,8 @@ AllRADecoderAudioProcessorEditor::AllRADecoderAudioProcessorEditor (
     addAndMakeVisible (tbJson);
     tbJson.setButtonText ("EXPORT");
     tbJson.setColour (juce::TextButton::buttonColourId, juce::Colours::orange);
-    tbJson.setTooltip ("Stores the decoder and/or loudspeaker layout to a configuration file.");
+    tbJson.setTooltip (
+        "Stores the decoder and/or loudspeaker layout to a configuration file. \n Alt+click: saves the energy and rE maps as PNG images.");
     tbJson.addListener (this);
 
     addAndMakeVisible (tbImport);
@@ -270,6 +271,9 @@ void AllRADecoderAudioProcessorEditor::timerCallback()
         grid.repaint();
     }
 
+    if (processor.pullCalculationResults())
+        grid.repaint();
+
     if (processor.updateTable.get())
     {
         processor.updateTable = false;
@@ -303,6 +307,21 @@ void AllRADecoderAudioProcessorEditor::buttonClicked (juce::Button* button)
     {
         processor.calculateDecoder();
     }
+    else if (button == &tbJson && juce::ModifierKeys::getCurrentModifiers().isAltDown())
+    {
+        juce::FileChooser myChooser (
+            "Save energy and rE maps...",
+            processor.getLastDir().exists()
+                ? processor.getLastDir()
+                : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
+            "*.png");
+        if (myChooser.browseForFileToSave (true))
+        {
+            juce::File mapFile (myChooser.getResult());
+            processor.setLastDir (mapFile.getParentDirectory());
+            processor.saveEnergyMapsToFile (mapFile);
+        }
+    }
     else if (button == &tbJson)
     {
         juce::FileChooser myChooser (
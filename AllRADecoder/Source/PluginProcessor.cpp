@@ -42,9 +42,13 @@ AllRADecoderAudioProcessor::AllRADecoderAudioProcessor() :
             ,
 #endif
         createParameterLayout()),
-    energyDistribution (juce::Image::PixelFormat::ARGB, 200, 100, true),
-    rEVector (juce::Image::PixelFormat::ARGB, 200, 100, true)
+    energyDistribution (juce::Image::PixelFormat::ARGB, previewWidth, previewHeight, true),
+    rEVector (juce::Image::PixelFormat::ARGB, previewWidth, previewHeight, true),
+    decoderCalculator (previewWidth, previewHeight)
 {
+    decoderCalculator.onDecoderCalculated = [this] (ReferenceCountedDecoder::Ptr newDecoder)
+    { decoderCalculated (newDecoder); };
+
     // get pointers to the parameters
     inputOrderSetting = parameters.getRawParameterValue ("inputOrderSetting");
     useSN3D = parameters.getRawParameterValue ("useSN3D");
@@ -542,14 +546,6 @@ juce::Vector3D<float>
                                   sphervect.x * std::sin (juce::degreesToRadians (sphervect.z)));
 }
 
-juce::Vector3D<float>
-    AllRADecoderAudioProcessor::sphericalInRadiansToCartesian (juce::Vector3D<float> sphervect)
-{
-    return juce::Vector3D<float> (sphervect.x * std::cos (sphervect.z) * cos (sphervect.y),
-                                  sphervect.x * std::cos (sphervect.z) * sin (sphervect.y),
-                                  sphervect.x * std::sin (sphervect.z));
-}
-
 void AllRADecoderAudioProcessor::playNoiseBurst (const int channel)
 {
     noiseBurst.setChannel (channel);
@@ -638,6 +634,7 @@ void AllRADecoderAudioProcessor::convertLoudspeakersToArray()
 void AllRADecoderAudioProcessor::prepareLayout()
 {
     isLayoutReady = false;
+    decoderCalculator.cancel(); // a running calculation is based on the old layout
 
     wrapSphericalCoordinates();
     juce::Result res = checkLayout();
@@ -699,13 +696,13 @@ juce::Result AllRADecoderAudioProcessor::checkLayout()
         return juce::Result::fail ("ERROR 2: There are less than 4 loudspeakers! Add some more!");
     }
 
-    // calculate convex hull
-    const int result = NewtonApple_hull_3D (points, triangles);
-    if (result != 1)
+    // update the convex hull, small edits of the layout only re-triangulate locally
+    if (! hull.update (points))
     {
         return juce::Result::fail (
             "ERROR: An error occurred! The layout might be broken somehow. Try adding additional loudspeakers (e.g. imaginary ones) or make small changes to the coordinates.");
     }
+    triangles = hull.getTriangles();
 
     // normalise normal vectors
     for (int i = 0; i < triangles.size(); ++i)
@@ -792,317 +789,58 @@ juce::Result AllRADecoderAudioProcessor::calculateDecoder()
     if (! isLayoutReady)
         return juce::Result::fail ("Layout not ready!");
 
-    const int N = juce::roundToInt (decoderOrder->load()) + 1;
-    const auto ambisonicWeights =
-        ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load()));
-    const int nCoeffs = juce::square (N + 1);
-    const int nLsps = (int) points.size();
-    const int nRealLsps = nLsps - imaginaryFlags.countNumberOfSetBits();
-    DBG ("Number of loudspeakers: " << nLsps << ". Number of real loudspeakers: " << nRealLsps);
-    juce::dsp::Matrix<float> decoderMatrix (nRealLsps, nCoeffs);
-
-    juce::Array<juce::dsp::Matrix<float>> inverseArray;
-    for (int t = 0; t < triangles.size(); ++t) //iterate over each triangle
-    {
-        Tri tri = triangles[t];
-        juce::Array<int> triangleIndices (tri.a, tri.b, tri.c);
-        juce::dsp::Matrix<float> L (3, 3);
-        for (int i = 0; i < 3; ++i)
-        {
-            L (0, i) = points[triangleIndices[i]].x;
-            L (1, i) = points[triangleIndices[i]].y;
-            L (2, i) = points[triangleIndices[i]].z;
-            if (points[triangleIndices[i]].isImaginary)
-            {
-                const float factor = 1.0f
-                                     / std::sqrt (juce::square (points[triangleIndices[i]].x)
-                                                  + juce::square (points[triangleIndices[i]].y)
-                                                  + juce::square (points[triangleIndices[i]].z));
-                L (0, i) *= factor;
-                L (1, i) *= factor;
-                L (2, i) *= factor;
-            }
-        }
-
-        inverseArray.add (getInverse (L));
-    }
-
-    std::vector<float> sh;
-    sh.resize (nCoeffs);
-
-    for (int i = 0; i < 5200; ++i) //iterate over each tDesign point
-    {
-        const juce::dsp::Matrix<float> source (3, 1, tDesign5200[i]);
-        SHEval (N, source (0, 0), source (1, 0), source (2, 0), &sh[0], false);
-
-        const juce::dsp::Matrix<float> gains (3, 1);
-
-        int t = 0;
-        for (; t < triangles.size(); ++t) //iterate over each triangle
-        {
-            Tri tri = triangles[t];
-            juce::Array<int> triangleIndices (tri.a, tri.b, tri.c);
-            juce::Array<bool> imagFlags (points[tri.a].isImaginary,
-                                         points[tri.b].isImaginary,
-                                         points[tri.c].isImaginary);
-            juce::dsp::Matrix<float> gains (3, 1);
-            gains = inverseArray.getUnchecked (t) * source;
-
-            if (gains (0, 0) >= -FLT_EPSILON && gains (1, 0) >= -FLT_EPSILON
-                && gains (2, 0) >= -FLT_EPSILON)
-            {
-                // we found the corresponding triangle!
-                const float foo =
-                    1.0f
-                    / std::sqrt (juce::square (gains (0, 0)) + juce::square (gains (1, 0))
-                                 + juce::square (gains (2, 0)));
-                gains = gains * foo;
-
-                if (imagFlags.contains (true))
-                {
-                    const int imagGainIdx = imagFlags.indexOf (
-                        true); // which of the three corresponds to the imaginary loudspeaker
-                    const int imaginaryLspIdx = triangleIndices[imagGainIdx];
-
-                    juce::Array<int> realGainIndex (0, 1, 2);
-                    realGainIndex.remove (imagGainIdx);
-
-                    juce::Array<int> connectedLsps;
-                    connectedLsps.add (imaginaryLspIdx);
-                    for (int k = 0; k < triangles.size(); ++k) //iterate over each triangle
-                    {
-                        Tri probe = triangles[k];
-                        juce::Array<int> probeTriangleIndices (probe.a, probe.b, probe.c);
-                        if (probeTriangleIndices.contains (imaginaryLspIdx))
-                        { // found searched imaginaryLspIdx in that triangle
-                            for (int j = 0; j < 3; ++j)
-                            {
-                                if (! connectedLsps.contains (probeTriangleIndices[j]))
-                                    connectedLsps.add (probeTriangleIndices[j]);
-                            }
-                        }
-                    }
-
-                    connectedLsps.remove (0); // remove imaginary loudspeaker again
-                    juce::Array<float> gainVector;
-                    gainVector.resize (connectedLsps.size());
-
-                    const float kappa = getKappa (gains (imagGainIdx, 0),
-                                                  gains (realGainIndex[0], 0),
-                                                  gains (realGainIndex[1], 0),
-                                                  connectedLsps.size());
-
-                    gainVector.fill (gains (imagGainIdx, 0) * (points[imaginaryLspIdx].gain)
-                                     * kappa);
-
-                    for (int j = 0; j < 2; ++j)
-                    {
-                        const int idx = connectedLsps.indexOf (triangleIndices[realGainIndex[j]]);
-                        gainVector.set (idx, gainVector[idx] + gains (realGainIndex[j], 0));
-                    }
-
-                    for (int n = 0; n < connectedLsps.size(); ++n)
-                        juce::FloatVectorOperations::addWithMultiply (
-                            &decoderMatrix (points[connectedLsps[n]].realLspNum, 0),
-                            &sh[0],
-                            gainVector[n],
-                            nCoeffs);
-                }
-                else
-                {
-                    juce::FloatVectorOperations::addWithMultiply (
-                        &decoderMatrix (points[tri.a].realLspNum, 0),
-                        &sh[0],
-                        gains (0, 0),
-                        nCoeffs);
-                    juce::FloatVectorOperations::addWithMultiply (
-                        &decoderMatrix (points[tri.b].realLspNum, 0),
-                        &sh[0],
-                        gains (1, 0),
-                        nCoeffs);
-                    juce::FloatVectorOperations::addWithMultiply (
-                        &decoderMatrix (points[tri.c].realLspNum, 0),
-                        &sh[0],
-                        gains (2, 0),
-                        nCoeffs);
-                }
-                break;
-            }
-        }
-        jassert (t < triangles.size());
-    }
-
-    // calculate max lsp gain
-    float maxGain = 0.0f;
-    for (int i = 0; i < nLsps; ++i)
-    {
-        const R3 point = points[i];
-        if (! point.isImaginary)
-        {
-            SHEval (N, point.x, point.y, point.z, &sh[0]); // encoding at loudspeaker position
-            float sumOfSquares = 0.0f;
-            for (int m = 0; m < nRealLsps; ++m)
-            {
-                float sum = 0.0f;
-                for (int n = 0; n < nCoeffs; ++n)
-                    sum += sh[n] * decoderMatrix (m, n);
-                sumOfSquares += juce::square (sum);
-            }
-            sumOfSquares = sqrt (sumOfSquares);
-            if (sumOfSquares > maxGain)
-                maxGain = sumOfSquares;
-        }
-    }
+    DecoderCalculator::Job job;
+    job.points = points;
+    job.triangles = triangles;
+    job.order = juce::roundToInt (decoderOrder->load()) + 1;
+    job.weights = ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load()));
+    DBG ("Number of loudspeakers: " << (int) points.size() << ". Number of imaginary loudspeakers: "
+                                    << imaginaryFlags.countNumberOfSetBits());
 
-    decoderMatrix = decoderMatrix * (1.0f / maxGain);
-
-    // calculate energy and rE vector
-    juce::Array<juce::Vector3D<float>> realLspsCoordinates;
-    realLspsCoordinates.resize (nRealLsps);
-    for (int i = 0; i < nLsps; ++i)
-    {
-        if (! points[i].isImaginary)
-            realLspsCoordinates.set (points[i].realLspNum,
-                                     juce::Vector3D<float> (points[i].x, points[i].y, points[i].z)
-                                         .normalised()); // zero count
-    }
-
-    const int w = energyDistribution.getWidth();
-    const float wHalf = w / 2;
-    const int h = energyDistribution.getHeight();
-    const float hHalf = h / 2;
-    float minLvl = 0.0f;
-    float maxLvl = 0.0f;
-    float sumLvl = 0.0f;
-    auto levelValues = juce::dsp::Matrix<float> (w, h);
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x)
-        {
-            juce::Vector3D<float> spher (1.0f, 0.0f, 0.0f);
-            HammerAitov::XYToSpherical ((x - wHalf) / wHalf, (hHalf - y) / hHalf, spher.y, spher.z);
-            juce::Vector3D<float> cart = sphericalInRadiansToCartesian (spher);
-            SHEval (N, cart.x, cart.y, cart.z, &sh[0]); // encoding a source
-
-            if (ambisonicWeights == ReferenceCountedDecoder::Weights::maxrE)
-                multiplyMaxRE (N, sh.data());
-            else if (ambisonicWeights == ReferenceCountedDecoder::Weights::inPhase)
-                multiplyInPhase (N, sh.data());
-
-            juce::Vector3D<float> rE (0.0f, 0.0f, 0.0f);
-            float sumOfSquares = 0.0f;
-            for (int m = 0; m < nRealLsps; ++m)
-            {
-                float sum = 0.0f;
-                for (int n = 0; n < nCoeffs; ++n)
-                    sum += (sh[n] * decoderMatrix (m, n));
-                const float sumSquared = juce::square (sum);
-                rE += realLspsCoordinates[m] * sumSquared;
-                sumOfSquares += sumSquared;
-            }
-
-            const float lvl = 0.5f * juce::Decibels::gainToDecibels (sumOfSquares);
-            levelValues (x, y) = lvl;
-            sumLvl += lvl;
-
-            if (lvl > maxLvl)
-                maxLvl = lvl;
-            if (lvl < minLvl)
-                minLvl = lvl;
-
-            rE /= sumOfSquares + FLT_EPSILON;
-            const float width = 2.0f * std::acos (juce::jmin (1.0f, rE.length()));
-            const float reMap = juce::jlimit (0.0f, 1.0f, width / juce::MathConstants<float>::pi);
-
-            const juce::Colour rEPixelColour = juce::Colours::limegreen.withMultipliedAlpha (reMap);
-            rEVector.setPixelAt (x, y, rEPixelColour);
-        }
-
-    const float meanLvl = sumLvl / (w * h);
-    for (int y = 0; y < h; ++y)
-        for (int x = 0; x < w; ++x)
-        {
-            constexpr float plusMinusRange = 1.5f;
-            const float map =
-                (juce::jlimit (-plusMinusRange, plusMinusRange, levelValues (x, y) - meanLvl)
-                 + plusMinusRange)
-                / (2 * plusMinusRange);
-
-            const juce::Colour pixelColour = juce::Colours::red.withMultipliedAlpha (map);
-            energyDistribution.setPixelAt (x, y, pixelColour);
-        }
-
-    DBG ("min: " << minLvl << " max: " << maxLvl);
-
-    updateLoudspeakerVisualization = true;
-
-    ReferenceCountedDecoder::Ptr newDecoder = new ReferenceCountedDecoder (
-        "Decoder",
-        "A " + getOrderString (N) + " order Ambisonics decoder using the AllRAD approach.",
-        (int) decoderMatrix.getSize()[0],
-        (int) decoderMatrix.getSize()[1]);
-    newDecoder->getMatrix() = decoderMatrix;
-    ReferenceCountedDecoder::Settings newSettings;
-    newSettings.expectedNormalization = ReferenceCountedDecoder::Normalization::n3d;
-    newSettings.weights = ambisonicWeights;
-    newSettings.weightsAlreadyApplied = false;
-
-    newDecoder->setSettings (newSettings);
-
-    juce::Array<int>& routing = newDecoder->getRoutingArrayReference();
-    routing.resize (nRealLsps);
-    for (int i = 0; i < nLsps; ++i)
-    {
-        if (! points[i].isImaginary)
-            routing.set (points[i].realLspNum, points[i].channel - 1); // zero count
-    }
-
-    decoder.setDecoder (newDecoder);
-    decoderConfig = newDecoder;
-
-    updateChannelCount = true;
-
-    DBG ("finished");
+    decoderCalculator.requestDecoder (std::move (job));
 
     MailBox::Message newMessage;
-    newMessage.messageColour = juce::Colours::green;
-    newMessage.headline = "Decoder created";
-    newMessage.text = "The decoder was calculated successfully.";
+    newMessage.messageColour = juce::Colours::cornflowerblue;
+    newMessage.headline = "Calculating decoder";
+    newMessage.text = "The decoder is being calculated in the background.";
     messageToEditor = newMessage;
     updateMessage = true;
 
     return juce::Result::ok();
 }
 
-float AllRADecoderAudioProcessor::getKappa (float gIm, float gRe1, float gRe2, int N)
+void AllRADecoderAudioProcessor::decoderCalculated (ReferenceCountedDecoder::Ptr newDecoder)
 {
-    const float p = gIm * (gRe1 + gRe2) / (N * juce::square (gIm));
-    const float q = (juce::square (gRe1) + juce::square (gRe2) - 1.0f) / (N * juce::square (gIm));
-    return -p + std::sqrt (juce::jmax (juce::square (p) - q, 0.0f));
+    decoder.setDecoder (newDecoder);
+    {
+        const juce::SpinLock::ScopedLockType lock (decoderConfigLock);
+        decoderConfig = newDecoder;
+    }
+
+    updateChannelCount = true;
+    newDecoderCalculated = true;
+    DBG ("finished");
 }
 
-juce::dsp::Matrix<float> AllRADecoderAudioProcessor::getInverse (juce::dsp::Matrix<float> A)
+bool AllRADecoderAudioProcessor::pullCalculationResults()
 {
-    const float det = A (0, 0) * (A (1, 1) * A (2, 2) - A (1, 2) * A (2, 1))
-                      + A (0, 1) * (A (1, 2) * A (2, 0) - A (1, 0) * A (2, 2))
-                      + A (0, 2) * (A (1, 0) * A (2, 1) - A (1, 1) * A (2, 0));
-
-    const float factor = 1.0 / det;
-
-    juce::dsp::Matrix<float> inverse (3, 3);
-
-    inverse (0, 0) = (A (1, 1) * A (2, 2) - A (1, 2) * A (2, 1)) * factor;
-    inverse (0, 1) = (-A (0, 1) * A (2, 2) + A (0, 2) * A (2, 1)) * factor;
-    inverse (0, 2) = (A (0, 1) * A (1, 2) - A (0, 2) * A (1, 1)) * factor;
-
-    inverse (1, 0) = (-A (1, 0) * A (2, 2) + A (1, 2) * A (2, 0)) * factor;
-    inverse (1, 1) = (A (0, 0) * A (2, 2) - A (0, 2) * A (2, 0)) * factor;
-    inverse (1, 2) = (-A (0, 0) * A (1, 2) + A (0, 2) * A (1, 0)) * factor;
+    if (newDecoderCalculated.exchange (false))
+    {
+        MailBox::Message newMessage;
+        newMessage.messageColour = juce::Colours::green;
+        newMessage.headline = "Decoder created";
+        newMessage.text = "The decoder was calculated successfully.";
+        messageToEditor = newMessage;
+        updateMessage = true;
+    }
 
-    inverse (2, 0) = (A (1, 0) * A (2, 1) - A (1, 1) * A (2, 0)) * factor;
-    inverse (2, 1) = (-A (0, 0) * A (2, 1) + A (0, 1) * A (2, 0)) * factor;
-    inverse (2, 2) = (A (0, 0) * A (1, 1) - A (0, 1) * A (1, 0)) * factor;
+    return decoderCalculator.pullPreview (energyDistribution, rEVector);
+}
 
-    return inverse;
+ReferenceCountedDecoder::Ptr AllRADecoderAudioProcessor::getCurrentDecoder()
+{
+    const juce::SpinLock::ScopedLockType lock (decoderConfigLock);
+    return decoderConfig;
 }
 
 void AllRADecoderAudioProcessor::saveConfigurationToFile (juce::File destination)
@@ -1134,7 +872,7 @@ void AllRADecoderAudioProcessor::saveConfigurationToFile (juce::File destination
 
     if (*exportDecoder >= 0.5f)
     {
-        if (decoderConfig != nullptr)
+        if (auto decoderConfig = getCurrentDecoder())
             jsonObj->setProperty ("Decoder",
                                   ConfigurationHelper::convertDecoderToVar (decoderConfig));
         else
@@ -1171,6 +909,57 @@ void AllRADecoderAudioProcessor::saveConfigurationToFile (juce::File destination
         DBG ("Could not write configuration file.");
 }
 
+void AllRADecoderAudioProcessor::saveEnergyMapsToFile (juce::File destination)
+{
+    juce::Image energyMap (juce::Image::PixelFormat::ARGB,
+                           exportScale * previewWidth,
+                           exportScale * previewHeight,
+                           true);
+    juce::Image rEMap (juce::Image::PixelFormat::ARGB,
+                       exportScale * previewWidth,
+                       exportScale * previewHeight,
+                       true);
+
+    MailBox::Message newMessage;
+    if (! decoderCalculator.renderMaps (energyMap, rEMap))
+    {
+        newMessage.messageColour = juce::Colours::red;
+        newMessage.headline = "No decoder available for export.";
+        newMessage.text = "Please calculate a decoder first.";
+        messageToEditor = newMessage;
+        updateMessage = true;
+        return;
+    }
+
+    const auto energyFile = destination.withFileExtension ("png");
+    const auto rEFile = energyFile.getSiblingFile (energyFile.getFileNameWithoutExtension()
+                                                   + "_rE.png");
+
+    const auto writeImage = [] (const juce::Image& image, const juce::File& file)
+    {
+        file.deleteFile();
+        juce::FileOutputStream stream (file);
+        juce::PNGImageFormat png;
+        return stream.openedOk() && png.writeImageToStream (image, stream);
+    };
+
+    if (writeImage (energyMap, energyFile) && writeImage (rEMap, rEFile))
+    {
+        newMessage.messageColour = juce::Colours::green;
+        newMessage.headline = "Maps exported successfully";
+        newMessage.text = "The energy and rE maps were written to " + energyFile.getFileName()
+                          + " and " + rEFile.getFileName() + ".";
+    }
+    else
+    {
+        newMessage.messageColour = juce::Colours::red;
+        newMessage.headline = "Export failed";
+        newMessage.text = "The energy and rE maps could not be written.";
+    }
+    messageToEditor = newMessage;
+    updateMessage = true;
+}
+
 void AllRADecoderAudioProcessor::setLastDir (juce::File newLastDir)
 {
     lastDir = newLastDir;
@@ -26,6 +26,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 #include "../../resources/AmbisonicDecoder.h"
+#include "../../resources/NewtonApple/IncrementalHull3D.h"
 #include "../../resources/NewtonApple/NewtonApple_hull3D.h"
 #include "../../resources/ReferenceCountedDecoder.h"
 #include "../../resources/customComponents/MailBox.h"
@@ -38,6 +39,7 @@
 #include "../../resources/HammerAitov.h"
 #include "../../resources/ambisonicTools.h"
 #include "AmbisonicNoiseBurst.h"
+#include "DecoderCalculator.h"
 #include "NoiseBurst.h"
 
 #define ProcessorClass AllRADecoderAudioProcessor
@@ -52,6 +54,9 @@ public:
     constexpr static int numberOfInputChannels = 64;
     constexpr static int numberOfOutputChannels = 64;
     static const juce::StringArray weightsStrings;
+    constexpr static int previewWidth = 200;
+    constexpr static int previewHeight = 100;
+    constexpr static int exportScale = 4;
 
     //==============================================================================
     AllRADecoderAudioProcessor();
@@ -106,6 +111,9 @@ public:
     void rotate (const float degreesAddedToAzimuth);
 
     void saveConfigurationToFile (juce::File destination);
+
+    /** Saves the energy and rE maps of the current decoder as PNG files in a higher resolution. */
+    void saveEnergyMapsToFile (juce::File destination);
     void loadConfiguration (const juce::File& presetFile);
 
     juce::ValueTree& getLoudspeakersValueTree() { return loudspeakers; }
@@ -116,7 +124,7 @@ public:
     juce::Atomic<bool> updateMessage = true;
     juce::Atomic<bool> updateChannelCount = true;
 
-    ReferenceCountedDecoder::Ptr getCurrentDecoder() { return decoderConfig; }
+    ReferenceCountedDecoder::Ptr getCurrentDecoder();
 
     std::vector<R3> points;
     std::vector<Tri> triangles;
@@ -125,8 +133,15 @@ public:
     juce::BigInteger imaginaryFlags;
     juce::UndoManager undoManager;
 
+    /** Starts calculating a decoder for the current layout on a background thread. */
     juce::Result calculateDecoder();
 
+    /**
+     Takes over results of the background calculation, returns true if the energy and rE images
+     have changed. Call this from the message thread.
+     */
+    bool pullCalculationResults();
+
     void setLastDir (juce::File newLastDir);
     juce::File getLastDir() { return lastDir; };
 
@@ -156,7 +171,10 @@ private:
 
     AmbisonicDecoder decoder;
     ReferenceCountedDecoder::Ptr decoderConfig { nullptr };
+    juce::SpinLock decoderConfigLock;
+    std::atomic<bool> newDecoderCalculated { false };
 
+    IncrementalHull3D hull;
     bool isLayoutReady = false;
 
     int highestChannelNumber;
@@ -170,10 +188,9 @@ private:
     juce::Result verifyLoudspeakers();
     juce::Result calculateTris();
     void convertLoudspeakersToArray();
+    void decoderCalculated (ReferenceCountedDecoder::Ptr newDecoder);
     void wrapSphericalCoordinates();
 
-    float getKappa (float gIm, float gRe1, float gRe2, int N);
-    juce::dsp::Matrix<float> getInverse (juce::dsp::Matrix<float> A);
 
     juce::ValueTree createLoudspeakerFromCartesian (juce::Vector3D<float> cartesianCoordinates,
                                                     int channel,
@@ -185,10 +202,12 @@ private:
                                                     float gain = 1.0f);
     juce::Vector3D<float> cartesianToSpherical (juce::Vector3D<float> cartvect);
     juce::Vector3D<float> sphericalToCartesian (juce::Vector3D<float> sphervect);
-    juce::Vector3D<float> sphericalInRadiansToCartesian (juce::Vector3D<float> sphervect);
 
     NoiseBurst noiseBurst;
     AmbisonicNoiseBurst ambisonicNoiseBurst;
+
+    // last member, so its thread stops before anything it calls back into gets destroyed
+    DecoderCalculator decoderCalculator;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AllRADecoderAudioProcessor)
 };
@@ -0,0 +1,289 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/NewtonApple/NewtonApple_hull3D.h"
+
+/**
+ Finds the hull triangle containing a direction and its VBAP gains.
+
+ The inverse loudspeaker matrix of each triangle is calculated once in build(). A cube-map grid
+ (six faces with gridSize x gridSize cells each) stores for every cell the triangles which might
+ overlap it: the cell and every triangle are bounded by a spherical cap, and only triangles with
+ intersecting caps become candidates. A lookup then tests just the few candidates of one cell,
+ their inverse matrices are stored contiguously per cell (structure of arrays), so the gains of
+ all candidates are calculated in a single vectorizable loop.
+
+ Candidates are kept in ascending triangle order, so a direction on an edge ends up in the same
+ triangle as with a linear search over all triangles.
+ */
+class TriangleLookup
+{
+public:
+    static constexpr int gridSize = 8;
+    static constexpr int numCells = 6 * gridSize * gridSize;
+
+    struct Result
+    {
+        int triangle = -1;
+        float gains[3] = {};
+    };
+
+    TriangleLookup() = default;
+
+    void build (const std::vector<R3>& points, const std::vector<Tri>& triangles)
+    {
+        const int nTris = static_cast<int> (triangles.size());
+
+        // normalised vertices (imaginary loudspeakers might not be on the unit sphere)
+        std::vector<juce::Vector3D<float>> vertices;
+        vertices.reserve (points.size());
+        for (const auto& p : points)
+            vertices.push_back (juce::Vector3D<float> (p.x, p.y, p.z).normalised());
+
+        inverses.resize (static_cast<size_t> (nTris));
+
+        std::vector<juce::Vector3D<float>> triCentres (static_cast<size_t> (nTris));
+        std::vector<float> triRadii (static_cast<size_t> (nTris));
+
+        for (int t = 0; t < nTris; ++t)
+        {
+            const auto& tri = triangles[static_cast<size_t> (t)];
+            const auto& a = vertices[static_cast<size_t> (tri.a)];
+            const auto& b = vertices[static_cast<size_t> (tri.b)];
+            const auto& c = vertices[static_cast<size_t> (tri.c)];
+
+            inverses[static_cast<size_t> (t)] = getInverse (a, b, c);
+
+            const auto centre = (a + b + c).normalised();
+            triCentres[static_cast<size_t> (t)] = centre;
+            triRadii[static_cast<size_t> (t)] =
+                juce::jmax (getAngle (centre, a), getAngle (centre, b), getAngle (centre, c));
+        }
+
+        cellStart.assign (numCells + 1, 0);
+        std::vector<int> cellTriangles;
+        for (int cell = 0; cell < numCells; ++cell)
+        {
+            juce::Vector3D<float> cellCentre;
+            const float cellRadius = getCellCap (cell, cellCentre);
+
+            for (int t = 0; t < nTris; ++t)
+            {
+                // a spherical triangle spanning more than a hemisphere can't be bounded by a cap
+                const float radius = triRadii[static_cast<size_t> (t)];
+                if (radius >= juce::MathConstants<float>::halfPi
+                    || getAngle (cellCentre, triCentres[static_cast<size_t> (t)])
+                           <= cellRadius + radius + angularTolerance)
+                    cellTriangles.push_back (t);
+            }
+
+            cellStart[static_cast<size_t> (cell + 1)] = static_cast<int> (cellTriangles.size());
+        }
+
+        candidates = cellTriangles;
+        for (auto& row : candidateInverses)
+            row.resize (candidates.size());
+
+        for (size_t k = 0; k < candidates.size(); ++k)
+            for (int i = 0; i < 9; ++i)
+                candidateInverses[static_cast<size_t> (i)][k] =
+                    inverses[static_cast<size_t> (candidates[k])][static_cast<size_t> (i)];
+
+        candidateMinGains.resize (candidates.size());
+    }
+
+    int getNumTriangles() const { return static_cast<int> (inverses.size()); }
+
+    /** Returns the triangle containing the direction (x, y, z) and the non-normalised gains. */
+    Result find (const float x, const float y, const float z)
+    {
+        Result result;
+
+        const int cell = getCell (x, y, z);
+        const int start = cellStart[static_cast<size_t> (cell)];
+        const int end = cellStart[static_cast<size_t> (cell + 1)];
+
+        if (end > start)
+        {
+            const float* m[9];
+            for (size_t i = 0; i < 9; ++i)
+                m[i] = candidateInverses[i].data() + start;
+            float* minGains = candidateMinGains.data() + start;
+
+            const int n = end - start;
+            for (int k = 0; k < n; ++k)
+            {
+                const float g0 = m[0][k] * x + m[1][k] * y + m[2][k] * z;
+                const float g1 = m[3][k] * x + m[4][k] * y + m[5][k] * z;
+                const float g2 = m[6][k] * x + m[7][k] * y + m[8][k] * z;
+                minGains[k] = juce::jmin (g0, g1, g2);
+            }
+
+            for (int k = 0; k < n; ++k)
+                if (minGains[k] >= -FLT_EPSILON)
+                    return getResult (candidates[static_cast<size_t> (start + k)], x, y, z);
+        }
+
+        // numerical corner cases: fall back to testing all triangles
+        for (int t = 0; t < getNumTriangles(); ++t)
+        {
+            result = getResult (t, x, y, z);
+            if (result.gains[0] >= -FLT_EPSILON && result.gains[1] >= -FLT_EPSILON
+                && result.gains[2] >= -FLT_EPSILON)
+                return result;
+        }
+
+        result.triangle = -1;
+        return result;
+    }
+
+private:
+    using Inverse = std::array<float, 9>;
+
+    static constexpr float angularTolerance = 1.0e-3f;
+
+    Result getResult (const int triangle, const float x, const float y, const float z) const
+    {
+        const auto& m = inverses[static_cast<size_t> (triangle)];
+        Result result;
+        result.triangle = triangle;
+        result.gains[0] = m[0] * x + m[1] * y + m[2] * z;
+        result.gains[1] = m[3] * x + m[4] * y + m[5] * z;
+        result.gains[2] = m[6] * x + m[7] * y + m[8] * z;
+        return result;
+    }
+
+    /** Inverse of the matrix with the columns a, b, and c, stored row-major. */
+    static Inverse getInverse (const juce::Vector3D<float>& a,
+                               const juce::Vector3D<float>& b,
+                               const juce::Vector3D<float>& c)
+    {
+        // the rows of the inverse are the cross products of the columns divided by the determinant
+        const auto bc = b ^ c;
+        const auto ca = c ^ a;
+        const auto ab = a ^ b;
+        const float factor = 1.0f / (a * bc);
+
+        return { bc.x * factor, bc.y * factor, bc.z * factor, ca.x * factor, ca.y * factor,
+                 ca.z * factor, ab.x * factor, ab.y * factor, ab.z * factor };
+    }
+
+    static float getAngle (const juce::Vector3D<float>& a, const juce::Vector3D<float>& b)
+    {
+        return std::acos (juce::jlimit (-1.0f, 1.0f, a * b));
+    }
+
+    /** Direction of a point (u, v) in [-1, 1] on one of the cube's faces. */
+    static juce::Vector3D<float> getFacePoint (const int face, const float u, const float v)
+    {
+        switch (face)
+        {
+            case 0:
+                return { 1.0f, u, v };
+            case 1:
+                return { -1.0f, u, v };
+            case 2:
+                return { u, 1.0f, v };
+            case 3:
+                return { u, -1.0f, v };
+            case 4:
+                return { u, v, 1.0f };
+            default:
+                return { u, v, -1.0f };
+        }
+    }
+
+    static int getCell (const float x, const float y, const float z)
+    {
+        const float ax = std::abs (x);
+        const float ay = std::abs (y);
+        const float az = std::abs (z);
+
+        int face;
+        float u, v;
+        if (ax >= ay && ax >= az)
+        {
+            face = x >= 0.0f ? 0 : 1;
+            u = y / ax;
+            v = z / ax;
+        }
+        else if (ay >= az)
+        {
+            face = y >= 0.0f ? 2 : 3;
+            u = x / ay;
+            v = z / ay;
+        }
+        else
+        {
+            face = z >= 0.0f ? 4 : 5;
+            u = x / az;
+            v = y / az;
+        }
+
+        const auto toIndex = [] (const float coordinate)
+        {
+            return juce::jlimit (0,
+                                 gridSize - 1,
+                                 static_cast<int> ((coordinate + 1.0f) * 0.5f * gridSize));
+        };
+
+        return (face * gridSize + toIndex (u)) * gridSize + toIndex (v);
+    }
+
+    /**
+     Spherical cap around a cell: as the cell is the projection of a square, it lies within the
+     cap around its centre reaching its farthest corner.
+     */
+    static float getCellCap (const int cell, juce::Vector3D<float>& centre)
+    {
+        const int face = cell / (gridSize * gridSize);
+        const int iu = (cell / gridSize) % gridSize;
+        const int iv = cell % gridSize;
+
+        const float step = 2.0f / gridSize;
+        const float u0 = -1.0f + iu * step;
+        const float v0 = -1.0f + iv * step;
+
+        centre = getFacePoint (face, u0 + 0.5f * step, v0 + 0.5f * step).normalised();
+
+        float radius = 0.0f;
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const auto p = getFacePoint (face,
+                                         u0 + (corner & 1) * step,
+                                         v0 + (corner >> 1) * step)
+                               .normalised();
+            radius = juce::jmax (radius, getAngle (centre, p));
+        }
+
+        return radius;
+    }
+
+    std::vector<Inverse> inverses;
+
+    std::vector<int> cellStart;
+    std::vector<int> candidates;
+    std::array<std::vector<float>, 9> candidateInverses;
+    std::vector<float> candidateMinGains;
+};
@@ -0,0 +1,286 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/Conversions.h"
+#include "../../resources/SHRotation.h"
+#include "../../resources/efficientSHvanilla.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+ Calculates the projection matrix of the spatial mask on a background thread.
+ The mask is a zonal (rotationally symmetric) window around the look direction. Pointing to the
+ north pole, its projection Pz only depends on the width and only couples SH components with the
+ same degree m. Pz is cached per width and rotated to the look direction with the per-order SH
+ rotation matrices: P = R Pz R'.
+ The audio thread takes over new projections with pullNewProjection() and can crossfade from the
+ previous one.
+ */
+class MaskProjection : private juce::Thread
+{
+public:
+    static constexpr int maxOrder = 7;
+    static constexpr int maxNumChannels = 64;
+
+    struct Projection
+    {
+        Projection() : P (maxNumChannels, maxNumChannels), Pz (maxNumChannels, maxNumChannels)
+        {
+            rotation.add (new juce::dsp::Matrix<float> (1, 1));
+            rotation[0]->operator() (0, 0) = 1.0f;
+            for (int l = 1; l <= maxOrder; ++l)
+                rotation.add (new juce::dsp::Matrix<float> (2 * l + 1, 2 * l + 1));
+        }
+
+        /** Copies the coefficients without reallocating, so it can be used on the audio thread. */
+        void copyFrom (const Projection& other)
+        {
+            juce::FloatVectorOperations::copy (P.getRawDataPointer(),
+                                               other.P.getRawDataPointer(),
+                                               maxNumChannels * maxNumChannels);
+            juce::FloatVectorOperations::copy (Pz.getRawDataPointer(),
+                                               other.Pz.getRawDataPointer(),
+                                               maxNumChannels * maxNumChannels);
+            for (int l = 0; l <= maxOrder; ++l)
+                juce::FloatVectorOperations::copy (rotation[l]->getRawDataPointer(),
+                                                   other.rotation[l]->getRawDataPointer(),
+                                                   juce::square (2 * l + 1));
+        }
+
+        juce::dsp::Matrix<float> P; // dense projection
+        juce::dsp::Matrix<float> Pz; // zonal projection (mask pointing to the north pole)
+        juce::OwnedArray<juce::dsp::Matrix<float>> rotation; // per-order rotation matrices
+    };
+
+    MaskProjection() : juce::Thread ("DirectionalCompressor Mask")
+    {
+        for (int m = -maxOrder; m <= maxOrder; ++m)
+        {
+            auto& group = channelsWithDegree[m + maxOrder];
+            for (int n = std::abs (m); n <= maxOrder; ++n)
+                group.add (n * n + n + m);
+        }
+
+        startThread();
+    }
+
+    ~MaskProjection() override { stopThread (1000); }
+
+    /** Requests a new projection, which will be calculated on the background thread. */
+    void setMask (const float azimuthInDegrees,
+                  const float elevationInDegrees,
+                  const float widthInDegrees)
+    {
+        azimuth = azimuthInDegrees;
+        elevation = elevationInDegrees;
+        width = widthInDegrees;
+        parametersChanged = true;
+        notify();
+    }
+
+    /**
+     Calculates the projection right away and sets it as current and previous one. Don't call
+     this concurrently with the audio thread, e.g. use it in prepareToPlay.
+     */
+    void calculateNow()
+    {
+        const juce::ScopedLock calculationLock (calculating);
+        calculate (current);
+        previous.copyFrom (current);
+    }
+
+    /**
+     Realtime-safe: takes over a newly calculated projection, if there is one. Returns true in
+     that case, the former projection is then available via getPreviousProjection().
+     */
+    bool pullNewProjection()
+    {
+        const juce::SpinLock::ScopedTryLockType lock (pendingLock);
+        if (! lock.isLocked() || ! newProjectionAvailable)
+            return false;
+
+        previous.copyFrom (current);
+        current.copyFrom (pending);
+        newProjectionAvailable = false;
+        return true;
+    }
+
+    const Projection& getCurrentProjection() const { return current; }
+    const Projection& getPreviousProjection() const { return previous; }
+
+    /** Channel indices (ACN) of all components with degree m, in ascending order. */
+    const juce::Array<int>& getChannelsWithDegree (const int m) const
+    {
+        return channelsWithDegree[m + maxOrder];
+    }
+
+private:
+    static constexpr int numThetaStepsPerSegment = 64;
+    static constexpr int numPhiSteps = 2 * maxOrder + 2; // exact for the products of SHs
+    // keeps narrow masks from vanishing at high orders (the former t-design sampling had a
+    // similar, but direction dependent, lower bound)
+    static constexpr float minimumWidthHalfInRadians = 0.15f;
+
+    void run() override
+    {
+        Projection working;
+
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            while (parametersChanged.exchange (false) && ! threadShouldExit())
+            {
+                {
+                    const juce::ScopedLock calculationLock (calculating);
+                    calculate (working);
+                }
+
+                const juce::SpinLock::ScopedLockType lock (pendingLock);
+                pending.copyFrom (working);
+                newProjectionAvailable = true;
+            }
+        }
+    }
+
+    void calculate (Projection& target)
+    {
+        const float newWidth = width.load();
+        if (newWidth != cachedWidth)
+        {
+            calculateZonalProjection (newWidth);
+            cachedWidth = newWidth;
+        }
+
+        juce::FloatVectorOperations::copy (target.Pz.getRawDataPointer(),
+                                           cachedPz.getRawDataPointer(),
+                                           maxNumChannels * maxNumChannels);
+
+        const auto rotMat = SHRotation::rotationFromNorthPole (
+            Conversions<float>::degreesToRadians (azimuth.load()),
+            Conversions<float>::degreesToRadians (elevation.load()));
+        SHRotation::calcRotationMatrices (rotMat, target.rotation, maxOrder);
+
+        // T = Pz R', R being block-diagonal
+        for (int r = 0; r < maxNumChannels; ++r)
+            for (int l = 0; l <= maxOrder; ++l)
+            {
+                const int offset = l * l;
+                const auto& R = *target.rotation[l];
+                for (int c = 0; c < 2 * l + 1; ++c)
+                {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 2 * l + 1; ++k)
+                        sum += cachedPz (r, offset + k) * R (c, k);
+                    temp (r, offset + c) = sum;
+                }
+            }
+
+        // P = R T
+        for (int l = 0; l <= maxOrder; ++l)
+        {
+            const int offset = l * l;
+            const auto& R = *target.rotation[l];
+            for (int r = 0; r < 2 * l + 1; ++r)
+                for (int c = 0; c < maxNumChannels; ++c)
+                {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 2 * l + 1; ++k)
+                        sum += R (r, k) * temp (offset + k, c);
+                    target.P (offset + r, c) = sum;
+                }
+        }
+    }
+
+    /**
+     Integrates the mask window g(theta) times all products of SHs with the same degree m. The
+     theta-integration is split at the kinks of the window.
+     */
+    void calculateZonalProjection (const float widthInDegrees)
+    {
+        const float widthHalf = juce::jmax (minimumWidthHalfInRadians,
+                                            Conversions<float>::degreesToRadians (widthInDegrees)
+                                                * 0.25f); // it's actually width fourth
+        const float pi = juce::MathConstants<float>::pi;
+
+        auto window = [widthHalf, pi] (const float theta)
+        {
+            const float clipped = juce::jlimit (widthHalf, 3 * widthHalf, theta);
+            return std::cos ((clipped - widthHalf) * 0.25f * pi / widthHalf);
+        };
+
+        cachedPz.clear();
+        float sh[maxNumChannels];
+
+        const float segments[3] = { 0.0f, widthHalf, juce::jmin (3 * widthHalf, pi) };
+        for (int s = 0; s < 2; ++s)
+        {
+            const float thetaStep = (segments[s + 1] - segments[s]) / numThetaStepsPerSegment;
+            for (int k = 0; k < numThetaStepsPerSegment; ++k)
+            {
+                const float theta = segments[s] + (k + 0.5f) * thetaStep;
+                const float weight = window (theta) * std::sin (theta) * thetaStep * 2.0f * pi
+                                     / numPhiSteps;
+
+                for (int p = 0; p < numPhiSteps; ++p)
+                {
+                    const float phi = 2.0f * pi * p / numPhiSteps;
+                    SHEval (maxOrder,
+                            std::sin (theta) * std::cos (phi),
+                            std::sin (theta) * std::sin (phi),
+                            std::cos (theta),
+                            sh,
+                            false);
+
+                    for (auto& group : channelsWithDegree)
+                        for (auto a : group)
+                            for (auto b : group)
+                                cachedPz (a, b) += weight * sh[a] * sh[b];
+                }
+            }
+        }
+
+        // reverting the decode correction of SHEval
+        cachedPz *= 1.0f / juce::square (decodeCorrection (maxOrder));
+    }
+
+    std::atomic<float> azimuth { 0.0f };
+    std::atomic<float> elevation { 0.0f };
+    std::atomic<float> width { 40.0f };
+    std::atomic<bool> parametersChanged { false };
+
+    juce::CriticalSection calculating;
+    float cachedWidth = -1.0f;
+    juce::dsp::Matrix<float> cachedPz { maxNumChannels, maxNumChannels };
+    juce::dsp::Matrix<float> temp { maxNumChannels, maxNumChannels };
+    std::array<juce::Array<int>, 2 * maxOrder + 1> channelsWithDegree;
+
+    juce::SpinLock pendingLock;
+    Projection pending;
+    bool newProjectionAvailable = false;
+
+    // audio thread
+    Projection current, previous;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MaskProjection)
+};
@@ -117,6 +117,19 @@ DirectionalCompressorAudioProcessorEditor::DirectionalCompressorAudioProcessorEd
     cbListen.addItem ("Unmasked", 3);
     cbListen.setSelectedId (*valueTreeState.getRawParameterValue ("listen") + 1);
 
+    addAndMakeVisible (&cbMaskProcessing);
+    cbMaskProcessing.setJustificationType (juce::Justification::centred);
+    cbMaskProcessing.addSectionHeading ("Mask processing");
+    cbMaskProcessing.addItem ("Auto", 1);
+    cbMaskProcessing.addItem ("Dense", 2);
+    cbMaskProcessing.addItem ("Rotated", 3);
+    cbMaskProcessingAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "maskProcessing", cbMaskProcessing));
+    cbMaskProcessing.setTooltip (
+        "Dense applies the full projection matrix, Rotated rotates the signal to the mask, "
+        "weights it and rotates it back. Auto uses the one needing fewer operations at the current "
+        "order, which is Rotated from 4th order on.");
+
     // ======== compressor 1 components ===========
     bool isOn = *valueTreeState.getRawParameterValue ("c1Enabled");
 
@@ -630,4 +643,6 @@ void DirectionalCompressorAudioProcessorEditor::resized()
 
     area.removeFromLeft (15); //spacing
     cbListen.setBounds (area.removeFromTop (15));
+    area.removeFromTop (5); //spacing
+    cbMaskProcessing.setBounds (area.removeFromTop (15));
 }
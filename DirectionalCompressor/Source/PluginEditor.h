@@ -86,7 +86,7 @@ private:
 
     juce::ComboBox cbC1Driving, cbC1Apply;
     juce::ComboBox cbC2Driving, cbC2Apply;
-    juce::ComboBox cbListen;
+    juce::ComboBox cbListen, cbMaskProcessing;
 
     std::unique_ptr<SliderAttachment> slPreGainAttachment, slAzimuthAttachment,
         slElevationAttachment, slWidthAttachment;
@@ -101,7 +101,7 @@ private:
 
     std::unique_ptr<ComboBoxAttachment> cbC1DrivingAttachment, cbC1ApplyAttachment;
     std::unique_ptr<ComboBoxAttachment> cbC2DrivingAttachment, cbC2ApplyAttachment;
-    std::unique_ptr<ComboBoxAttachment> cbListenAttachment;
+    std::unique_ptr<ComboBoxAttachment> cbListenAttachment, cbMaskProcessingAttachment;
 
     std::unique_ptr<ButtonAttachment> tbC1Attachment, tbC2Attachment;
 
@@ -36,12 +36,7 @@ DirectionalCompressorAudioProcessor::DirectionalCompressorAudioProcessor() :
     #endif
             ,
 #endif
-        createParameterLayout()),
-    //W (tDesignN),
-    Y (tDesignN, 64),
-    YH (64, tDesignN),
-    tempMat (64, tDesignN),
-    P1 (64, 64)
+        createParameterLayout())
 {
     parameters.addParameterListener ("azimuth", this);
     parameters.addParameterListener ("elevation", this);
@@ -76,22 +71,17 @@ DirectionalCompressorAudioProcessor::DirectionalCompressorAudioProcessor() :
     elevation = parameters.getRawParameterValue ("elevation");
     width = parameters.getRawParameterValue ("width");
     listen = parameters.getRawParameterValue ("listen");
+    maskProcessing = parameters.getRawParameterValue ("maskProcessing");
 
     c1MaxGR = 0.0f;
     c2MaxGR = 0.0f;
     c1GR = 0.0f;
     c2GR = 0.0f;
 
-    // calc Y
-    for (int p = 0; p < tDesignN; ++p)
-        SHEval (7, tDesignX[p], tDesignY[p], tDesignZ[p], Y.getRawDataPointer() + p * 64, false);
+    for (int order = 0; order < 8; ++order)
+        rotatedMaskIsFaster[order] = isRotatedMaskCheaper (order);
 
-    Y *= std::sqrt (4 * juce::MathConstants<float>::pi / tDesignN)
-         / decodeCorrection (7); // reverting 7th order correction
-
-    for (int r = 0; r < 64; ++r)
-        for (int c = 0; c < tDesignN; ++c)
-            YH (r, c) = Y (c, r);
+    updateMask();
 }
 
 DirectionalCompressorAudioProcessor::~DirectionalCompressorAudioProcessor()
@@ -129,7 +119,7 @@ void DirectionalCompressorAudioProcessor::parameterChanged (const juce::String&
     if (parameterID == "azimuth" || parameterID == "elevation" || parameterID == "width")
     {
         updatedPositionData = true;
-        paramChanged = true;
+        updateMask();
     }
     else if (parameterID == "orderSetting")
     {
@@ -154,7 +144,10 @@ void DirectionalCompressorAudioProcessor::prepareToPlay (double sampleRate, int
     c1Gains.resize (samplesPerBlock);
     c2Gains.resize (samplesPerBlock);
 
-    calcParams();
+    rotatedBuffer.setSize (64, samplesPerBlock);
+    zonalBuffer.setSize (64, samplesPerBlock);
+
+    maskProjection.calculateNow();
 }
 
 void DirectionalCompressorAudioProcessor::releaseResources()
@@ -167,8 +160,7 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
                                                         juce::MidiBuffer& midiMessages)
 {
     checkInputAndOutput (this, *orderSetting, *orderSetting);
-    if (paramChanged)
-        calcParams();
+    const bool newMask = maskProjection.pullNewProjection();
 
     const int totalNumInputChannels = getTotalNumInputChannels();
     const int totalNumOutputChannels = getTotalNumOutputChannels();
@@ -218,16 +210,22 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
     // --------- make copies of buffer
     omniW.copyFrom (0, 0, buffer, 0, 0, bufferSize);
 
-    maskBuffer.clear();
-    maskBuffer.setSample (0, 0, 0.0f);
-    for (int chIn = 0; chIn < numCh; ++chIn)
+    // the mask is faded within one block whenever a new projection has been calculated
+    const bool useRotatedMask = [&]
     {
-        const float* readPtr = buffer.getReadPointer (chIn);
-        for (int chOut = 0; chOut < numCh; ++chOut)
-        {
-            maskBuffer.addFrom (chOut, 0, readPtr, bufferSize, P1 (chOut, chIn));
-        }
-    }
+        if (*maskProcessing >= 0.5f && *maskProcessing < 1.5f)
+            return false;
+        else if (*maskProcessing >= 1.5f)
+            return true;
+        else
+            return rotatedMaskIsFaster[isqrt (numCh) - 1];
+    }();
+
+    if (useRotatedMask)
+        applyMaskRotated (buffer, maskBuffer, numCh, bufferSize, newMask);
+    else
+        applyMaskDense (buffer, maskBuffer, numCh, bufferSize, newMask);
+
     /* This makes the buffer containing the negative mask */
     for (int chIn = 0; chIn < numCh; ++chIn)
         juce::FloatVectorOperations::subtract (buffer.getWritePointer (chIn),
@@ -385,50 +383,134 @@ void DirectionalCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer&
             buffer.applyGain (i, 0, bufferSize, n3d2sn3d[i]);
 }
 
-void DirectionalCompressorAudioProcessor::calcParams()
+void DirectionalCompressorAudioProcessor::updateMask()
 {
-    paramChanged = false;
+    maskProjection.setMask (*azimuth, *elevation, *width);
+}
 
-    // convert azimuth and elevation to cartesian coordinates
-    auto pos = Conversions<float>::sphericalToCartesian (
-        Conversions<float>::degreesToRadians (*azimuth),
-        Conversions<float>::degreesToRadians (*elevation));
-    pos = pos.normalised();
+void DirectionalCompressorAudioProcessor::applyMaskDense (const juce::AudioBuffer<float>& source,
+                                                          juce::AudioBuffer<float>& mask,
+                                                          const int numCh,
+                                                          const int L,
+                                                          const bool rampFromPrevious)
+{
+    const auto& P = maskProjection.getCurrentProjection().P;
+    const auto& Pold = maskProjection.getPreviousProjection().P;
 
-    for (int point = 0; point < tDesignN; ++point)
+    mask.clear();
+    mask.setSample (0, 0, 0.0f);
+    for (int chIn = 0; chIn < numCh; ++chIn)
     {
-        dist[point] = pos.x * tDesignX[point] + pos.y * tDesignY[point] + pos.z * tDesignZ[point];
-        dist[point] /= std::sqrt (juce::square (tDesignX[point]) + juce::square (tDesignY[point])
-                                  + juce::square (tDesignZ[point]));
-        dist[point] = std::acos (dist[point]);
+        const float* readPtr = source.getReadPointer (chIn);
+        for (int chOut = 0; chOut < numCh; ++chOut)
+        {
+            if (rampFromPrevious)
+                mask.addFromWithRamp (chOut, 0, readPtr, L, Pold (chOut, chIn), P (chOut, chIn));
+            else
+                mask.addFrom (chOut, 0, readPtr, L, P (chOut, chIn));
+        }
     }
+}
 
-    float widthHalf = Conversions<float>::degreesToRadians (*width)
-                      * 0.25f; // it's actually width fourth (symmetric mask)
-    widthHalf = juce::jmax (widthHalf, juce::FloatVectorOperations::findMinimum (dist, tDesignN));
-
-    juce::FloatVectorOperations::clip (dist, dist, widthHalf, 3 * widthHalf, tDesignN);
-    juce::FloatVectorOperations::add (dist, -widthHalf, tDesignN);
-    juce::FloatVectorOperations::multiply (dist,
-                                           0.25f * juce::MathConstants<float>::pi / widthHalf,
-                                           tDesignN);
+void DirectionalCompressorAudioProcessor::applyMaskRotated (const juce::AudioBuffer<float>& source,
+                                                            juce::AudioBuffer<float>& mask,
+                                                            const int numCh,
+                                                            const int L,
+                                                            const bool rampFromPrevious)
+{
+    const int order = isqrt (numCh) - 1;
+    const auto& current = maskProjection.getCurrentProjection();
+    const auto& previous = maskProjection.getPreviousProjection();
+
+    auto addFrom = [L, rampFromPrevious] (juce::AudioBuffer<float>& dest,
+                                          const int destChannel,
+                                          const float* src,
+                                          const float oldGain,
+                                          const float newGain)
+    {
+        if (rampFromPrevious)
+            dest.addFromWithRamp (destChannel, 0, src, L, oldGain, newGain);
+        else
+            dest.addFrom (destChannel, 0, src, L, newGain);
+    };
 
-    for (int p = 0; p < tDesignN; ++p)
+    // rotate the mask direction to the north pole: R'
+    rotatedBuffer.clear();
+    rotatedBuffer.copyFrom (0, 0, source, 0, 0, L);
+    for (int l = 1; l <= order; ++l)
     {
-        const float g = std::cos (dist[p]);
-        for (int r = 0; r < 64; ++r)
-            tempMat (r, p) = g * Y (p, r);
+        const int offset = l * l;
+        const auto& R = *current.rotation[l];
+        const auto& Rold = *previous.rotation[l];
+        for (int o = 0; o < 2 * l + 1; ++o)
+            for (int i = 0; i < 2 * l + 1; ++i)
+                addFrom (rotatedBuffer,
+                         offset + o,
+                         source.getReadPointer (offset + i),
+                         Rold (i, o),
+                         R (i, o));
     }
 
-    for (int r = 0; r < 64; ++r)
-        for (int c = r; c < 64; ++c)
+    // zonal projection, only couples components of the same degree m
+    zonalBuffer.clear();
+    zonalBuffer.setSample (0, 0, 0.0f);
+    for (int m = -order; m <= order; ++m)
+    {
+        const auto& channels = maskProjection.getChannelsWithDegree (m);
+        for (auto chOut : channels)
         {
-            float sum = 0.0f;
-            for (int i = 0; i < tDesignN; ++i)
-                sum += tempMat (r, i) * YH (c, i);
-            P1 (r, c) = sum;
-            P1 (c, r) = sum;
+            if (chOut >= numCh)
+                break;
+
+            for (auto chIn : channels)
+            {
+                if (chIn >= numCh)
+                    break;
+
+                addFrom (zonalBuffer,
+                         chOut,
+                         rotatedBuffer.getReadPointer (chIn),
+                         previous.Pz (chOut, chIn),
+                         current.Pz (chOut, chIn));
+            }
         }
+    }
+
+    // rotate back: R
+    mask.clear();
+    mask.copyFrom (0, 0, zonalBuffer, 0, 0, L);
+    for (int l = 1; l <= order; ++l)
+    {
+        const int offset = l * l;
+        const auto& R = *current.rotation[l];
+        const auto& Rold = *previous.rotation[l];
+        for (int o = 0; o < 2 * l + 1; ++o)
+            for (int i = 0; i < 2 * l + 1; ++i)
+                addFrom (mask,
+                         offset + o,
+                         zonalBuffer.getReadPointer (offset + i),
+                         Rold (o, i),
+                         R (o, i));
+    }
+}
+
+bool DirectionalCompressorAudioProcessor::isRotatedMaskCheaper (const int order)
+{
+    const int numCh = juce::square (order + 1);
+
+    // rotating there and back: one (2l + 1) x (2l + 1) block per degree l > 0, each
+    int numRotatedOperations = 0;
+    for (int l = 1; l <= order; ++l)
+        numRotatedOperations += 2 * juce::square (2 * l + 1);
+
+    // zonal projection: the order + 1 - |m| channels with degree m are coupled
+    for (int m = -order; m <= order; ++m)
+        numRotatedOperations += juce::square (order + 1 - std::abs (m));
+
+    // clearing and copying the three intermediate buffers
+    numRotatedOperations += 3 * numCh;
+
+    return numRotatedOperations < numCh * numCh;
 }
 
 //==============================================================================
@@ -575,6 +657,25 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "maskProcessing",
+        "Mask processing",
+        "",
+        juce::NormalisableRange<float> (0.0f, 2.0f, 1.0f),
+        0.0,
+        [] (float value)
+        {
+            if (value >= 0.5f && value < 1.5f)
+                return "Dense";
+            else if (value >= 1.5f)
+                return "Rotated";
+            else
+                return "Auto";
+        },
+        nullptr,
+        false,
+        false));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay (
         "c1Apply",
         "Apply compression 1 to",
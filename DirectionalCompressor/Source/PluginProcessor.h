@@ -27,8 +27,8 @@
 #include "../../resources/Conversions.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/efficientSHvanilla.h"
-#include "../../resources/tDesignN7.h"
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "MaskProjection.h"
 
 #define ProcessorClass DirectionalCompressorAudioProcessor
 
@@ -77,7 +77,6 @@ public:
     float c2MaxRMS;
     float c2MaxGR;
 
-    void calcParams();
     juce::Atomic<bool> updatedPositionData;
 
 private:
@@ -86,15 +85,39 @@ private:
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DirectionalCompressorAudioProcessor)
 
+    void updateMask();
+
+    /** Mask via the dense projection matrix: numCh x numCh block operations. */
+    void applyMaskDense (const juce::AudioBuffer<float>& source,
+                         juce::AudioBuffer<float>& mask,
+                         const int numCh,
+                         const int L,
+                         const bool rampFromPrevious);
+
+    /**
+     Mask via rotating the signal so the mask points to the north pole, applying the zonal
+     projection (which only couples components with the same degree m) and rotating back. For
+     higher orders that's considerably fewer block operations than the dense matrix.
+     */
+    void applyMaskRotated (const juce::AudioBuffer<float>& source,
+                           juce::AudioBuffer<float>& mask,
+                           const int numCh,
+                           const int L,
+                           const bool rampFromPrevious);
+
+    /**
+     Compares the number of block operations of both mask implementations. Deterministic, so the
+     same session always takes the same path.
+     */
+    static bool isRotatedMaskCheaper (const int order);
+
     juce::AudioBuffer<float> omniW;
     juce::AudioBuffer<float> maskBuffer;
+    juce::AudioBuffer<float> rotatedBuffer;
+    juce::AudioBuffer<float> zonalBuffer;
 
-    juce::dsp::Matrix<float> Y;
-    juce::dsp::Matrix<float> YH;
-    juce::dsp::Matrix<float> tempMat;
-    juce::dsp::Matrix<float> P1;
-
-    float dist[tDesignN];
+    MaskProjection maskProjection;
+    std::array<bool, 8> rotatedMaskIsFaster;
 
     const float* drivingPointers[3];
 
@@ -104,8 +127,6 @@ private:
     float c1GR;
     float c2GR;
 
-    std::atomic<bool> paramChanged { true };
-
     iem::Compressor compressor1, compressor2;
     // == PARAMETERS ==
     // settings and mask
@@ -116,6 +137,7 @@ private:
     std::atomic<float>* elevation;
     std::atomic<float>* width;
     std::atomic<float>* listen;
+    std::atomic<float>* maskProcessing;
     // compressor 1
     std::atomic<float>* c1Enabled;
     std::atomic<float>* c1DrivingSignal;
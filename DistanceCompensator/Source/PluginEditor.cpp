@@ -138,6 +138,18 @@ DistanceCompensatorAudioProcessorEditor::DistanceCompensatorAudioProcessorEditor
     tbEnableDelays.setButtonText ("Delay compensation");
     tbEnableDelays.setColour (juce::ToggleButton::tickColourId, juce::Colours::orange);
 
+    addAndMakeVisible (tbEnableFilters);
+    tbEnableFiltersAttachment.reset (
+        new ButtonAttachment (valueTreeState, "enableFilters", tbEnableFilters));
+    tbEnableFilters.setButtonText ("Room correction filters");
+    tbEnableFilters.setColour (juce::ToggleButton::tickColourId, juce::Colours::cornflowerblue);
+
+    addAndMakeVisible (btLoadFilters);
+    btLoadFilters.setButtonText ("LOAD FILTERS");
+    btLoadFilters.addListener (this);
+    btLoadFilters.setColour (juce::TextButton::buttonColourId, juce::Colours::cornflowerblue);
+    btLoadFilters.setTooltip ("One filter per loudspeaker: multichannel audio or JSON file.");
+
     addAndMakeVisible (gcDistances);
     gcDistances.setText ("Loudspeaker Distances");
 
@@ -291,6 +303,12 @@ void DistanceCompensatorAudioProcessorEditor::resized()
     col.removeFromTop (5);
     btReference.setBounds (col.removeFromTop (21));
 
+    area.removeFromTop (5);
+    auto filterRow = area.removeFromTop (21);
+    tbEnableFilters.setBounds (filterRow.removeFromLeft (200));
+    filterRow.removeFromLeft (50);
+    btLoadFilters.setBounds (filterRow.removeFromLeft (130));
+
     area.removeFromTop (10);
     gcDistances.setBounds (area.removeFromTop (25));
 
@@ -367,6 +385,21 @@ void DistanceCompensatorAudioProcessorEditor::buttonClicked (juce::Button* butto
             processor.loadConfiguration (configFile);
         }
     }
+    else if (button == &btLoadFilters)
+    {
+        juce::FileChooser myChooser (
+            "Load room correction filters...",
+            processor.getLastDir().exists()
+                ? processor.getLastDir()
+                : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
+            "*.wav;*.aif;*.aiff;*.json");
+        if (myChooser.browseForFileToOpen())
+        {
+            juce::File filterFile (myChooser.getResult());
+            processor.setLastDir (filterFile.getParentDirectory());
+            processor.loadFilters (filterFile);
+        }
+    }
     else if (button == &btReference)
     {
         processor.updateParameters();
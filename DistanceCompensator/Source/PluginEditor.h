@@ -100,11 +100,13 @@ private:
     juce::GroupComponent gcLayout;
     juce::TextButton btLoadFile;
     juce::TextButton btReference;
+    juce::TextButton btLoadFilters;
 
     // buttons
     juce::GroupComponent gcCompensation;
     juce::ToggleButton tbEnableGains;
     juce::ToggleButton tbEnableDelays;
+    juce::ToggleButton tbEnableFilters;
     std::unique_ptr<ButtonAttachment> tbEnableGainsAttachment;
     std::unique_ptr<ButtonAttachment> tbEnableDelaysAttachment;
     std::unique_ptr<ButtonAttachment> tbEnableFiltersAttachment;
@@ -42,6 +42,7 @@ DistanceCompensatorAudioProcessor::DistanceCompensatorAudioProcessor() :
     inputChannelsSetting = parameters.getRawParameterValue ("inputChannelsSetting");
     enableGains = parameters.getRawParameterValue ("enableGains");
     enableDelays = parameters.getRawParameterValue ("enableDelays");
+    enableFilters = parameters.getRawParameterValue ("enableFilters");
     speedOfSound = parameters.getRawParameterValue ("speedOfSound");
     distanceExponent = parameters.getRawParameterValue ("distanceExponent");
     gainNormalization = parameters.getRawParameterValue ("gainNormalization");
@@ -54,6 +55,8 @@ DistanceCompensatorAudioProcessor::DistanceCompensatorAudioProcessor() :
     parameters.addParameterListener ("speedOfSound", this);
     parameters.addParameterListener ("distanceExponent", this);
     parameters.addParameterListener ("gainNormalization", this);
+    parameters.addParameterListener ("enableFilters", this);
+    convolution.setFiltersEnabled (*enableFilters >= 0.5f);
 
     for (int i = 0; i < 64; ++i)
     {
@@ -157,6 +160,76 @@ void DistanceCompensatorAudioProcessor::loadConfiguration (const juce::File& con
     }
 }
 
+void DistanceCompensatorAudioProcessor::loadFilters (const juce::File& filterFile)
+{
+    juce::AudioBuffer<float> newFilters;
+    double filterSampleRate = 0.0;
+    juce::Result result = juce::Result::ok();
+
+    if (filterFile.hasFileExtension ("json"))
+    {
+        result =
+            ConfigurationHelper::parseFileForFilters (filterFile, newFilters, filterSampleRate);
+    }
+    else
+    {
+        // one channel per loudspeaker
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader (
+            formatManager.createReaderFor (filterFile));
+
+        if (reader == nullptr)
+        {
+            result = juce::Result::fail ("File '" + filterFile.getFullPathName()
+                                         + "' could not be read as audio file.");
+        }
+        else
+        {
+            const juce::int64 maxLength = MultiChannelConvolution::maxFilterLength;
+            const int length = static_cast<int> (juce::jmin (reader->lengthInSamples, maxLength));
+            newFilters.setSize (static_cast<int> (reader->numChannels), length);
+            reader->read (&newFilters, 0, length, 0, true, true);
+            filterSampleRate = reader->sampleRate;
+        }
+    }
+
+    if (! result.wasOk())
+    {
+        DBG ("Filters could not be loaded.");
+        MailBox::Message newMessage;
+        newMessage.messageColour = juce::Colours::red;
+        newMessage.headline = "Error loading filters";
+        newMessage.text = result.getErrorMessage();
+        messageToEditor = newMessage;
+        updateMessage = true;
+        return;
+    }
+
+    convolution.setFilters (newFilters);
+    parameters.state.setProperty ("filterFile", filterFile.getFullPathName(), nullptr);
+    updateLatency();
+
+    const double sampleRate = getSampleRate();
+    if (sampleRate > 0.0 && filterSampleRate != sampleRate)
+    {
+        MailBox::Message newMessage;
+        newMessage.messageColour = juce::Colours::orange;
+        newMessage.headline = "Sample rate mismatch";
+        newMessage.text = "The filters were designed for " + juce::String (filterSampleRate)
+                          + " Hz, but the plug-in runs at " + juce::String (sampleRate)
+                          + " Hz. The filters are used without resampling.";
+        messageToEditor = newMessage;
+        updateMessage = true;
+    }
+}
+
+void DistanceCompensatorAudioProcessor::updateLatency()
+{
+    // constant while filters are loaded, so enabling and disabling them can be automated
+    setLatencySamples (convolution.hasFilters() ? convolution.getLatencyInSamples() : 0);
+}
+
 //==============================================================================
 int DistanceCompensatorAudioProcessor::getNumPrograms()
 {
@@ -192,11 +265,20 @@ void DistanceCompensatorAudioProcessor::prepareToPlay (double sampleRate, int sa
     specs.maximumBlockSize = samplesPerBlock;
     specs.numChannels = 64;
 
+    // largest delay needed: farthest minus closest possible distance at the lowest speed of sound
+    const auto distanceRange = parameters.getParameterRange ("distance0");
+    const auto speedOfSoundRange = parameters.getParameterRange ("speedOfSound");
+    delay.setMaxDelayTime ((distanceRange.end - distanceRange.start) / speedOfSoundRange.start);
+    delay.setFractionalDelays (true);
+
     gain.prepare (specs);
     delay.prepare (specs);
+    convolution.prepare (specs);
+    filtersActive = false;
 
     updateDelays();
     updateGains();
+    updateLatency();
 }
 
 void DistanceCompensatorAudioProcessor::releaseResources()
@@ -224,6 +306,18 @@ void DistanceCompensatorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
         gain.process (context);
     if (*enableDelays > 0.5f)
         delay.process (context);
+
+    // the convolution also delays the unfiltered signal while the filters are disabled
+    const bool useConvolution = convolution.hasFilters();
+    if (useConvolution != filtersActive)
+    {
+        if (useConvolution)
+            convolution.reset();
+        filtersActive = useConvolution;
+    }
+
+    if (useConvolution)
+        convolution.process (context);
 }
 
 //==============================================================================
@@ -269,6 +363,9 @@ void DistanceCompensatorAudioProcessor::setStateInformation (const void* data, i
             auto oscConfig = parameters.state.getChildWithName ("OSCConfig");
             if (oscConfig.isValid())
                 oscParameterInterface.setConfig (oscConfig);
+
+            if (parameters.state.hasProperty ("filterFile"))
+                loadFilters (juce::File (parameters.state.getProperty ("filterFile").toString()));
         }
 }
 
@@ -294,6 +391,10 @@ void DistanceCompensatorAudioProcessor::parameterChanged (const juce::String& pa
     {
         updateGains();
     }
+    else if (parameterID == "enableFilters")
+    {
+        convolution.setFiltersEnabled (newValue >= 0.5f);
+    }
     else if (parameterID.startsWith ("distance"))
     {
         updateDelays();
@@ -464,6 +565,16 @@ const bool DistanceCompensatorAudioProcessor::processNotYetConsumedOSCMessage (
         }
         return true;
     }
+    else if (msg.getAddressPattern().toString().equalsIgnoreCase ("/loadFilters")
+             && msg.size() >= 1)
+    {
+        if (msg[0].isString())
+        {
+            juce::File fileToLoad (msg[0].getString());
+            loadFilters (fileToLoad);
+        }
+        return true;
+    }
     else if (msg.getAddressPattern().toString().equalsIgnoreCase ("/updateReference"))
     {
         updateParameters();
@@ -519,6 +630,21 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "enableFilters",
+        "Enable Room Correction Filters",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        1.0f,
+        [] (float value)
+        {
+            if (value >= 0.5f)
+                return "Yes";
+            else
+                return "No";
+        },
+        nullptr));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay (
         "speedOfSound",
         "Speed of Sound",
@@ -29,9 +29,11 @@ using namespace juce::dsp;
 #include "../../resources/customComponents/MailBox.h"
 
 #define CONFIGURATIONHELPER_ENABLE_LOUDSPEAKERLAYOUT_METHODS 1
+#define CONFIGURATIONHELPER_ENABLE_FILTER_METHODS 1
 #include "../../resources/ConfigurationHelper.h"
 
 #include "../../resources/Conversions.h"
+#include "../../resources/MultiChannelConvolution.h"
 #include "../../resources/MultiChannelDelay.h"
 #include "../../resources/MultiChannelGain.h"
 
@@ -90,6 +92,7 @@ public:
     juce::File getLastDir() { return lastDir; };
 
     void loadConfiguration (const juce::File& presetFile);
+    void loadFilters (const juce::File& filterFile);
 
     float distanceToGainInDecibels (const float distance);
     float distanceToDelayInSeconds (const float distance);
@@ -97,6 +100,7 @@ public:
     void updateDelays();
     void updateGains();
     void updateParameters();
+    void updateLatency();
 
     bool updateMessage = false;
 
@@ -116,6 +120,7 @@ private:
     std::atomic<float>* referenceZ;
     std::atomic<float>* enableGains;
     std::atomic<float>* enableDelays;
+    std::atomic<float>* enableFilters;
 
     std::atomic<float>* enableCompensation[64];
     std::atomic<float>* distance[64];
@@ -131,6 +136,8 @@ private:
     // processors
     MultiChannelGain<float> gain;
     MultiChannelDelay<float> delay;
+    MultiChannelConvolution convolution;
+    bool filtersActive = false;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DistanceCompensatorAudioProcessor)
 };
@@ -36,9 +36,7 @@ DualDelayAudioProcessor::DualDelayAudioProcessor() :
     #endif
             ,
 #endif
-        createParameterLayout()),
-    LFOLeft ([] (float phi) { return std::sin (phi); }),
-    LFORight ([] (float phi) { return std::sin (phi); })
+        createParameterLayout())
 {
     dryGain = parameters.getRawParameterValue ("dryGain");
     wetGainL = parameters.getRawParameterValue ("wetGainL");
@@ -62,10 +60,11 @@ DualDelayAudioProcessor::DualDelayAudioProcessor() :
     orderSetting = parameters.getRawParameterValue ("orderSetting");
     parameters.addParameterListener ("orderSetting", this);
 
-    cos_z.resize (8);
-    sin_z.resize (8);
-    cos_z.set (0, 1.f);
-    sin_z.set (0, 0.f);
+    for (auto& line : delayLines)
+    {
+        line.filters.prepare (64, 2);
+        line.filters.setCoefficientRamping (true);
+    }
 }
 
 DualDelayAudioProcessor::~DualDelayAudioProcessor()
@@ -106,44 +105,29 @@ void DualDelayAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     spec.sampleRate = sampleRate;
     spec.numChannels = 1;
     spec.maximumBlockSize = samplesPerBlock;
-    LFOLeft.prepare (spec);
-    LFORight.prepare (spec);
-    LFOLeft.setFrequency (*lfoRateL, true);
-    LFORight.setFrequency (*lfoRateR, true);
 
-    for (int i = lowPassFiltersLeft.size(); --i >= 0;)
+    const float delayTimes[2] = { *delayTimeL, *delayTimeR };
+    const float lfoRates[2] = { *lfoRateL, *lfoRateR };
+
+    for (int i = 0; i < 2; ++i)
     {
-        lowPassFiltersLeft[i]->reset();
-        lowPassFiltersRight[i]->reset();
-        highPassFiltersLeft[i]->reset();
-        highPassFiltersRight[i]->reset();
-    }
+        auto& line = delayLines[i];
+        line.lfo.prepare (spec);
+        line.lfo.setFrequency (lfoRates[i], true);
 
-    delayBufferLeft.clear();
-    delayBufferRight.clear();
+        line.filters.reset();
+        line.lowPassCutOff = -1.0f;
+        line.highPassCutOff = -1.0f;
 
-    writeOffsetLeft = 0;
-    writeOffsetRight = 0;
-    readOffsetLeft = 0;
-    readOffsetRight = 0;
+        std::fill (line.ring.begin(), line.ring.end(), 0.0f);
+        line.readOffset = 0;
+        line.output.clear();
+        line.input.clear();
+
+        line.lastDelay = delayTimes[i] * sampleRate / 1000.0 * 128;
+    }
 
     delay.resize (samplesPerBlock);
-    interpCoeffIdx.resize (samplesPerBlock);
-    idx.resize (samplesPerBlock);
-
-    //AudioIN.setSize(AudioIN.getNumChannels(), samplesPerBlock);
-    //delayOutLeft.setSize(delayOutLeft.getNumChannels(), samplesPerBlock);
-    //delayOutRight.setSize(delayOutRight.getNumChannels(), samplesPerBlock);
-    delayOutLeft.clear();
-    delayOutRight.clear();
-
-    //delayInLeft.setSize(delayInLeft.getNumChannels(), samplesPerBlock);
-    //delayInRight.setSize(delayInRight.getNumChannels(), samplesPerBlock);
-    delayInLeft.clear();
-    delayInRight.clear();
-
-    _delayL = *delayTimeL * sampleRate / 1000.0 * 128;
-    _delayR = *delayTimeR * sampleRate / 1000.0 * 128;
 }
 
 void DualDelayAudioProcessor::releaseResources()
@@ -171,24 +155,21 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     for (int channel = nCh; channel < totalNumInputChannels; ++channel)
         buffer.clear (channel, 0, spb);
 
-    LFOLeft.setFrequency (*lfoRateL);
-    LFORight.setFrequency (*lfoRateR);
+    // parameters of both delay lines: left, right
+    auto toGain = [] (const std::atomic<float>* dB)
+    { return juce::Decibels::decibelsToGain (dB->load(), -59.91f); };
 
-    for (int i = 0; i < nCh; ++i)
-    {
-        lowPassFiltersLeft[i]->setCoefficients (juce::IIRCoefficients::makeLowPass (
-            fs,
-            juce::jmin (fs / 2.0, static_cast<double> (*LPcutOffL))));
-        lowPassFiltersRight[i]->setCoefficients (juce::IIRCoefficients::makeLowPass (
-            fs,
-            juce::jmin (fs / 2.0, static_cast<double> (*LPcutOffR))));
-        highPassFiltersLeft[i]->setCoefficients (juce::IIRCoefficients::makeHighPass (
-            fs,
-            juce::jmin (fs / 2.0, static_cast<double> (*HPcutOffL))));
-        highPassFiltersRight[i]->setCoefficients (juce::IIRCoefficients::makeHighPass (
-            fs,
-            juce::jmin (fs / 2.0, static_cast<double> (*HPcutOffR))));
-    }
+    const float wetGains[2] = { toGain (wetGainL), toGain (wetGainR) };
+    const float feedbackGains[2] = { toGain (feedbackL), toGain (feedbackR) };
+    const float bleedGains[2] = { toGain (xfeedbackR), toGain (xfeedbackL) }; // from the other line
+    const float rotations[2] = { *rotationL, *rotationR };
+    const float lowPassCutOffs[2] = { *LPcutOffL, *LPcutOffR };
+    const float highPassCutOffs[2] = { *HPcutOffL, *HPcutOffR };
+    const float delays[2] = { *delayTimeL * msToFractSmpls, *delayTimeR * msToFractSmpls };
+    const float lfoDepths[2] = { *lfoDepthL * msToFractSmpls, *lfoDepthR * msToFractSmpls };
+
+    delayLines[0].lfo.setFrequency (*lfoRateL);
+    delayLines[1].lfo.setFrequency (*lfoRateR);
 
     // ==================== MAKE COPY OF INPUT BUFFER==============================
     for (int channel = 0; channel < nCh; ++channel)
@@ -196,248 +177,105 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         AudioIN.copyFrom (channel, 0, buffer, channel, 0, spb);
     }
 
-    // ==================== READ FROM DELAYLINE AND GENERTE OUTPUT SIGNAL ===========
-    // LEFT CHANNEL
-    if (readOffsetLeft + spb >= delayBufferLength)
-    { // overflow
-        int nFirstRead = delayBufferLength - readOffsetLeft;
-
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayOutLeft
-                .copyFrom (channel, 0, delayBufferLeft, channel, readOffsetLeft, nFirstRead);
-            delayOutLeft
-                .copyFrom (channel, nFirstRead, delayBufferLeft, channel, 0, spb - nFirstRead);
-        }
-        delayBufferLeft.clear (readOffsetLeft, nFirstRead);
-        delayBufferLeft.clear (0, spb - nFirstRead);
+    // ==================== READ FROM DELAYLINES AND GENERATE OUTPUT SIGNAL ===========
+    for (auto& line : delayLines)
+        readDelayLine (line, nCh, spb, delayBufferLength);
 
-        readOffsetLeft += spb;
-        readOffsetLeft -= delayBufferLength;
-    }
-    else
-    { //noverflow
+    buffer.applyGain (juce::Decibels::decibelsToGain (dryGain->load(), -59.91f)); //dry signal
+    for (int i = 0; i < 2; ++i)
         for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayOutLeft.copyFrom (channel, 0, delayBufferLeft, channel, readOffsetLeft, spb);
-        }
-        delayBufferLeft.clear (readOffsetLeft, spb);
-        readOffsetLeft += spb;
-    }
+            buffer.addFrom (channel, 0, delayLines[i].output, channel, 0, spb, wetGains[i]);
 
-    // RIGHT CHANNEL
-    if (readOffsetRight + spb >= delayBufferLength)
-    { // overflow
-        int nFirstRead = delayBufferLength - readOffsetRight;
-
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayOutRight
-                .copyFrom (channel, 0, delayBufferRight, channel, readOffsetRight, nFirstRead);
-            delayOutRight
-                .copyFrom (channel, nFirstRead, delayBufferRight, channel, 0, spb - nFirstRead);
-        }
-        delayBufferRight.clear (readOffsetRight, nFirstRead);
-        delayBufferRight.clear (0, spb - nFirstRead);
+    // ================ ADD INPUT AND FED BACK OUTPUT WITH PROCESSING ===========
+    for (int i = 0; i < 2; ++i)
+    {
+        auto& line = delayLines[i];
+        const auto& other = delayLines[1 - i];
 
-        readOffsetRight += spb;
-        readOffsetRight -= delayBufferLength;
-    }
-    else
-    { //noverflow
         for (int channel = 0; channel < nCh; ++channel)
         {
-            delayOutRight.copyFrom (channel, 0, delayBufferRight, channel, readOffsetRight, spb);
+            line.input.copyFrom (channel, 0, AudioIN, channel, 0, spb);
+            line.input.addFrom (channel, 0, line.output, channel, 0, spb, feedbackGains[i]);
+            line.input.addFrom (channel, 0, other.output, channel, 0, spb, bleedGains[i]);
         }
-        delayBufferRight.clear (readOffsetRight, spb);
-        readOffsetRight += spb;
-    }
-
-    // ========== OUTPUT
-    buffer.applyGain (juce::Decibels::decibelsToGain (dryGain->load(), -59.91f)); //dry signal
-    for (int channel = 0; channel < nCh; ++channel)
-    {
-        buffer.addFrom (channel,
-                        0,
-                        delayOutLeft,
-                        channel,
-                        0,
-                        spb,
-                        juce::Decibels::decibelsToGain (wetGainL->load(), -59.91f)); //wet signal
-        buffer.addFrom (channel,
-                        0,
-                        delayOutRight,
-                        channel,
-                        0,
-                        spb,
-                        juce::Decibels::decibelsToGain (wetGainR->load(), -59.91f)); //wet signal
-    }
-
-    // ================ ADD INPUT AND FED BACK OUTPUT WITH PROCESSING ===========
-
-    for (int channel = 0; channel < nCh; ++channel) // should be optimizable with SIMD
-    {
-        delayInLeft.copyFrom (channel, 0, AudioIN.getReadPointer (channel), spb); // input
-        delayInLeft.addFrom (
-            channel,
-            0,
-            delayOutLeft.getReadPointer (channel),
-            spb,
-            juce::Decibels::decibelsToGain (feedbackL->load(), -59.91f)); // feedback gain
-        delayInLeft.addFrom (
-            channel,
-            0,
-            delayOutRight.getReadPointer (channel),
-            spb,
-            juce::Decibels::decibelsToGain (xfeedbackR->load(), -59.91f)); // feedback bleed gain
-        lowPassFiltersLeft[channel]->processSamples (delayInLeft.getWritePointer (channel),
-                                                     spb); //filter
-        highPassFiltersLeft[channel]->processSamples (delayInLeft.getWritePointer (channel),
-                                                      spb); //filter
-
-        delayInRight.copyFrom (channel, 0, AudioIN.getReadPointer (channel), spb); // input
-        delayInRight.addFrom (
-            channel,
-            0,
-            delayOutRight.getReadPointer (channel),
-            spb,
-            juce::Decibels::decibelsToGain (feedbackR->load(), -59.91f)); // feedback gain
-        delayInRight.addFrom (
-            channel,
-            0,
-            delayOutLeft.getReadPointer (channel),
-            spb,
-            juce::Decibels::decibelsToGain (xfeedbackL->load(), -59.91f)); // feedback bleed gain
-        lowPassFiltersRight[channel]->processSamples (delayInRight.getWritePointer (channel),
-                                                      spb); //filter
-        highPassFiltersRight[channel]->processSamples (delayInRight.getWritePointer (channel),
-                                                       spb); //filter
-    }
 
-    // left delay rotation
-    calcParams (*rotationL / 180.0f * juce::MathConstants<float>::pi);
-    rotateBuffer (&delayInLeft, nCh, spb);
+        updateFilters (line, fs, lowPassCutOffs[i], highPassCutOffs[i]);
+        line.filters.process (line.input.getArrayOfWritePointers(), nCh, spb);
 
-    // right delay rotation
-    calcParams (*rotationR / 180.0f * juce::MathConstants<float>::pi);
-    rotateBuffer (&delayInRight, nCh, spb);
+        rotate (line.input,
+                workingOrder,
+                rotations[i] / 180.0f * juce::MathConstants<float>::pi,
+                spb);
 
-    // =============== UPDATE DELAY PARAMETERS =====
-    float delayL = *delayTimeL * msToFractSmpls;
-    float delayR = *delayTimeR * msToFractSmpls;
-
-    int firstIdx, copyL;
-
-    // ============= WRITE INTO DELAYLINE ========================
-    // ===== LEFT CHANNEL
-
-    float delayStep = (delayL - _delayL) / spb;
-    //calculate firstIdx and copyL
-    for (int i = 0; i < spb; ++i)
-    {
-        delay.set (i,
-                   i * 128 + _delayL + i * delayStep
-                       + *lfoDepthL * msToFractSmpls * LFOLeft.processSample (1.0f));
+        writeDelayLine (line, nCh, spb, delayBufferLength, delays[i], lfoDepths[i]);
     }
-    firstIdx =
-        (((int) *std::min_element (delay.getRawDataPointer(), delay.getRawDataPointer() + spb))
-         >> interpShift)
-        - interpOffset;
-    int lastIdx =
-        (((int) *std::max_element (delay.getRawDataPointer(), delay.getRawDataPointer() + spb))
-         >> interpShift)
-        - interpOffset;
-    copyL = abs (firstIdx - lastIdx) + interpLength;
+}
 
-    delayTempBuffer.clear (0, copyL);
-    //delayTempBuffer.clear();
-    const float* const* readPtrArr = delayInLeft.getArrayOfReadPointers();
+void DualDelayAudioProcessor::readDelayLine (DelayLine& line,
+                                             const int nCh,
+                                             const int spb,
+                                             const int length)
+{
+    const int stride = numRingChannels;
 
-    for (int i = 0; i < spb; ++i)
+    int done = 0;
+    while (done < spb)
     {
-        float integer;
-        float fraction = modff (delay[i], &integer);
-        int delayInt = (int) integer;
-
-        int interpCoeffIdx = delayInt & interpMask;
-        delayInt = delayInt >> interpShift;
-        int idx = delayInt - interpOffset - firstIdx;
-
-#if JUCE_USE_SSE_INTRINSICS
-        __m128 interp = getInterpolatedLagrangeWeights (interpCoeffIdx, fraction);
+        const int n = juce::jmin (spb - done, length - line.readOffset);
+        float* rows = line.ring.data() + line.readOffset * stride;
 
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer (ch, idx);
-
-            __m128 destSamples = _mm_loadu_ps (dest);
-            __m128 srcSample = _mm_set1_ps (readPtrArr[ch][i]);
-            destSamples = _mm_add_ps (destSamples, _mm_mul_ps (interp, srcSample));
-            _mm_storeu_ps (dest, destSamples);
-        }
-#else /* !JUCE_USE_SSE_INTRINSICS */
-        float interp[4];
-        getInterpolatedLagrangeWeights (interpCoeffIdx, fraction, interp);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer (ch, idx);
-            float src = readPtrArr[ch][i];
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
-        }
-#endif /* JUCE_USE_SSE_INTRINSICS */
-    }
-    writeOffsetLeft = readOffsetLeft + firstIdx;
-    if (writeOffsetLeft >= delayBufferLength)
-        writeOffsetLeft -= delayBufferLength;
-
-    if (writeOffsetLeft + copyL >= delayBufferLength)
-    { // overflow
-        int firstNumCopy = delayBufferLength - writeOffsetLeft;
-        int secondNumCopy = copyL - firstNumCopy;
-
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferLeft
-                .addFrom (channel, writeOffsetLeft, delayTempBuffer, channel, 0, firstNumCopy);
-            delayBufferLeft
-                .addFrom (channel, 0, delayTempBuffer, channel, firstNumCopy, secondNumCopy);
-        }
-    }
-    else
-    { // no overflow
         for (int channel = 0; channel < nCh; ++channel)
         {
-            delayBufferLeft.addFrom (channel, writeOffsetLeft, delayTempBuffer, channel, 0, copyL);
+            float* dest = line.output.getWritePointer (channel, done);
+            for (int i = 0; i < n; ++i)
+                dest[i] = rows[i * stride + channel];
         }
+        juce::FloatVectorOperations::clear (rows, n * stride);
+
+        done += n;
+        line.readOffset += n;
+        if (line.readOffset >= length)
+            line.readOffset -= length;
     }
+}
 
-    // ===== Right CHANNEL
+void DualDelayAudioProcessor::writeDelayLine (DelayLine& line,
+                                              const int nCh,
+                                              const int spb,
+                                              const int length,
+                                              const float newDelay,
+                                              const float lfoDepth)
+{
+    const int stride = numRingChannels;
 
-    delayStep = (delayR - _delayR) / spb;
+    float delayStep = (newDelay - line.lastDelay) / spb;
     //calculate firstIdx and copyL
     for (int i = 0; i < spb; ++i)
     {
         delay.set (i,
-                   i * 128 + _delayR + i * delayStep
-                       + *lfoDepthR * msToFractSmpls * LFORight.processSample (1.0f));
+                   i * 128 + line.lastDelay + i * delayStep
+                       + lfoDepth * line.lfo.processSample (1.0f));
     }
-    firstIdx =
+    const int firstIdx =
         (((int) *std::min_element (delay.getRawDataPointer(), delay.getRawDataPointer() + spb))
          >> interpShift)
         - interpOffset;
-    lastIdx =
+    const int lastIdx =
         (((int) *std::max_element (delay.getRawDataPointer(), delay.getRawDataPointer() + spb))
          >> interpShift)
         - interpOffset;
-    copyL = abs (firstIdx - lastIdx) + interpLength;
+    const int copyL = abs (firstIdx - lastIdx) + interpLength;
 
-    delayTempBuffer.clear (0, copyL);
+    // all channels of a sample next to each other
+    for (int channel = 0; channel < nCh; ++channel)
+    {
+        const float* src = line.input.getReadPointer (channel);
+        for (int i = 0; i < spb; ++i)
+            interleavedInput[static_cast<size_t> (i * stride + channel)] = src[i];
+    }
 
-    const float* const* readPtrArrR = delayInRight.getArrayOfReadPointers();
+    float* scatter = line.scatter.data();
+    juce::FloatVectorOperations::clear (scatter, copyL * stride);
 
     for (int i = 0; i < spb; ++i)
     {
@@ -449,62 +287,66 @@ void DualDelayAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         delayInt = delayInt >> interpShift;
         int idx = delayInt - interpOffset - firstIdx;
 
-#if JUCE_USE_SSE_INTRINSICS
-        __m128 interp = getInterpolatedLagrangeWeights (interpCoeffIdx, fraction);
-
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer (ch, idx);
-
-            __m128 destSamples = _mm_loadu_ps (dest);
-            __m128 srcSample = _mm_set1_ps (readPtrArrR[ch][i]);
-            destSamples = _mm_add_ps (destSamples, _mm_mul_ps (interp, srcSample));
-            _mm_storeu_ps (dest, destSamples);
-        }
-#else /* !JUCE_USE_SSE_INTRINSICS */
         float interp[4];
         getInterpolatedLagrangeWeights (interpCoeffIdx, fraction, interp);
 
-        for (int ch = 0; ch < nCh; ++ch)
-        {
-            float* dest = delayTempBuffer.getWritePointer (ch, idx);
-            float src = readPtrArrR[ch][i];
-            dest[0] += interp[0] * src;
-            dest[1] += interp[1] * src;
-            dest[2] += interp[2] * src;
-            dest[3] += interp[3] * src;
-        }
-#endif /* JUCE_USE_SSE_INTRINSICS */
+        const float* src = interleavedInput.data() + i * stride;
+        float* dest = scatter + idx * stride;
+        for (int k = 0; k < interpLength; ++k)
+            juce::FloatVectorOperations::addWithMultiply (dest + k * stride, src, interp[k], nCh);
     }
-    writeOffsetRight = readOffsetRight + firstIdx;
-    if (writeOffsetRight >= delayBufferLength)
-        writeOffsetRight -= delayBufferLength;
 
-    if (writeOffsetRight + copyL >= delayBufferLength)
-    { // overflow
-        int firstNumCopy = delayBufferLength - writeOffsetRight;
-        int secondNumCopy = copyL - firstNumCopy;
+    int writeOffset = line.readOffset + firstIdx;
+    if (writeOffset >= length)
+        writeOffset -= length;
 
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferRight
-                .addFrom (channel, writeOffsetRight, delayTempBuffer, channel, 0, firstNumCopy);
-            delayBufferRight
-                .addFrom (channel, 0, delayTempBuffer, channel, firstNumCopy, secondNumCopy);
-        }
+    int done = 0;
+    while (done < copyL)
+    {
+        const int n = juce::jmin (copyL - done, length - writeOffset);
+        juce::FloatVectorOperations::add (line.ring.data() + writeOffset * stride,
+                                          scatter + done * stride,
+                                          n * stride);
+        done += n;
+        writeOffset = 0;
     }
-    else
-    { // no overflow
-        for (int channel = 0; channel < nCh; ++channel)
-        {
-            delayBufferRight
-                .addFrom (channel, writeOffsetRight, delayTempBuffer, channel, 0, copyL);
-        }
+
+    line.lastDelay = newDelay;
+}
+
+void DualDelayAudioProcessor::updateFilters (DelayLine& line,
+                                             const double fs,
+                                             const float lowPassCutOff,
+                                             const float highPassCutOff)
+{
+    auto toBiquad = [] (const juce::IIRCoefficients& c) -> iem::BiquadBank::Coefficients
+    {
+        return { c.coefficients[0],
+                 c.coefficients[1],
+                 c.coefficients[2],
+                 c.coefficients[3],
+                 c.coefficients[4] };
+    };
+
+    if (lowPassCutOff != line.lowPassCutOff)
+    {
+        line.filters.setCoefficients (
+            0,
+            toBiquad (juce::IIRCoefficients::makeLowPass (
+                fs,
+                juce::jmin (fs / 2.0, static_cast<double> (lowPassCutOff)))));
+        line.lowPassCutOff = lowPassCutOff;
     }
 
-    // =============== UPDATE DELAY PARAMETERS =====
-    _delayL = delayL;
-    _delayR = delayR;
+    if (highPassCutOff != line.highPassCutOff)
+    {
+        line.filters.setCoefficients (
+            1,
+            toBiquad (juce::IIRCoefficients::makeHighPass (
+                fs,
+                juce::jmin (fs / 2.0, static_cast<double> (highPassCutOff)))));
+        line.highPassCutOff = highPassCutOff;
+    }
 }
 
 //==============================================================================
@@ -557,84 +399,29 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new DualDelayAudioProcessor();
 }
 
-void DualDelayAudioProcessor::calcParams (float phi)
+void DualDelayAudioProcessor::rotate (juce::AudioBuffer<float>& bufferToRotate,
+                                      const int order,
+                                      const float phi,
+                                      const int samples)
 {
-    // use mathematical negative angles!
-    cos_z.set (1, cos (phi));
-    sin_z.set (1, sin (phi));
-
-    // chebyshev recursion
-    for (int i = 2; i < 8; i++)
+    // rotation about the z-axis only mixes the pairs with the same degree and +-m
+    for (int m = 1; m <= order; ++m)
     {
-        cos_z.set (i, 2 * cos_z[1] * cos_z[i - 1] - cos_z[i - 2]);
-        sin_z.set (i, 2 * cos_z[1] * sin_z[i - 1] - sin_z[i - 2]);
-    }
-}
-
-void DualDelayAudioProcessor::rotateBuffer (juce::AudioBuffer<float>* bufferToRotate,
-                                            const int nCh,
-                                            const int samples)
-{
-    juce::AudioBuffer<float> tempBuffer;
-    tempBuffer.makeCopyOf (*bufferToRotate);
-    bufferToRotate->clear();
+        // use mathematical negative angles!
+        const float c = std::cos (m * phi);
+        const float s = std::sin (m * phi);
 
-    //int nCh = juce::jmin(nChannels, bufferToRotate->getNumChannels());
-
-    for (int acn_out = 0; acn_out < nCh; ++acn_out)
-    {
-        int l_out = 0;
-        int m_out = 0;
-
-        ACNtoLM (acn_out, l_out, m_out);
-
-        for (int acn_in = 0; acn_in < nCh; ++acn_in)
+        for (int l = m; l <= order; ++l)
         {
-            int l_in = 0; // degree 0, 1, 2, 3, 4, ......
-            int m_in = 0; // order ...., -2, -1, 0 , 1, 2, ...
-
-            ACNtoLM (acn_in, l_in, m_in);
-
-            if (abs (m_out) == abs (m_in) && l_in == l_out)
-            { // if degree and order match  do something
-
-                if (m_out == 0 && m_in == 0)
-                {
-                    // gain 1 -> no interpolation needed
-                    bufferToRotate->copyFrom (acn_out, 0, tempBuffer, acn_in, 0, samples);
-                }
-                else if (m_in < 0 && m_out < 0)
-                {
-                    bufferToRotate->addFrom (acn_out,
-                                             0,
-                                             tempBuffer.getReadPointer (acn_in),
-                                             samples,
-                                             cos_z[-m_out]); //
-                }
-                else if (m_in < 0 && m_out > 0)
-                {
-                    bufferToRotate->addFrom (acn_out,
-                                             0,
-                                             tempBuffer.getReadPointer (acn_in),
-                                             samples,
-                                             -sin_z[m_out]);
-                }
-                else if (m_in > 0 && m_out > 0)
-                {
-                    bufferToRotate->addFrom (acn_out,
-                                             0,
-                                             tempBuffer.getReadPointer (acn_in),
-                                             samples,
-                                             cos_z[m_out]);
-                }
-                else if (m_in > 0 && m_out < 0)
-                {
-                    bufferToRotate->addFrom (acn_out,
-                                             0,
-                                             tempBuffer.getReadPointer (acn_in),
-                                             samples,
-                                             sin_z[m_in]);
-                }
+            float* positive = bufferToRotate.getWritePointer (l * l + l + m);
+            float* negative = bufferToRotate.getWritePointer (l * l + l - m);
+
+            for (int i = 0; i < samples; ++i)
+            {
+                const float p = positive[i];
+                const float n = negative[i];
+                positive[i] = c * p - s * n;
+                negative[i] = s * p + c * n;
             }
         }
     }
@@ -652,29 +439,9 @@ void DualDelayAudioProcessor::updateBuffers()
     DBG ("IOHelper: output size: " << output.getSize());
 
     const int nChannels = juce::jmin (input.getNumberOfChannels(), output.getNumberOfChannels());
-    const int _nChannels =
-        juce::jmin (input.getPreviousNumberOfChannels(), output.getPreviousNumberOfChannels());
     const int samplesPerBlock = getBlockSize();
 
     const double sampleRate = getSampleRate();
-    if (nChannels > _nChannels)
-    {
-        for (int i = _nChannels; i < nChannels; ++i)
-        {
-            lowPassFiltersLeft.add (new juce::IIRFilter());
-            lowPassFiltersRight.add (new juce::IIRFilter());
-            highPassFiltersLeft.add (new juce::IIRFilter());
-            highPassFiltersRight.add (new juce::IIRFilter());
-        }
-    }
-    else
-    {
-        const int diff = _nChannels - nChannels;
-        lowPassFiltersLeft.removeRange (nChannels, diff);
-        lowPassFiltersRight.removeRange (nChannels, diff);
-        highPassFiltersLeft.removeRange (nChannels, diff);
-        highPassFiltersRight.removeRange (nChannels, diff);
-    }
 
     AudioIN.setSize (nChannels, samplesPerBlock);
     AudioIN.clear();
@@ -682,25 +449,23 @@ void DualDelayAudioProcessor::updateBuffers()
     const int maxLfoDepth = static_cast<int> (ceil (
         parameters.getParameterRange ("lfoDepthL").getRange().getEnd() * sampleRate / 500.0f));
 
-    delayBufferLeft.setSize (nChannels,
-                             samplesPerBlock + interpOffset - 1 + maxLfoDepth + sampleRate);
-    delayBufferRight.setSize (nChannels,
-                              samplesPerBlock + interpOffset - 1 + maxLfoDepth + sampleRate);
-    delayBufferLeft.clear();
-    delayBufferRight.clear();
-
-    delayTempBuffer.setSize (nChannels,
-                             samplesPerBlock + interpOffset - 1 + maxLfoDepth + sampleRate * 0.5);
-
-    delayOutLeft.setSize (nChannels, samplesPerBlock);
-    delayOutRight.setSize (nChannels, samplesPerBlock);
-    delayOutLeft.clear();
-    delayOutRight.clear();
-
-    delayInLeft.setSize (nChannels, samplesPerBlock);
-    delayInRight.setSize (nChannels, samplesPerBlock);
-    delayInLeft.clear();
-    delayInRight.clear();
+    numRingChannels = nChannels;
+    const int ringLength = static_cast<int> (sampleRate);
+    const int scatterLength =
+        static_cast<int> (samplesPerBlock + interpOffset - 1 + maxLfoDepth + sampleRate * 0.5);
+    interleavedInput.assign (static_cast<size_t> (samplesPerBlock * nChannels), 0.0f);
+
+    for (auto& line : delayLines)
+    {
+        line.ring.assign (static_cast<size_t> (ringLength * nChannels), 0.0f);
+        line.scatter.assign (static_cast<size_t> (scatterLength * nChannels), 0.0f);
+
+        line.output.setSize (nChannels, samplesPerBlock);
+        line.input.setSize (nChannels, samplesPerBlock);
+        line.output.clear();
+        line.input.clear();
+        line.readOffset = 0;
+    }
 }
 
 //==============================================================================
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/BiquadBank.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/interpLagrangeWeights.h"
 #include "../JuceLibraryCode/JuceHeader.h"
@@ -94,44 +95,52 @@ private:
     std::atomic<float>* lfoDepthR;
     std::atomic<float>* orderSetting;
 
-    float _delayL, _delayR;
+    /**
+     The left and right delay lines run through the same steps: feedback mix, low- and high-pass,
+     rotation and the LFO-modulated write into the delay line.
+     The delay lines are interleaved (all channels of a sample next to each other), so each
+     interpolation tap gets added to all channels at once.
+     */
+    struct DelayLine
+    {
+        DelayLine() : lfo ([] (float phi) { return std::sin (phi); }) {}
+
+        juce::dsp::Oscillator<float> lfo;
+        iem::BiquadBank filters; // low-pass and high-pass
+        float lowPassCutOff = -1.0f;
+        float highPassCutOff = -1.0f;
+
+        std::vector<float> ring;
+        std::vector<float> scatter; // interpolated block, before it gets added to the ring
+        juce::AudioBuffer<float> output; // read from the ring
+        juce::AudioBuffer<float> input; // written to the ring
+
+        float lastDelay = 0.0f; // in 1/128 samples
+        int readOffset = 0;
+    };
+
+    void readDelayLine (DelayLine& line, const int nCh, const int spb, const int length);
+    void writeDelayLine (DelayLine& line,
+                         const int nCh,
+                         const int spb,
+                         const int length,
+                         const float newDelay,
+                         const float lfoDepth);
+    static void updateFilters (DelayLine& line,
+                               const double fs,
+                               const float lowPassCutOff,
+                               const float highPassCutOff);
+    static void rotate (juce::AudioBuffer<float>& bufferToRotate,
+                        const int order,
+                        const float phi,
+                        const int samples);
 
     juce::AudioBuffer<float> AudioIN;
+    DelayLine delayLines[2]; // left, right
 
-    juce::AudioBuffer<float> delayBufferLeft;
-    juce::AudioBuffer<float> delayBufferRight;
-    juce::AudioBuffer<float> delayOutLeft;
-    juce::AudioBuffer<float> delayOutRight;
-    juce::AudioBuffer<float> delayInLeft;
-    juce::AudioBuffer<float> delayInRight;
-
-    juce::AudioBuffer<float> delayTempBuffer;
-
+    int numRingChannels = 0;
+    std::vector<float> interleavedInput;
     juce::Array<float> delay;
-    juce::Array<int> interpCoeffIdx;
-    juce::Array<int> idx;
-
-    juce::dsp::Oscillator<float> LFOLeft, LFORight;
-
-    int writeOffsetLeft;
-    int writeOffsetRight;
-    int readOffsetLeft;
-    int readOffsetRight;
-
-    float* readPointer;
-    juce::Array<float> sin_z;
-    juce::Array<float> cos_z;
-
-    void calcParams (float phi);
-    void rotateBuffer (juce::AudioBuffer<float>* bufferToRotate,
-                       const int nChannels,
-                       const int samples);
-    float feedback = 0.8f;
-
-    juce::OwnedArray<juce::IIRFilter> lowPassFiltersLeft;
-    juce::OwnedArray<juce::IIRFilter> lowPassFiltersRight;
-    juce::OwnedArray<juce::IIRFilter> highPassFiltersLeft;
-    juce::OwnedArray<juce::IIRFilter> highPassFiltersRight;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DualDelayAudioProcessor)
 };
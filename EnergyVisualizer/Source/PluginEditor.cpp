@@ -35,7 +35,7 @@ EnergyVisualizerAudioProcessorEditor::EnergyVisualizerAudioProcessorEditor (
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
-    setResizeLimits (710, 410, 1500, 1200);
+    setResizeLimits (710, 490, 1500, 1200);
     setLookAndFeel (&globalLaF);
 
     addAndMakeVisible (&title);
@@ -88,6 +88,19 @@ EnergyVisualizerAudioProcessorEditor::EnergyVisualizerAudioProcessorEditor (
     tbHoldMax.setButtonText ("Hold max");
     tbHoldMax.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[2]);
 
+    addAndMakeVisible (cbDoaMethod);
+    cbDoaMethod.addItem ("Off", 1);
+    cbDoaMethod.addItem ("Intensity Vector", 2);
+    cbDoaMethod.addItem ("Steered Response", 3);
+    cbDoaMethod.addItem ("MUSIC", 4);
+    cbDoaMethodAttachment.reset (new ComboBoxAttachment (valueTreeState, "doaMethod", cbDoaMethod));
+
+    addAndMakeVisible (cbDoaNumSources);
+    for (int i = 1; i <= SourceTracker::maxNumSources; ++i)
+        cbDoaNumSources.addItem (juce::String (i), i);
+    cbDoaNumSourcesAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "doaNumSources", cbDoaNumSources));
+
     addAndMakeVisible (&lbPeakLevel);
     lbPeakLevel.setText ("Peak level");
 
@@ -97,6 +110,12 @@ EnergyVisualizerAudioProcessorEditor::EnergyVisualizerAudioProcessorEditor (
     addAndMakeVisible (&lbRMStimeConstant);
     lbRMStimeConstant.setText ("Time Constant");
 
+    addAndMakeVisible (&lbDoaMethod);
+    lbDoaMethod.setText ("DOA Estimation");
+
+    addAndMakeVisible (&lbDoaNumSources);
+    lbDoaNumSources.setText ("Sources");
+
     addAndMakeVisible (&visualizer);
     visualizer.setRmsDataPtr (p.rms.data());
 
@@ -137,7 +156,7 @@ void EnergyVisualizerAudioProcessorEditor::resized()
 
     juce::Rectangle<int> UIarea = area.removeFromRight (106);
     const juce::Point<int> UIareaCentre = UIarea.getCentre();
-    UIarea.setHeight (320);
+    UIarea.setHeight (400);
     UIarea.setCentre (UIareaCentre);
 
     juce::Rectangle<int> dynamicsArea = UIarea.removeFromTop (210);
@@ -165,9 +184,16 @@ void EnergyVisualizerAudioProcessorEditor::resized()
     lbRMStimeConstant.setBounds (UIarea.removeFromTop (12));
 
     UIarea.removeFromTop (10);
-    UIarea.removeFromLeft (15);
-
-    tbHoldMax.setBounds (UIarea.removeFromTop (20));
+    tbHoldMax.setBounds (UIarea.removeFromTop (20).withTrimmedLeft (15));
+
+    UIarea.removeFromTop (15);
+    lbDoaMethod.setBounds (UIarea.removeFromTop (12));
+    UIarea.removeFromTop (3);
+    cbDoaMethod.setBounds (UIarea.removeFromTop (20));
+    UIarea.removeFromTop (5);
+    lbDoaNumSources.setBounds (UIarea.removeFromTop (12));
+    UIarea.removeFromTop (3);
+    cbDoaNumSources.setBounds (UIarea.removeFromTop (20));
 
     area.removeFromRight (5);
     visualizer.setBounds (area);
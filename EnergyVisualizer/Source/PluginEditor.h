@@ -73,14 +73,16 @@ private:
 
     ReverseSlider slPeakLevel, slDynamicRange, slRMStimeConstant;
     juce::ToggleButton tbHoldMax;
+    juce::ComboBox cbDoaMethod, cbDoaNumSources;
 
-    SimpleLabel lbPeakLevel, lbDynamicRange, lbRMStimeConstant;
+    SimpleLabel lbPeakLevel, lbDynamicRange, lbRMStimeConstant, lbDoaMethod, lbDoaNumSources;
     std::unique_ptr<SliderAttachment> slPeakLevelAttachment, slDynamicRangeAttachment,
         slRMStimeConstantAttachment;
 
     std::unique_ptr<ComboBoxAttachment> cbNormalizationAtachement;
     std::unique_ptr<ComboBoxAttachment> cbOrderAtachement;
     std::unique_ptr<ButtonAttachment> tbHoldMaxAttachment;
+    std::unique_ptr<ComboBoxAttachment> cbDoaMethodAttachment, cbDoaNumSourcesAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EnergyVisualizerAudioProcessorEditor)
 };
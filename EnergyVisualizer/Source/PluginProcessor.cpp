@@ -45,9 +45,17 @@ EnergyVisualizerAudioProcessor::EnergyVisualizerAudioProcessor() :
     dynamicRange = parameters.getRawParameterValue ("dynamicRange");
     holdMax = parameters.getRawParameterValue ("holdMax");
     RMStimeConstant = parameters.getRawParameterValue ("RMStimeConstant");
+    doaMethod = parameters.getRawParameterValue ("doaMethod");
+    doaNumSources = parameters.getRawParameterValue ("doaNumSources");
 
     parameters.addParameterListener ("orderSetting", this);
     parameters.addParameterListener ("RMStimeConstant", this);
+    parameters.addParameterListener ("doaMethod", this);
+    parameters.addParameterListener ("doaNumSources", this);
+
+    sourceTracker.setMethod (static_cast<SourceTracker::Method> (juce::roundToInt (*doaMethod)));
+    sourceTracker.setNumSources (juce::roundToInt (*doaNumSources));
+    sourceTracker.setTimeConstant (*RMStimeConstant);
 
     for (int point = 0; point < nSamplePoints; ++point)
     {
@@ -112,6 +120,8 @@ void EnergyVisualizerAudioProcessor::prepareToPlay (double sampleRate, int sampl
 
     sampledSignal.resize (samplesPerBlock);
     std::fill (rms.begin(), rms.end(), 0.0f);
+
+    sourceTracker.prepare (sampleRate, samplesPerBlock);
 }
 
 void EnergyVisualizerAudioProcessor::releaseResources()
@@ -127,13 +137,17 @@ void EnergyVisualizerAudioProcessor::processBlock (juce::AudioSampleBuffer& buff
 
     checkInputAndOutput (this, *orderSetting, 0);
 
-    if (! doProcessing.get() && ! oscParameterInterface.getOSCSender().isConnected())
-        return;
-
     //const int nCh = buffer.getNumChannels();
     const int L = buffer.getNumSamples();
     const int workingOrder = juce::jmin (isqrt (buffer.getNumChannels()) - 1, input.getOrder());
 
+    // the DOA estimation runs independently of the visualization
+    sourceTracker.setInputFormat (workingOrder, *useSN3D >= 0.5f);
+    sourceTracker.pushSignals (buffer);
+
+    if (! doProcessing.get() && ! oscParameterInterface.getOSCSender().isConnected())
+        return;
+
     const int nCh = squares[workingOrder + 1];
 
     copyMaxRE (workingOrder, weights.data());
@@ -220,7 +234,14 @@ void EnergyVisualizerAudioProcessor::parameterChanged (const juce::String& param
     if (parameterID == "orderSetting")
         userChangedIOSettings = true;
     if (parameterID == "RMStimeConstant")
+    {
         timeConstant = exp (-1.0 / (getSampleRate() * (*RMStimeConstant / 1000) / getBlockSize()));
+        sourceTracker.setTimeConstant (newValue);
+    }
+    else if (parameterID == "doaMethod")
+        sourceTracker.setMethod (static_cast<SourceTracker::Method> (juce::roundToInt (newValue)));
+    else if (parameterID == "doaNumSources")
+        sourceTracker.setNumSources (juce::roundToInt (newValue));
 }
 
 //==============================================================================
@@ -316,6 +337,34 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return juce::String (value, 0); },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "doaMethod",
+        "DOA Estimation",
+        "",
+        juce::NormalisableRange<float> (0.0f, 3.0f, 1.0f),
+        0.0f,
+        [] (float value)
+        {
+            if (value >= 0.5f && value < 1.5f)
+                return "Intensity Vector";
+            else if (value >= 1.5f && value < 2.5f)
+                return "Steered Response";
+            else if (value >= 2.5f)
+                return "MUSIC";
+            else
+                return "Off";
+        },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "doaNumSources",
+        "Number of tracked sources",
+        "",
+        juce::NormalisableRange<float> (1.0f, SourceTracker::maxNumSources, 1.0f),
+        1.0f,
+        [] (float value) { return juce::String (value, 0); },
+        nullptr));
+
     return params;
 }
 
@@ -338,6 +387,20 @@ void EnergyVisualizerAudioProcessor::sendAdditionalOSCMessages (
     for (int i = 0; i < nSamplePoints; ++i)
         message.addFloat32 (rms[i]);
     oscSender.send (message);
+
+    if (sourceTracker.getMethod() != SourceTracker::Method::off)
+    {
+        // id, azimuth and elevation in degrees, and confidence for each tracked source
+        juce::OSCMessage doaMessage (address.toString() + "/DOA");
+        for (const auto& source : sourceTracker.getSources())
+        {
+            doaMessage.addInt32 (source.id);
+            doaMessage.addFloat32 (juce::radiansToDegrees (source.azimuth));
+            doaMessage.addFloat32 (juce::radiansToDegrees (source.elevation));
+            doaMessage.addFloat32 (source.confidence);
+        }
+        oscSender.send (doaMessage);
+    }
 }
 
 //==============================================================================
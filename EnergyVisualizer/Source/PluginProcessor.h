@@ -28,6 +28,7 @@
 #include "../../resources/efficientSHvanilla.h"
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "../hammerAitovSample.h"
+#include "SourceTracker.h"
 
 #define ProcessorClass EnergyVisualizerAudioProcessor
 
@@ -86,6 +87,9 @@ public:
     std::vector<float> rms;
     juce::Atomic<juce::Time> lastEditorTime;
 
+    /** In-process access to the direction-of-arrival estimates, e.g. for other components. */
+    SourceTracker& getSourceTracker() { return sourceTracker; }
+
 private:
     //==============================================================================
     // parameters
@@ -95,6 +99,8 @@ private:
     std::atomic<float>* dynamicRange;
     std::atomic<float>* holdMax;
     std::atomic<float>* RMStimeConstant;
+    std::atomic<float>* doaMethod;
+    std::atomic<float>* doaNumSources;
 
     float timeConstant;
 
@@ -104,6 +110,8 @@ private:
     std::vector<float> weights;
     std::vector<float> sampledSignal;
 
+    SourceTracker sourceTracker;
+
     void timerCallback() override;
     void sendAdditionalOSCMessages (juce::OSCSender& oscSender,
                                     const juce::OSCAddressPattern& address) override;
@@ -0,0 +1,745 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/Conversions.h"
+#include "../../resources/MaxRE.h"
+#include "../../resources/ambisonicTools.h"
+#include "../../resources/efficientSHvanilla.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../hammerAitovSample.h"
+
+/**
+ Direction-of-arrival estimator and source tracker.
+ The audio thread only pushes the Ambisonic signals into a lock-free FIFO. The spatial covariance
+ matrix, the estimation of the source directions on the nSamplePoints grid (intensity vector,
+ steered response power or MUSIC) and the tracking are done on a background thread, which
+ publishes the K strongest sources with a fixed update rate. The thread only runs while an
+ estimation method is selected, the FIFO holds a few update intervals of audio.
+ */
+class SourceTracker : private juce::Thread, private juce::AsyncUpdater
+{
+public:
+    static constexpr int maxNumChannels = 64;
+    static constexpr int maxNumSources = 8;
+
+    enum class Method
+    {
+        off = 0,
+        intensityVector,
+        steeredResponsePower,
+        music
+    };
+
+    struct Source
+    {
+        int id; // stays the same as long as the source is tracked
+        float azimuth; // in radians
+        float elevation; // in radians
+        float confidence; // 0 (diffuse / unreliable) ... 1 (single plane-wave)
+    };
+
+    /**
+     Gets notified from the tracker thread whenever new estimates are published.
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+        virtual void sourcesUpdated (const juce::Array<Source>& sources) = 0;
+    };
+
+    SourceTracker (const int updateIntervalInMilliseconds = 50) :
+        juce::Thread ("IEM SourceTracker"),
+        updateInterval (updateIntervalInMilliseconds),
+        fifo (1)
+    {
+        covariance.resize (maxNumChannels * maxNumChannels, 0.0);
+        accumulatedCovariance.resize (maxNumChannels * maxNumChannels, 0.0);
+        eigenVectors.resize (maxNumChannels * maxNumChannels, 0.0);
+        eigenValues.resize (maxNumChannels, 0.0);
+        steeringMatrix.resize (nSamplePoints * maxNumChannels, 0.0f);
+        spectrum.resize (nSamplePoints, 0.0f);
+        sortedSpectrum.resize (nSamplePoints, 0.0f);
+
+        for (int i = 0; i < nSamplePoints; ++i)
+            gridDirections[i] = juce::Vector3D<float> (hammerAitovSampleX[i],
+                                                       hammerAitovSampleY[i],
+                                                       hammerAitovSampleZ[i]);
+    }
+
+    ~SourceTracker() override
+    {
+        cancelPendingUpdate();
+        stopThread (1000);
+    }
+
+    //==============================================================================
+    /** Can be called from any thread, the tracker thread is started or stopped asynchronously. */
+    void setMethod (const Method newMethod)
+    {
+        method = static_cast<int> (newMethod);
+        triggerAsyncUpdate();
+    }
+    Method getMethod() const { return static_cast<Method> (method.load()); }
+
+    void setNumSources (const int newNumSources)
+    {
+        numSources = juce::jlimit (1, maxNumSources, newNumSources);
+    }
+
+    /** Sets the Ambisonic order and normalization of the signals passed to pushSignals(). */
+    void setInputFormat (const int newOrder, const bool newUseSN3D)
+    {
+        order = juce::jlimit (0, 7, newOrder);
+        useSN3D = newUseSN3D;
+    }
+
+    /** Time constant of the exponential covariance averaging. */
+    void setTimeConstant (const float timeConstantInMilliseconds)
+    {
+        timeConstant = juce::jmax (1.0f, timeConstantInMilliseconds);
+    }
+
+    /** Sizes the FIFO, must not be called while pushSignals() is running. */
+    void prepare (const double newSampleRate, const int maximumBlockSize)
+    {
+        stopThread (1000);
+
+        sampleRate = newSampleRate;
+        resetRequested = true;
+
+        const int samplesPerUpdate =
+            static_cast<int> (std::ceil (newSampleRate * updateInterval / 1000.0));
+        const int fifoSize = numBufferedUpdates * samplesPerUpdate + maximumBlockSize;
+
+        fifo.setTotalSize (fifoSize);
+        fifo.reset();
+        fifoBuffer.setSize (maxNumChannels, fifoSize);
+        chunkBuffer.setSize (maxNumChannels, fifoSize);
+
+        updateThreadState();
+    }
+
+    /**
+     Realtime-safe: copies the first squares[order + 1] channels into the FIFO. If the tracker
+     thread can't keep up, the remaining samples are dropped.
+     */
+    void pushSignals (const juce::AudioBuffer<float>& buffer)
+    {
+        if (getMethod() == Method::off)
+            return;
+
+        const int nCh = juce::jmin (buffer.getNumChannels(), squares[order.load() + 1]);
+        const int L = buffer.getNumSamples();
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (L, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            if (size1 > 0)
+                fifoBuffer.copyFrom (ch, start1, buffer, ch, 0, size1);
+            if (size2 > 0)
+                fifoBuffer.copyFrom (ch, start2, buffer, ch, size1, size2);
+        }
+        for (int ch = nCh; ch < maxNumChannels; ++ch)
+        {
+            if (size1 > 0)
+                fifoBuffer.clear (ch, start1, size1);
+            if (size2 > 0)
+                fifoBuffer.clear (ch, start2, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    /** Returns a copy of the latest published estimates, sorted by confidence. */
+    juce::Array<Source> getSources() const
+    {
+        const juce::SpinLock::ScopedLockType lock (publishLock);
+        return publishedSources;
+    }
+
+    void addListener (Listener* listenerToAdd) { listeners.add (listenerToAdd); }
+    void removeListener (Listener* listenerToRemove) { listeners.remove (listenerToRemove); }
+
+private:
+    static constexpr int numBufferedUpdates = 4;
+    static constexpr int maxMissedUpdates = 4;
+    static constexpr int maxJacobiSweeps = 12;
+
+    struct Track
+    {
+        Source source;
+        juce::Vector3D<float> direction;
+        int missedUpdates;
+    };
+
+    //==============================================================================
+    void handleAsyncUpdate() override { updateThreadState(); }
+
+    void updateThreadState()
+    {
+        if (getMethod() == Method::off)
+            stopThread (1000);
+        else if (! isThreadRunning())
+        {
+            resetRequested = true;
+            startThread();
+        }
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            const auto startTime = juce::Time::getMillisecondCounter();
+
+            if (resetRequested.exchange (false))
+                resetEstimation();
+
+            const int numNewSamples = readFromFifo();
+
+            if (getMethod() != Method::off && numNewSamples > 0)
+            {
+                updateCovariance (numNewSamples);
+                estimate();
+            }
+
+            const auto elapsed = static_cast<int> (juce::Time::getMillisecondCounter() - startTime);
+            wait (juce::jmax (1, updateInterval - elapsed));
+        }
+    }
+
+    int readFromFifo()
+    {
+        const int nCh = squares[currentOrder + 1];
+        int numRead = 0;
+
+        while (fifo.getNumReady() > 0 && ! threadShouldExit())
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                if (size1 > 0)
+                    chunkBuffer.copyFrom (ch, 0, fifoBuffer, ch, start1, size1);
+                if (size2 > 0)
+                    chunkBuffer.copyFrom (ch, size1, fifoBuffer, ch, start2, size2);
+            }
+
+            fifo.finishedRead (size1 + size2);
+
+            accumulateOuterProducts (size1 + size2, nCh);
+            numRead += size1 + size2;
+        }
+
+        return numRead;
+    }
+
+    /** Adds the (upper triangle of the) sample covariance of the current chunk. */
+    void accumulateOuterProducts (const int numSamples, const int nCh)
+    {
+        for (int i = 0; i < nCh; ++i)
+        {
+            const float* xi = chunkBuffer.getReadPointer (i);
+            for (int j = i; j < nCh; ++j)
+            {
+                const float* xj = chunkBuffer.getReadPointer (j);
+                float sum = 0.0f;
+                for (int n = 0; n < numSamples; ++n)
+                    sum += xi[n] * xj[n];
+                accumulatedCovariance[i * maxNumChannels + j] += sum;
+            }
+        }
+    }
+
+    void updateCovariance (const int numNewSamples)
+    {
+        const int nCh = squares[currentOrder + 1];
+        const double alpha = std::exp (-numNewSamples
+                                     / (sampleRate.load() * timeConstant.load() / 1000));
+        const double oneMinusAlpha = (1.0 - alpha) / numNewSamples;
+
+        for (int i = 0; i < nCh; ++i)
+        {
+            // converting everything to N3D, so all steering vectors are comparable
+            const double ni = useSN3D.load() ? sn3d2n3d[i] : 1.0;
+            for (int j = i; j < nCh; ++j)
+            {
+                const double nj = useSN3D.load() ? sn3d2n3d[j] : 1.0;
+                auto& acc = accumulatedCovariance[i * maxNumChannels + j];
+                const double value = alpha * covariance[i * maxNumChannels + j]
+                                     + oneMinusAlpha * ni * nj * acc;
+                covariance[i * maxNumChannels + j] = value;
+                covariance[j * maxNumChannels + i] = value;
+                acc = 0.0;
+            }
+        }
+    }
+
+    void resetEstimation()
+    {
+        std::fill (covariance.begin(), covariance.end(), 0.0);
+        std::fill (accumulatedCovariance.begin(), accumulatedCovariance.end(), 0.0);
+        tracks.clear();
+        currentOrder = order.load();
+        updateSteeringMatrix();
+    }
+
+    /** Rows are the max-rE weighted N3D steering vectors of the grid directions. */
+    void updateSteeringMatrix()
+    {
+        const int nCh = squares[currentOrder + 1];
+        float weights[maxNumChannels];
+        copyMaxRE (currentOrder, weights);
+
+        for (int point = 0; point < nSamplePoints; ++point)
+        {
+            float* row = steeringMatrix.data() + point * maxNumChannels;
+            SHEval (currentOrder,
+                    hammerAitovSampleX[point],
+                    hammerAitovSampleY[point],
+                    hammerAitovSampleZ[point],
+                    row);
+            juce::FloatVectorOperations::multiply (row, weights, nCh);
+        }
+    }
+
+    //==============================================================================
+    void estimate()
+    {
+        if (order.load() != currentOrder)
+        {
+            resetEstimation();
+            return;
+        }
+
+        const int nCh = squares[currentOrder + 1];
+        juce::Array<Source> peaks;
+
+        switch (getMethod())
+        {
+            case Method::intensityVector:
+                if (nCh >= 4)
+                    peaks = estimateIntensityVector();
+                break;
+            case Method::steeredResponsePower:
+                calculateSteeredResponsePower (nCh);
+                peaks = pickPeaks (nCh, true);
+                break;
+            case Method::music:
+                if (nCh >= 4)
+                {
+                    calculateMusicSpectrum (nCh);
+                    peaks = pickPeaks (nCh, false);
+                }
+                break;
+            case Method::off:
+            default:
+                break;
+        }
+
+        updateTracks (peaks);
+        publish();
+    }
+
+    /** First-order estimate: intensity vector direction and one minus the diffuseness. */
+    juce::Array<Source> estimateIntensityVector()
+    {
+        const auto c = [this] (int i, int j) { return covariance[i * maxNumChannels + j]; };
+
+        // ACN: W, Y, Z, X (N3D)
+        const juce::Vector3D<float> intensity (static_cast<float> (c (0, 3)),
+                                               static_cast<float> (c (0, 1)),
+                                               static_cast<float> (c (0, 2)));
+        const double energy = 0.5 * (c (0, 0) + (c (1, 1) + c (2, 2) + c (3, 3)) / 3.0);
+
+        juce::Array<Source> ret;
+        if (energy < minimumEnergy)
+            return ret;
+
+        const double directness = intensity.length() / std::sqrt (3.0) / energy;
+
+        Source source;
+        source.id = -1;
+        Conversions<float>::cartesianToSpherical (intensity, source.azimuth, source.elevation);
+        source.confidence = juce::jlimit (0.0f, 1.0f, static_cast<float> (directness));
+        ret.add (source);
+        return ret;
+    }
+
+    /** P(d) = b(d)' C b(d) with b(d) being the max-rE beamformer steered to direction d. */
+    void calculateSteeredResponsePower (const int nCh)
+    {
+        double temp[maxNumChannels];
+
+        for (int point = 0; point < nSamplePoints; ++point)
+        {
+            const float* b = steeringMatrix.data() + point * maxNumChannels;
+
+            double power = 0.0;
+            for (int i = 0; i < nCh; ++i)
+            {
+                const double* row = covariance.data() + i * maxNumChannels;
+                double sum = 0.0;
+                for (int j = 0; j < nCh; ++j)
+                    sum += row[j] * b[j];
+                temp[i] = sum;
+            }
+            for (int i = 0; i < nCh; ++i)
+                power += temp[i] * b[i];
+
+            spectrum[point] = static_cast<float> (juce::jmax (0.0, power));
+        }
+    }
+
+    /**
+     MUSIC pseudo-spectrum, stored as its inverse-free form ||Es' y(d)||^2 / ||y(d)||^2, i.e. the
+     share of the (normalized) steering vector which lies in the signal subspace. This has its
+     maxima where the MUSIC spectrum 1 / ||En' y(d)||^2 has its maxima, but stays bounded.
+     */
+    void calculateMusicSpectrum (const int nCh)
+    {
+        std::copy (covariance.begin(), covariance.end(), eigenVectors.begin());
+        decomposeCovariance (nCh);
+
+        const int K = juce::jmin (numSources.load(), nCh - 1);
+
+        double noiseLevel = 0.0;
+        for (int k = K; k < nCh; ++k)
+            noiseLevel += eigenValues[eigenOrder[k]];
+        noiseLevel /= nCh - K;
+
+        double signalLevel = 0.0;
+        for (int k = 0; k < K; ++k)
+            signalLevel += eigenValues[eigenOrder[k]];
+        signalLevel /= K;
+
+        subspaceContrast =
+            signalLevel > minimumEnergy
+                ? static_cast<float> ((signalLevel - noiseLevel) / (signalLevel + noiseLevel))
+                : 0.0f;
+
+        for (int point = 0; point < nSamplePoints; ++point)
+        {
+            const float* b = steeringMatrix.data() + point * maxNumChannels;
+
+            double norm = 0.0;
+            for (int i = 0; i < nCh; ++i)
+                norm += b[i] * b[i];
+
+            double projection = 0.0;
+            for (int k = 0; k < K; ++k)
+            {
+                const int col = eigenOrder[k];
+                double dot = 0.0;
+                for (int i = 0; i < nCh; ++i)
+                    dot += eigenVectors[i * maxNumChannels + col] * b[i];
+                projection += dot * dot;
+            }
+
+            spectrum[point] = norm > 0.0 ? static_cast<float> (projection / norm) : 0.0f;
+        }
+    }
+
+    /**
+     Cyclic Jacobi eigenvalue decomposition of the symmetric matrix in eigenVectors, which will be
+     replaced by the eigenvectors (columns). eigenOrder holds the indices of the eigenvalues in
+     descending order.
+     */
+    void decomposeCovariance (const int nCh)
+    {
+        auto a = [this] (int i, int j) -> double& { return eigenVectors[i * maxNumChannels + j]; };
+
+        jacobiWork.resize (maxNumChannels * maxNumChannels);
+        auto v = [this] (int i, int j) -> double& { return jacobiWork[i * maxNumChannels + j]; };
+
+        for (int i = 0; i < nCh; ++i)
+            for (int j = 0; j < nCh; ++j)
+                v (i, j) = i == j ? 1.0 : 0.0;
+
+        for (int sweep = 0; sweep < maxJacobiSweeps; ++sweep)
+        {
+            double offDiagonal = 0.0;
+            double diagonal = 0.0;
+            for (int i = 0; i < nCh; ++i)
+            {
+                diagonal += a (i, i) * a (i, i);
+                for (int j = i + 1; j < nCh; ++j)
+                    offDiagonal += a (i, j) * a (i, j);
+            }
+
+            if (offDiagonal <= 1e-12 * diagonal || diagonal == 0.0)
+                break;
+
+            for (int p = 0; p < nCh - 1; ++p)
+                for (int q = p + 1; q < nCh; ++q)
+                {
+                    const double apq = a (p, q);
+                    if (std::abs (apq) < 1e-30)
+                        continue;
+
+                    const double theta = (a (q, q) - a (p, p)) / (2.0 * apq);
+                    const double t = (theta >= 0.0 ? 1.0 : -1.0)
+                                     / (std::abs (theta) + std::sqrt (theta * theta + 1.0));
+                    const double c = 1.0 / std::sqrt (t * t + 1.0);
+                    const double s = t * c;
+
+                    for (int k = 0; k < nCh; ++k)
+                    {
+                        const double akp = a (k, p);
+                        const double akq = a (k, q);
+                        a (k, p) = c * akp - s * akq;
+                        a (k, q) = s * akp + c * akq;
+                    }
+                    for (int k = 0; k < nCh; ++k)
+                    {
+                        const double apk = a (p, k);
+                        const double aqk = a (q, k);
+                        a (p, k) = c * apk - s * aqk;
+                        a (q, k) = s * apk + c * aqk;
+                    }
+                    for (int k = 0; k < nCh; ++k)
+                    {
+                        const double vkp = v (k, p);
+                        const double vkq = v (k, q);
+                        v (k, p) = c * vkp - s * vkq;
+                        v (k, q) = s * vkp + c * vkq;
+                    }
+                }
+        }
+
+        for (int i = 0; i < nCh; ++i)
+        {
+            eigenValues[i] = a (i, i);
+            eigenOrder[i] = i;
+        }
+
+        std::sort (eigenOrder.begin(),
+                   eigenOrder.begin() + nCh,
+                   [this] (int lhs, int rhs) { return eigenValues[lhs] > eigenValues[rhs]; });
+
+        std::copy (jacobiWork.begin(), jacobiWork.end(), eigenVectors.begin());
+    }
+
+    /**
+     Greedy peak picking with non-maximum suppression within the main-lobe width of the current
+     order. Each peak is refined by the power-weighted centroid of its neighbourhood.
+     */
+    juce::Array<Source> pickPeaks (const int nCh, const bool useContrastAsConfidence)
+    {
+        juce::Array<Source> ret;
+
+        std::copy (spectrum.begin(), spectrum.end(), sortedSpectrum.begin());
+        auto median = sortedSpectrum.begin() + nSamplePoints / 2;
+        std::nth_element (sortedSpectrum.begin(), median, sortedSpectrum.end());
+        const float medianValue = *median;
+
+        const float maxValue = *std::max_element (spectrum.begin(), spectrum.end());
+        if (maxValue <= (useContrastAsConfidence ? minimumEnergy : 0.0))
+            return ret;
+
+        const float separation = juce::MathConstants<float>::pi / (currentOrder + 1);
+        const float cosSeparation = std::cos (separation);
+        const float cosRefinement = std::cos (0.5f * separation);
+
+        std::array<bool, nSamplePoints> suppressed;
+        suppressed.fill (false);
+
+        const int K = juce::jmin (numSources.load(), nCh - 1);
+        for (int k = 0; k < K; ++k)
+        {
+            int best = -1;
+            float bestValue = 0.0f;
+            for (int i = 0; i < nSamplePoints; ++i)
+                if (! suppressed[i] && spectrum[i] > bestValue)
+                {
+                    best = i;
+                    bestValue = spectrum[i];
+                }
+
+            if (best < 0 || bestValue <= medianValue)
+                break;
+
+            const auto& peakDirection = gridDirections[best];
+            juce::Vector3D<float> centroid (0.0f, 0.0f, 0.0f);
+            for (int i = 0; i < nSamplePoints; ++i)
+            {
+                const float cosAngle = peakDirection * gridDirections[i];
+                if (cosAngle >= cosRefinement)
+                    centroid += gridDirections[i] * (spectrum[i] - medianValue);
+                if (cosAngle >= cosSeparation)
+                    suppressed[i] = true;
+            }
+
+            Source source;
+            source.id = -1;
+            Conversions<float>::cartesianToSpherical (centroid.length() > 0.0f ? centroid
+                                                                                : peakDirection,
+                                                      source.azimuth,
+                                                      source.elevation);
+
+            if (useContrastAsConfidence)
+                source.confidence = (bestValue - medianValue) / (bestValue + medianValue);
+            else
+                source.confidence = bestValue * subspaceContrast;
+
+            source.confidence = juce::jlimit (0.0f, 1.0f, source.confidence);
+            ret.add (source);
+        }
+
+        return ret;
+    }
+
+    //==============================================================================
+    /**
+     Associates the new estimates with the existing tracks (greedy, nearest direction within the
+     main-lobe width). Matched tracks are smoothed, unmatched estimates start new tracks and tracks
+     which haven't been matched for a couple of updates are dropped.
+     */
+    void updateTracks (const juce::Array<Source>& estimates)
+    {
+        const float cosGate = std::cos (juce::MathConstants<float>::pi / (currentOrder + 1));
+        constexpr float smoothing = 0.6f;
+
+        for (auto& track : tracks)
+            ++track.missedUpdates;
+
+        for (const auto& estimate : estimates)
+        {
+            const auto direction =
+                Conversions<float>::sphericalToCartesian (estimate.azimuth, estimate.elevation);
+
+            Track* match = nullptr;
+            float bestCos = cosGate;
+            for (auto& track : tracks)
+            {
+                const float cosAngle = track.direction * direction;
+                if (track.missedUpdates > 0 && cosAngle >= bestCos)
+                {
+                    bestCos = cosAngle;
+                    match = &track;
+                }
+            }
+
+            if (match != nullptr)
+            {
+                match->direction = match->direction * smoothing + direction * (1.0f - smoothing);
+                match->direction = match->direction.normalised();
+                match->source.confidence = smoothing * match->source.confidence
+                                           + (1.0f - smoothing) * estimate.confidence;
+                match->missedUpdates = 0;
+            }
+            else
+            {
+                Track track;
+                track.source = estimate;
+                track.source.id = nextTrackID++;
+                track.direction = direction;
+                track.missedUpdates = 0;
+                tracks.push_back (track);
+            }
+        }
+
+        tracks.erase (std::remove_if (tracks.begin(),
+                                      tracks.end(),
+                                      [] (const Track& t)
+                                      { return t.missedUpdates > maxMissedUpdates; }),
+                      tracks.end());
+
+        for (auto& track : tracks)
+        {
+            if (track.missedUpdates > 0)
+                track.source.confidence *= smoothing;
+
+            Conversions<float>::cartesianToSpherical (track.direction,
+                                                      track.source.azimuth,
+                                                      track.source.elevation);
+        }
+    }
+
+    void publish()
+    {
+        juce::Array<Source> sources;
+        for (const auto& track : tracks)
+            sources.add (track.source);
+
+        std::sort (sources.begin(),
+                   sources.end(),
+                   [] (const Source& lhs, const Source& rhs)
+                   { return lhs.confidence > rhs.confidence; });
+
+        while (sources.size() > numSources.load())
+            sources.removeLast();
+
+        {
+            const juce::SpinLock::ScopedLockType lock (publishLock);
+            publishedSources = sources;
+        }
+
+        listeners.call ([&] (Listener& l) { l.sourcesUpdated (sources); });
+    }
+
+    //==============================================================================
+    static constexpr double minimumEnergy = 1e-12;
+
+    const int updateInterval;
+
+    std::atomic<int> method { static_cast<int> (Method::off) };
+    std::atomic<int> numSources { 1 };
+    std::atomic<int> order { 0 };
+    std::atomic<bool> useSN3D { true };
+    std::atomic<float> timeConstant { 100.0f };
+    std::atomic<bool> resetRequested { true };
+    std::atomic<double> sampleRate { 48000.0 };
+
+    juce::AbstractFifo fifo;
+    juce::AudioBuffer<float> fifoBuffer;
+
+    // tracker thread only
+    juce::AudioBuffer<float> chunkBuffer;
+    int currentOrder = 0;
+    std::vector<double> covariance;
+    std::vector<double> accumulatedCovariance;
+    std::vector<double> eigenVectors;
+    std::vector<double> jacobiWork;
+    std::vector<double> eigenValues;
+    std::array<int, maxNumChannels> eigenOrder;
+    float subspaceContrast = 0.0f;
+    std::vector<float> steeringMatrix;
+    std::vector<float> spectrum;
+    std::vector<float> sortedSpectrum;
+    std::array<juce::Vector3D<float>, nSamplePoints> gridDirections;
+    std::vector<Track> tracks;
+    int nextTrackID = 0;
+
+    juce::SpinLock publishLock;
+    juce::Array<Source> publishedSources;
+    juce::ListenerList<Listener, juce::Array<Listener*, juce::CriticalSection>> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceTracker)
+};
@@ -50,6 +50,8 @@ MatrixMultiplierAudioProcessor::MatrixMultiplierAudioProcessor() :
 
 MatrixMultiplierAudioProcessor::~MatrixMultiplierAudioProcessor()
 {
+    registry->unwatchFile (this);
+    cancelPendingUpdate();
 }
 
 void MatrixMultiplierAudioProcessor::setLastDir (juce::File newLastDir)
@@ -192,10 +194,27 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 
 void MatrixMultiplierAudioProcessor::loadConfiguration (const juce::File& configurationFile)
 {
-    ReferenceCountedMatrix::Ptr tempMatrix = nullptr;
+    if (! configurationFile.exists())
+    {
+        messageForEditor = "File '" + configurationFile.getFullPathName() + "' does not exist!";
+        return;
+    }
+
+    // instances loading the same configuration share one matrix, which is parsed only once
+    const juce::String jsonString = configurationFile.loadFileAsString();
+    juce::Result result = juce::Result::ok();
+    ReferenceCountedMatrix::Ptr tempMatrix = registry->getOrCreate<ReferenceCountedMatrix> (
+        ConfigurationHelper::getContentHash (jsonString),
+        [&]
+        {
+            ReferenceCountedMatrix::Ptr newMatrix = nullptr;
+            result = ConfigurationHelper::parseStringForTransformationMatrix (
+                jsonString,
+                &newMatrix,
+                "File '" + configurationFile.getFullPathName() + "'");
+            return newMatrix;
+        });
 
-    juce::Result result =
-        ConfigurationHelper::parseFileForTransformationMatrix (configurationFile, &tempMatrix);
     if (! result.wasOk())
     {
         messageForEditor = result.getErrorMessage();
@@ -203,6 +222,7 @@ void MatrixMultiplierAudioProcessor::loadConfiguration (const juce::File& config
     }
 
     lastFile = configurationFile;
+    registry->watchFile (lastFile, this);
 
     juce::String output;
     if (tempMatrix != nullptr)
@@ -222,6 +242,19 @@ void MatrixMultiplierAudioProcessor::loadConfiguration (const juce::File& config
     messageChanged = true;
 }
 
+void MatrixMultiplierAudioProcessor::configurationFileChanged (const juce::File& file)
+{
+    // called on the registry's thread, the configuration is reloaded on the message thread
+    juce::ignoreUnused (file);
+    triggerAsyncUpdate();
+}
+
+void MatrixMultiplierAudioProcessor::handleAsyncUpdate()
+{
+    // the watched file is always the last loaded one
+    loadConfiguration (lastFile);
+}
+
 //==============================================================================
 const bool MatrixMultiplierAudioProcessor::processNotYetConsumedOSCMessage (
     const juce::OSCMessage& message)
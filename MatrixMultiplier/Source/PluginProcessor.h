@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/ConfigurationRegistry.h"
 #include "../../resources/MatrixMultiplication.h"
 #include "../JuceLibraryCode/JuceHeader.h"
 
@@ -33,7 +34,9 @@
 
 //==============================================================================
 class MatrixMultiplierAudioProcessor
-    : public AudioProcessorBase<IOTypes::AudioChannels<64>, IOTypes::AudioChannels<64>>
+    : public AudioProcessorBase<IOTypes::AudioChannels<64>, IOTypes::AudioChannels<64>>,
+      private ConfigurationRegistry::FileListener,
+      private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -90,8 +93,12 @@ public:
 
 private:
     //==============================================================================
+    void configurationFileChanged (const juce::File& file) override;
+    void handleAsyncUpdate() override;
+
     MatrixMultiplication matTrans;
     ReferenceCountedMatrix::Ptr currentMatrix { nullptr };
+    juce::SharedResourcePointer<ConfigurationRegistry> registry;
 
     juce::File lastDir;
     juce::File lastFile;
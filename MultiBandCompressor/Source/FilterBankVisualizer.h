@@ -373,6 +373,13 @@ public:
         coeffs.add (coeffs2);
     }
 
+    /** Replaces the filters, the band's magnitude is the product of theirs. */
+    void setCoeffs (
+        const juce::Array<typename juce::dsp::IIR::Coefficients<coeffType>::Ptr>& newCoeffs)
+    {
+        coeffs = newCoeffs;
+    }
+
 private:
     Settings& s;
     juce::Array<typename juce::dsp::IIR::Coefficients<coeffType>::Ptr> coeffs;
@@ -416,10 +423,12 @@ public:
 
     void setOverallGain (const float newGain) { overallGain = newGain; }
 
+    void setNumBands (const int newNumBands) { numBands = newNumBands; }
+
     void updateOverallMagnitude()
     {
         overallMagnitude.fill (overallGain);
-        for (int i = 0; i < (*freqBands).size(); ++i)
+        for (int i = 0; i < juce::jmin (numBands, (*freqBands).size()); ++i)
         {
             juce::FloatVectorOperations::add (overallMagnitude.getRawDataPointer(),
                                               (*freqBands)[i]->getMagnitudeIncludingGains(),
@@ -545,7 +554,7 @@ public:
         // draw crossovers separators and knobs
         float yPos = s.dbToYFloat (0.0f);
         float prevXPos = s.xMin;
-        for (int i = 0; i < crossoverSliders.size(); ++i)
+        for (int i = 0; i < getNumActiveCrossovers(); ++i)
         {
             float xPos =
                 crossoverSliders[i] == nullptr ? s.xMin : s.hzToX (crossoverSliders[i]->getValue());
@@ -582,7 +591,18 @@ public:
         }
     }
 
-    void setNumFreqBands (const int newValue) { numFreqBands = newValue; }
+    /** Shows the first newValue bands and the crossovers between them, the others are hidden. */
+    void setNumFreqBands (const int newValue)
+    {
+        numFreqBands = juce::jlimit (1, freqBands.size(), newValue);
+
+        for (int i = 0; i < freqBands.size(); ++i)
+            freqBands[i]->setVisible (i < numFreqBands);
+
+        overallMagnitude.setNumBands (numFreqBands);
+        activeElem = -1;
+        repaint();
+    }
 
     void mouseDrag (const juce::MouseEvent& event) override
     {
@@ -605,7 +625,7 @@ public:
         int oldActiveElem = activeElem;
         activeElem = -1;
 
-        for (int i = 0; i < crossoverSliders.size(); ++i)
+        for (int i = 0; i < getNumActiveCrossovers(); ++i)
         {
             int x = crossoverSliders[i] == nullptr ? s.hzToX (s.fMin)
                                                    : s.hzToX (crossoverSliders[i]->getValue());
@@ -655,7 +675,7 @@ public:
         else
             soloSet.erase (i);
 
-        for (int i = 0; i < numFreqBands; ++i)
+        for (int i = 0; i < freqBands.size(); ++i)
         {
             juce::Colour colour = freqBandColours[i];
 
@@ -682,6 +702,18 @@ public:
         freqBandColours.set (i, colour);
     }
 
+    void setFrequencyBand (
+        const int i,
+        const juce::Array<typename juce::dsp::IIR::Coefficients<T>::Ptr>& coeffs,
+        juce::Colour colour)
+    {
+        freqBands[i]->setCoeffs (coeffs);
+        freqBands[i]->setColour (colour);
+        freqBands[i]->updateFilterResponse();
+
+        freqBandColours.set (i, colour);
+    }
+
     void addFrequencyBand (typename juce::dsp::IIR::Coefficients<T>::Ptr coeffs1,
                            typename juce::dsp::IIR::Coefficients<T>::Ptr coeffs2,
                            juce::Colour colour)
@@ -720,6 +752,11 @@ public:
     }
 
 private:
+    int getNumActiveCrossovers() const
+    {
+        return juce::jmin (crossoverSliders.size(), numFreqBands - 1);
+    }
+
     Settings s;
 
     FilterBackdrop filterBackdrop;
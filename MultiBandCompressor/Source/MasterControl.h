@@ -126,6 +126,8 @@ public:
         elements.add (&newComponentToControl);
     }
 
+    void removeAllSlaves() { elements.clear(); }
+
     void paint (juce::Graphics& g) override
     {
         g.setColour (juce::Colours::white);
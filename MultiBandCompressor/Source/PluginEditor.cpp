@@ -30,7 +30,13 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     processor (p),
     valueTreeState (vts),
     footer (p.getOSCParameterInterface()),
-    filterBankVisualizer (20.0f, 20000.0f, -15.0f, 20.0f, 5.0f, p.getSampleRate(), numFilterBands)
+    filterBankVisualizer (20.0f,
+                          20000.0f,
+                          -15.0f,
+                          20.0f,
+                          5.0f,
+                          p.getSampleRate(),
+                          maxNumFilterBands)
 {
     // ============== BEGIN: essentials ======================
     // set GUI size and lookAndFeel
@@ -56,12 +62,7 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     tooltips.setMillisecondsBeforeTipAppears (800);
     tooltips.setOpaque (false);
 
-    const juce::Colour colours[numFilterBands] = { juce::Colours::cornflowerblue,
-                                                   juce::Colours::greenyellow,
-                                                   juce::Colours::yellow,
-                                                   juce::Colours::orangered };
-
-    for (int i = 0; i < numFilterBands; ++i)
+    for (int i = 0; i < maxNumFilterBands; ++i)
     {
         // ==== COMPRESSOR VISUALIZATION ====
         compressorVisualizers.add (new CompressorVisualizer (p.getCompressor (i)));
@@ -189,31 +190,9 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     }
 
     // ==== FILTER VISUALIZATION ====
-    juce::dsp::IIR::Coefficients<double>::Ptr coeffs1;
-    juce::dsp::IIR::Coefficients<double>::Ptr coeffs2;
-    for (int i = 0; i < numFilterBands; ++i)
+    // the bands' filters are set in updateNumBands()
+    for (int i = 0; i < maxNumFilterBands; ++i)
     {
-        switch (i)
-        {
-            case (int) MultiBandCompressorAudioProcessor::FrequencyBands::Low:
-                coeffs1 = processor.lowPassLRCoeffs[1];
-                coeffs2 = processor.lowPassLRCoeffs[0];
-                break;
-            case (int) MultiBandCompressorAudioProcessor::FrequencyBands::MidLow:
-                coeffs1 = processor.lowPassLRCoeffs[1];
-                coeffs2 = processor.highPassLRCoeffs[0];
-                break;
-            case (int) MultiBandCompressorAudioProcessor::FrequencyBands::MidHigh:
-                coeffs1 = processor.highPassLRCoeffs[1];
-                coeffs2 = processor.lowPassLRCoeffs[2];
-                break;
-            case (int) MultiBandCompressorAudioProcessor::FrequencyBands::High:
-                coeffs1 = processor.highPassLRCoeffs[1];
-                coeffs2 = processor.highPassLRCoeffs[2];
-                break;
-        }
-
-        filterBankVisualizer.setFrequencyBand (i, coeffs1, coeffs2, colours[i]);
         filterBankVisualizer.setBypassed (i, tbBypass[i].getToggleState());
         filterBankVisualizer.setSolo (i, tbSolo[i].getToggleState());
         filterBankVisualizer.updateMakeUpGain (i, slMakeUpGain[i].getValue());
@@ -229,8 +208,46 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     tbOverallMagnitude.addListener (this);
     addAndMakeVisible (&tbOverallMagnitude);
 
+    // ==== NUMBER OF BANDS ====
+    addAndMakeVisible (&cbNumBands);
+    cbNumBands.setJustificationType (juce::Justification::centred);
+    cbNumBands.addSectionHeading ("Number of bands");
+    for (int i = 2; i <= maxNumFilterBands; ++i)
+        cbNumBands.addItem (juce::String (i) + " bands", i - 1);
+    cbNumBandsAttachment =
+        std::make_unique<ComboBoxAttachment> (valueTreeState, "numBands", cbNumBands);
+    cbNumBands.setTooltip ("Number of frequency bands, the crossovers are Linkwitz-Riley filters.");
+
+    // ==== DETECTOR ====
+    addAndMakeVisible (&cbDetectorOrder);
+    cbDetectorOrder.setJustificationType (juce::Justification::centred);
+    cbDetectorOrder.addSectionHeading ("Detector");
+    cbDetectorOrder.addItem ("W only", 1);
+    cbDetectorOrder.addItem ("up to 1st order", 2);
+    cbDetectorOrder.addItem ("up to 2nd order", 3);
+    cbDetectorOrder.addItem ("up to 3rd order", 4);
+    cbDetectorOrder.addItem ("up to 4th order", 5);
+    cbDetectorOrder.addItem ("up to 5th order", 6);
+    cbDetectorOrder.addItem ("up to 6th order", 7);
+    cbDetectorOrder.addItem ("up to 7th order", 8);
+    cbDetectorOrderAttachment =
+        std::make_unique<ComboBoxAttachment> (valueTreeState, "detectorOrder", cbDetectorOrder);
+    cbDetectorOrder.setTooltip ("Channels used for the linked level detection of all bands.");
+
+    addAndMakeVisible (&slRMSTime);
+    slRMSTimeAttachment = std::make_unique<SliderAttachment> (valueTreeState, "rmsTime", slRMSTime);
+    slRMSTime.setSliderStyle (juce::Slider::LinearHorizontal);
+    slRMSTime.setTextBoxStyle (juce::Slider::TextBoxRight, false, 45, 12);
+    slRMSTime.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClRotSliderArrow);
+    slRMSTime.setTextValueSuffix (" ms");
+    slRMSTime.setTooltip ("RMS time of the detector, zero results in peak detection.");
+
+    addAndMakeVisible (&lbRMSTime);
+    lbRMSTime.setText ("RMS", false, juce::Justification::left);
+    lbRMSTime.setTextColour (globalLaF.ClFace);
+
     // ==== CROSSOVER SLIDERS ====
-    for (int i = 0; i < numFilterBands - 1; ++i)
+    for (int i = 0; i < maxNumFilterBands - 1; ++i)
     {
         slCrossoverAttachment[i] =
             std::make_unique<SliderAttachment> (valueTreeState,
@@ -269,57 +286,46 @@ MultiBandCompressorAudioProcessorEditor::MultiBandCompressorAudioProcessorEditor
     // ==== MASTER CONTROLS ====
     addAndMakeVisible (&slMasterThreshold);
     slMasterThreshold.setName ("MasterThreshold");
-    addAndMakeVisible (&lbThreshold[numFilterBands]);
-    lbThreshold[numFilterBands].setText ("Thresh.");
-    lbThreshold[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbThreshold[maxNumFilterBands]);
+    lbThreshold[maxNumFilterBands].setText ("Thresh.");
+    lbThreshold[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     addAndMakeVisible (&slMasterKnee);
     slMasterKnee.setName ("MasterKnee");
-    addAndMakeVisible (&lbKnee[numFilterBands]);
-    lbKnee[numFilterBands].setText ("Knee");
-    lbKnee[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbKnee[maxNumFilterBands]);
+    lbKnee[maxNumFilterBands].setText ("Knee");
+    lbKnee[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     addAndMakeVisible (&slMasterMakeUpGain);
     slMasterMakeUpGain.setName ("MasterMakeUpGain");
-    addAndMakeVisible (&lbMakeUpGain[numFilterBands]);
-    lbMakeUpGain[numFilterBands].setText ("Gain");
-    lbMakeUpGain[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbMakeUpGain[maxNumFilterBands]);
+    lbMakeUpGain[maxNumFilterBands].setText ("Gain");
+    lbMakeUpGain[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     addAndMakeVisible (&slMasterRatio);
     slMasterRatio.setName ("MasterMakeUpGain");
-    addAndMakeVisible (&lbRatio[numFilterBands]);
-    lbRatio[numFilterBands].setText ("Ratio");
-    lbRatio[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbRatio[maxNumFilterBands]);
+    lbRatio[maxNumFilterBands].setText ("Ratio");
+    lbRatio[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     addAndMakeVisible (&slMasterAttackTime);
     slMasterAttackTime.setName ("MasterAttackTime");
-    addAndMakeVisible (&lbAttack[numFilterBands]);
-    lbAttack[numFilterBands].setText ("Attack");
-    lbAttack[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbAttack[maxNumFilterBands]);
+    lbAttack[maxNumFilterBands].setText ("Attack");
+    lbAttack[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     addAndMakeVisible (&slMasterReleaseTime);
     slMasterReleaseTime.setName ("MasterReleaseTime");
-    addAndMakeVisible (&lbRelease[numFilterBands]);
-    lbRelease[numFilterBands].setText ("Rel.");
-    lbRelease[numFilterBands].setTextColour (globalLaF.ClFace);
+    addAndMakeVisible (&lbRelease[maxNumFilterBands]);
+    lbRelease[maxNumFilterBands].setText ("Rel.");
+    lbRelease[maxNumFilterBands].setTextColour (globalLaF.ClFace);
 
     gcMasterControls.setText ("Master controls");
     addAndMakeVisible (&gcMasterControls);
 
-    // add sliders to master controls
-    for (int i = 0; i < numFilterBands; ++i)
-    {
-        slMasterThreshold.addSlave (slThreshold[i]);
-        slMasterKnee.addSlave (slKnee[i]);
-        slMasterMakeUpGain.addSlave (slMakeUpGain[i]);
-        slMasterRatio.addSlave (slRatio[i]);
-        slMasterAttackTime.addSlave (slAttackTime[i]);
-        slMasterReleaseTime.addSlave (slReleaseTime[i]);
-    }
-
-    /* resized () is called here, because otherwise the compressorVisualizers won't be drawn to the GUI until one manually resizes the window.
+    /* updateNumBands() calls resized (), because otherwise the compressorVisualizers won't be drawn to the GUI until one manually resizes the window.
     It seems resized() somehow gets called *before* the constructor and therefore juce::OwnedArray<CompressorVisualizers> is still empty on the first resized call... */
-    resized();
+    updateNumBands (processor.getNumBands());
 
     // start timer after everything is set up properly
     startTimer (50);
@@ -336,6 +342,72 @@ void MultiBandCompressorAudioProcessorEditor::paint (juce::Graphics& g)
     g.fillAll (globalLaF.ClBackground);
 }
 
+void MultiBandCompressorAudioProcessorEditor::updateNumBands (const int newNumBands)
+{
+    numBands = newNumBands;
+
+    filterBankVisualizer.setNumFreqBands (numBands);
+
+    // master controls only move the sliders of the used bands
+    slMasterThreshold.removeAllSlaves();
+    slMasterKnee.removeAllSlaves();
+    slMasterMakeUpGain.removeAllSlaves();
+    slMasterRatio.removeAllSlaves();
+    slMasterAttackTime.removeAllSlaves();
+    slMasterReleaseTime.removeAllSlaves();
+
+    for (int i = 0; i < maxNumFilterBands; ++i)
+    {
+        const bool isUsed = i < numBands;
+
+        for (juce::Component* component : std::initializer_list<juce::Component*> {
+                 compressorVisualizers[i],
+                 &GRmeter[i],
+                 &slThreshold[i],
+                 &slKnee[i],
+                 &slMakeUpGain[i],
+                 &slRatio[i],
+                 &slAttackTime[i],
+                 &slReleaseTime[i],
+                 &lbThreshold[i],
+                 &lbKnee[i],
+                 &lbMakeUpGain[i],
+                 &lbRatio[i],
+                 &lbAttack[i],
+                 &lbRelease[i],
+                 &tbSolo[i],
+                 &tbBypass[i] })
+            component->setVisible (isUsed);
+
+        if (i < maxNumFilterBands - 1)
+            slCrossover[i].setVisible (i < numBands - 1);
+
+        if (! isUsed)
+            continue;
+
+        slMasterThreshold.addSlave (slThreshold[i]);
+        slMasterKnee.addSlave (slKnee[i]);
+        slMasterMakeUpGain.addSlave (slMakeUpGain[i]);
+        slMasterRatio.addSlave (slRatio[i]);
+        slMasterAttackTime.addSlave (slAttackTime[i]);
+        slMasterReleaseTime.addSlave (slReleaseTime[i]);
+
+        // a band is shaped by the low- and high-passes on its path through the crossover tree,
+        // the all-passes in between don't change its magnitude
+        iem::LinkwitzRileyCrossover::Split path[iem::LinkwitzRileyCrossover::maxDepth];
+        const int numSplits = iem::LinkwitzRileyCrossover::getBandPath (numBands, i, path);
+
+        juce::Array<juce::dsp::IIR::Coefficients<double>::Ptr> coeffs;
+        for (int split = 0; split < numSplits; ++split)
+            coeffs.add (path[split].isHighPass ? processor.highPassLRCoeffs[path[split].crossover]
+                                               : processor.lowPassLRCoeffs[path[split].crossover]);
+
+        filterBankVisualizer.setFrequencyBand (i, coeffs, colours[i]);
+    }
+
+    resized();
+}
+
 void MultiBandCompressorAudioProcessorEditor::resized()
 {
     // ============ BEGIN: header and footer ============
@@ -399,10 +471,10 @@ void MultiBandCompressorAudioProcessorEditor::resized()
     juce::Rectangle<int> crossoverArea;
 
     const int buttonsWidth = crossoverAndButtonArea.getWidth()
-                             / (numFilterBands + (numFilterBands - 1) * crossoverToButtonsRatio);
+                             / (numBands + (numBands - 1) * crossoverToButtonsRatio);
     const int crossoverSliderWidth = buttonsWidth * crossoverToButtonsRatio;
 
-    for (int i = 0; i < numFilterBands; ++i)
+    for (int i = 0; i < numBands; ++i)
     {
         // juce::Buttons
         bypassButtonArea = crossoverAndButtonArea.removeFromLeft (buttonsWidth);
@@ -418,7 +490,7 @@ void MultiBandCompressorAudioProcessorEditor::resized()
                                       bypassButtonArea.proportionOfHeight (trimButtonsHeight)));
 
         // juce::Sliders
-        if (i < numFilterBands - 1)
+        if (i < numBands - 1)
         {
             crossoverArea = crossoverAndButtonArea.removeFromLeft (crossoverSliderWidth);
             slCrossover[i].setBounds (crossoverArea.reduced (crossoverToButtonGap / 2, 0));
@@ -436,14 +508,14 @@ void MultiBandCompressorAudioProcessorEditor::resized()
     const float trimMeterHeightRatio = 0.02f;
 
     compressorArea.reduce (
-        ((compressorArea.getWidth() - (numFilterBands - 1) * bandToBandGap) % numFilterBands) / 2,
+        ((compressorArea.getWidth() - (numBands - 1) * bandToBandGap) % numBands) / 2,
         0);
     const int widthPerBand =
-        ((compressorArea.getWidth() - (numFilterBands - 1) * bandToBandGap) / numFilterBands);
+        ((compressorArea.getWidth() - (numBands - 1) * bandToBandGap) / numBands);
     juce::Rectangle<int> characteristicArea, paramArea, paramRow1, paramRow2, labelRow1, labelRow2,
         grMeterArea;
 
-    for (int i = 0; i < numFilterBands; ++i)
+    for (int i = 0; i < numBands; ++i)
     {
         characteristicArea = compressorArea.removeFromLeft (widthPerBand);
 
@@ -489,7 +561,7 @@ void MultiBandCompressorAudioProcessorEditor::resized()
         if (! (compressorVisualizers.isEmpty()))
             compressorVisualizers[i]->setBounds (characteristicArea);
 
-        if (i < numFilterBands - 1)
+        if (i < numBands - 1)
             compressorArea.removeFromLeft (bandToBandGap);
     }
 
@@ -541,9 +613,9 @@ void MultiBandCompressorAudioProcessorEditor::resized()
     slMasterThreshold.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
     slMasterKnee.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
     slMasterMakeUpGain.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
-    lbThreshold[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
-    lbKnee[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
-    lbMakeUpGain[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbThreshold[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbKnee[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbMakeUpGain[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
 
     sliderRow = masterArea;
     sliderRow.reduce (sliderRow.proportionOfWidth (trimSliderWidth),
@@ -553,19 +625,27 @@ void MultiBandCompressorAudioProcessorEditor::resized()
     slMasterRatio.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
     slMasterAttackTime.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
     slMasterReleaseTime.setBounds (sliderRow.removeFromLeft (masterSliderWidth));
-    lbRatio[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
-    lbAttack[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
-    lbRelease[numFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbRatio[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbAttack[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
+    lbRelease[maxNumFilterBands].setBounds (labelRow.removeFromLeft (masterSliderWidth));
 
-    // ==== FILTERBANKVISUALIZER SETTINGS ====
-    const float trimHeight = 0.4f;
+    // ==== FILTERBANKVISUALIZER SETTINGS AND DETECTOR ====
     const int trimFromLeft = 5;
+    const int rowHeight = 18;
+    const int rowToRowGap = 6;
 
     rightArea.removeFromLeft (trimFromLeft);
-    rightArea.reduce (0, rightArea.proportionOfHeight (trimHeight));
-    juce::Rectangle<int> totalMagnitudeButtonArea =
-        rightArea.removeFromTop (rightArea.proportionOfHeight (0.5));
-    tbOverallMagnitude.setBounds (totalMagnitudeButtonArea);
+    rightArea = rightArea.withSizeKeepingCentre (rightArea.getWidth(),
+                                                 4 * rowHeight + 3 * rowToRowGap);
+    tbOverallMagnitude.setBounds (rightArea.removeFromTop (rowHeight));
+    rightArea.removeFromTop (rowToRowGap);
+    cbNumBands.setBounds (rightArea.removeFromTop (rowHeight));
+    rightArea.removeFromTop (rowToRowGap);
+    cbDetectorOrder.setBounds (rightArea.removeFromTop (rowHeight));
+    rightArea.removeFromTop (rowToRowGap);
+    juce::Rectangle<int> rmsRow = rightArea.removeFromTop (rowHeight);
+    lbRMSTime.setBounds (rmsRow.removeFromLeft (30));
+    slRMSTime.setBounds (rmsRow);
 }
 
 void MultiBandCompressorAudioProcessorEditor::sliderValueChanged (juce::Slider* slider)
@@ -607,6 +687,9 @@ void MultiBandCompressorAudioProcessorEditor::timerCallback()
     title.setMaxSize (processor.getMaxSize());
     // ==========================================
 
+    if (processor.getNumBands() != numBands)
+        updateNumBands (processor.getNumBands());
+
     if (processor.repaintFilterVisualization.get())
     {
         processor.repaintFilterVisualization = false;
@@ -616,7 +699,7 @@ void MultiBandCompressorAudioProcessorEditor::timerCallback()
     omniInputMeter.setLevel (processor.inputPeak.get());
     omniOutputMeter.setLevel (processor.outputPeak.get());
 
-    for (int i = 0; i < numFilterBands; ++i)
+    for (int i = 0; i < numBands; ++i)
     {
         const auto gainReduction = processor.maxGR[i].get();
 
@@ -67,6 +67,9 @@ public:
     void timerCallback() override;
 
 private:
+    // shows the components of the used bands and sets their filters in the visualizer
+    void updateNumBands (const int newNumBands);
+
     // ====================== begin essentials ==================
     // lookAndFeel class with the IEM plug-in suite design
     LaF globalLaF;
@@ -92,23 +95,31 @@ private:
     FilterBankVisualizer<double> filterBankVisualizer;
     juce::TooltipWindow tooltips;
 
+    const juce::Colour colours[maxNumFilterBands] = {
+        juce::Colours::cornflowerblue, juce::Colours::greenyellow, juce::Colours::yellow,
+        juce::Colours::orangered,      juce::Colours::mediumorchid, juce::Colours::turquoise,
+        juce::Colours::sandybrown,     juce::Colours::hotpink
+    };
+    int numBands = 0;
+
     // Filter Crossovers
-    ReverseSlider slCrossover[numFilterBands - 1];
-    std::unique_ptr<SliderAttachment> slCrossoverAttachment[numFilterBands - 1];
+    ReverseSlider slCrossover[maxNumFilterBands - 1];
+    std::unique_ptr<SliderAttachment> slCrossoverAttachment[maxNumFilterBands - 1];
 
     // Solo and Bypass juce::Buttons
-    RoundButton tbSolo[numFilterBands];
-    RoundButton tbBypass[numFilterBands];
+    RoundButton tbSolo[maxNumFilterBands];
+    RoundButton tbBypass[maxNumFilterBands];
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>
-        soloAttachment[numFilterBands], bypassAttachment[numFilterBands];
+        soloAttachment[maxNumFilterBands], bypassAttachment[maxNumFilterBands];
 
     // Compressor Parameters
-    ReverseSlider slKnee[numFilterBands], slThreshold[numFilterBands], slRatio[numFilterBands],
-        slAttackTime[numFilterBands], slReleaseTime[numFilterBands], slMakeUpGain[numFilterBands];
-    std::unique_ptr<SliderAttachment> slKneeAttachment[numFilterBands],
-        slThresholdAttachment[numFilterBands], slRatioAttachment[numFilterBands],
-        slAttackTimeAttachment[numFilterBands], slReleaseTimeAttachment[numFilterBands],
-        slMakeUpGainAttachment[numFilterBands];
+    ReverseSlider slKnee[maxNumFilterBands], slThreshold[maxNumFilterBands],
+        slRatio[maxNumFilterBands], slAttackTime[maxNumFilterBands],
+        slReleaseTime[maxNumFilterBands], slMakeUpGain[maxNumFilterBands];
+    std::unique_ptr<SliderAttachment> slKneeAttachment[maxNumFilterBands],
+        slThresholdAttachment[maxNumFilterBands], slRatioAttachment[maxNumFilterBands],
+        slAttackTimeAttachment[maxNumFilterBands], slReleaseTimeAttachment[maxNumFilterBands],
+        slMakeUpGainAttachment[maxNumFilterBands];
 
     // Master parameters
     juce::GroupComponent gcMasterControls;
@@ -119,16 +130,27 @@ private:
     juce::OwnedArray<CompressorVisualizer> compressorVisualizers;
 
     // Meters
-    LevelMeter GRmeter[numFilterBands], omniInputMeter, omniOutputMeter;
+    LevelMeter GRmeter[maxNumFilterBands], omniInputMeter, omniOutputMeter;
 
     // juce::Toggle juce::Buttons
     juce::ToggleButton tbOverallMagnitude;
     bool displayOverallMagnitude { false };
 
+    // Number of bands
+    juce::ComboBox cbNumBands;
+    std::unique_ptr<ComboBoxAttachment> cbNumBandsAttachment;
+
+    // Detector
+    juce::ComboBox cbDetectorOrder;
+    std::unique_ptr<ComboBoxAttachment> cbDetectorOrderAttachment;
+    ReverseSlider slRMSTime;
+    std::unique_ptr<SliderAttachment> slRMSTimeAttachment;
+
     // juce::Labels
-    SimpleLabel lbKnee[numFilterBands + 1], lbThreshold[numFilterBands + 1],
-        lbMakeUpGain[numFilterBands + 1], lbRatio[numFilterBands + 1], lbAttack[numFilterBands + 1],
-        lbRelease[numFilterBands + 1], lbInput, lbOutput;
+    SimpleLabel lbKnee[maxNumFilterBands + 1], lbThreshold[maxNumFilterBands + 1],
+        lbMakeUpGain[maxNumFilterBands + 1], lbRatio[maxNumFilterBands + 1],
+        lbAttack[maxNumFilterBands + 1], lbRelease[maxNumFilterBands + 1], lbInput, lbOutput,
+        lbRMSTime;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiBandCompressorAudioProcessorEditor)
 };
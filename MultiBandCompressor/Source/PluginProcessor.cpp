@@ -36,14 +36,19 @@ MultiBandCompressorAudioProcessor::MultiBandCompressorAudioProcessor() :
     #endif
             ,
 #endif
-        createParameterLayout()),
-    maxNumFilters (ceil (64 / IIRfloat_elements))
+        createParameterLayout())
 {
     const juce::String inputSettingID = "orderSetting";
     orderSetting = parameters.getRawParameterValue (inputSettingID);
     parameters.addParameterListener (inputSettingID, this);
 
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
+    useSN3D = parameters.getRawParameterValue ("useSN3D");
+    detectorOrder = parameters.getRawParameterValue ("detectorOrder");
+    rmsTime = parameters.getRawParameterValue ("rmsTime");
+    numBandsSetting = parameters.getRawParameterValue ("numBands");
+    parameters.addParameterListener ("numBands", this);
+
+    for (int filterBandIdx = 0; filterBandIdx < maxNumFilterBands - 1; ++filterBandIdx)
     {
         const juce::String crossoverID ("crossover" + juce::String (filterBandIdx));
 
@@ -56,40 +61,14 @@ MultiBandCompressorAudioProcessor::MultiBandCompressorAudioProcessor() :
 
         calculateCoefficients (filterBandIdx);
 
-        iirLPCoefficients[filterBandIdx] =
-            IIR::Coefficients<float>::makeLowPass (lastSampleRate, *crossovers[filterBandIdx]);
-        iirHPCoefficients[filterBandIdx] =
-            IIR::Coefficients<float>::makeHighPass (lastSampleRate, *crossovers[filterBandIdx]);
-        iirAPCoefficients[filterBandIdx] =
-            IIR::Coefficients<float>::makeAllPass (lastSampleRate, *crossovers[filterBandIdx]);
-
         parameters.addParameterListener (crossoverID, this);
-
-        iirLP[filterBandIdx].clear();
-        iirLP2[filterBandIdx].clear();
-        iirHP[filterBandIdx].clear();
-        iirHP2[filterBandIdx].clear();
-        iirAP[filterBandIdx].clear();
-
-        for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-        {
-            iirLP[filterBandIdx].add (new IIR::Filter<IIRfloat> (iirLPCoefficients[filterBandIdx]));
-            iirLP2[filterBandIdx].add (
-                new IIR::Filter<IIRfloat> (iirLPCoefficients[filterBandIdx]));
-            iirHP[filterBandIdx].add (new IIR::Filter<IIRfloat> (iirHPCoefficients[filterBandIdx]));
-            iirHP2[filterBandIdx].add (
-                new IIR::Filter<IIRfloat> (iirHPCoefficients[filterBandIdx]));
-            iirAP[filterBandIdx].add (new IIR::Filter<IIRfloat> (iirAPCoefficients[filterBandIdx]));
-        }
     }
 
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
-    {
-        for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-        {
-            freqBandsBlocks[filterBandIdx].push_back (juce::HeapBlock<char>());
-        }
+    crossover.prepare (64, getNumBands());
+    crossover.setCoefficientRamping (true); // crossover changes get interpolated across the block
 
+    for (int filterBandIdx = 0; filterBandIdx < maxNumFilterBands; ++filterBandIdx)
+    {
         const juce::String thresholdID ("threshold" + juce::String (filterBandIdx));
         const juce::String kneeID ("knee" + juce::String (filterBandIdx));
         const juce::String attackID ("attack" + juce::String (filterBandIdx));
@@ -120,11 +99,6 @@ MultiBandCompressorAudioProcessor::MultiBandCompressorAudioProcessor() :
     soloArray.clear();
 
     copyCoeffsToProcessor();
-
-    for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-    {
-        interleavedBlockData.push_back (juce::HeapBlock<char>());
-    }
 }
 
 MultiBandCompressorAudioProcessor::~MultiBandCompressorAudioProcessor()
@@ -135,7 +109,8 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
     MultiBandCompressorAudioProcessor::createParameterLayout()
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
-    const float crossoverPresets[numFilterBands - 1] = { 80.0f, 440.0f, 2200.0f };
+    const float crossoverPresets[maxNumFilterBands - 1] = { 80.0f,   440.0f,   2200.0f, 5000.0f,
+                                                            8000.0f, 12000.0f, 16000.0f };
 
     auto floatParam = std::make_unique<juce::AudioParameterFloat> (
         "orderSetting",
@@ -185,8 +160,56 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         nullptr);
     params.push_back (std::move (floatParam));
 
+    floatParam = std::make_unique<juce::AudioParameterFloat> (
+        "detectorOrder",
+        "Detector Order",
+        juce::NormalisableRange<float> (0.0f, 7.0f, 1.0f),
+        0.0f,
+        "",
+        juce::AudioProcessorParameter::genericParameter,
+        [] (float value, int maximumStringLength)
+        {
+            const char* orders[] = { "W only", "1st", "2nd", "3rd", "4th", "5th", "6th", "7th" };
+            const int order = juce::jlimit (0, 7, juce::roundToInt (value));
+            if (order == 0)
+                return juce::String (orders[0]);
+            return "up to " + juce::String (orders[order]) + " order";
+        },
+        nullptr);
+    params.push_back (std::move (floatParam));
+
+    floatParam = std::make_unique<juce::AudioParameterFloat> (
+        "rmsTime",
+        "RMS Time",
+        juce::NormalisableRange<float> (0.0f, 50.0f, 0.1f),
+        0.0f,
+        "ms",
+        juce::AudioProcessorParameter::genericParameter,
+        [] (float value, int maximumStringLength)
+        {
+            if (value < 0.05f)
+                return juce::String ("Peak");
+            return juce::String (value, 1);
+        },
+        std::function<float (const juce::String& text)> ([] (const juce::String& t)
+                                                         { return t.getFloatValue(); }));
+    params.push_back (std::move (floatParam));
+
+    // changes the band layout, therefore not automatable
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "numBands",
+        "Number of Bands",
+        "",
+        juce::NormalisableRange<float> (2.0f, maxNumFilterBands, 1.0f),
+        4.0f,
+        [] (float value) { return juce::String (juce::roundToInt (value)) + " bands"; },
+        nullptr,
+        false,
+        false,
+        true));
+
     // Crossovers
-    for (int i = 0; i < numFilterBands - 1; ++i)
+    for (int i = 0; i < maxNumFilterBands - 1; ++i)
     {
         floatParam = std::make_unique<juce::AudioParameterFloat> (
             "crossover" + juce::String (i),
@@ -202,7 +225,7 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         params.push_back (std::move (floatParam));
     }
 
-    for (int i = 0; i < numFilterBands; ++i)
+    for (int i = 0; i < maxNumFilterBands; ++i)
     {
         // compressor threshold
         floatParam = std::make_unique<juce::AudioParameterFloat> (
@@ -308,56 +331,35 @@ void MultiBandCompressorAudioProcessor::calculateCoefficients (const int i)
 {
     jassert (lastSampleRate > 0.0);
 
-    const float crossoverFrequency =
-        juce::jmin (static_cast<float> (0.5 * lastSampleRate), crossovers[i]->load());
-
-    double b0, b1, b2, a0, a1, a2;
-    double K = std::tan (juce::MathConstants<double>::pi * (crossoverFrequency) / lastSampleRate);
-    double den = 1 + juce::MathConstants<double>::sqrt2 * K + pow (K, double (2.0));
+    const double crossoverFrequency =
+        juce::jmin (0.49 * lastSampleRate, static_cast<double> (crossovers[i]->load()));
 
-    // calculate coeffs for 2nd order Butterworth
-    a0 = 1.0;
-    a1 = (2 * (pow (K, 2.0) - 1)) / den;
-    a2 = (1 - juce::MathConstants<double>::sqrt2 * K + pow (K, 2.0)) / den;
-
-    // HP
-    b0 = 1.0 / den;
-    b1 = -2.0 * b0;
-    b2 = b0;
-    iirTempHPCoefficients[i] = new IIR::Coefficients<float> (b0, b1, b2, a0, a1, a2);
+    crossoverCoefficients[i] =
+        iem::LinkwitzRileyCrossover::makeCrossover (lastSampleRate, crossoverFrequency);
 
     // also calculate 4th order Linkwitz-Riley for GUI
-    IIR::Coefficients<double>::Ptr coeffs (new IIR::Coefficients<double> (b0, b1, b2, a0, a1, a2));
-    coeffs->coefficients =
-        FilterVisualizerHelper<double>::cascadeSecondOrderCoefficients (coeffs->coefficients,
-                                                                        coeffs->coefficients);
-    *highPassLRCoeffs[i] = *coeffs;
-
-    // LP
-    b0 = pow (K, 2.0) / den;
-    b1 = 2.0 * b0;
-    b2 = b0;
-    iirTempLPCoefficients[i] = new IIR::Coefficients<float> (b0, b1, b2, a0, a1, a2);
-
-    coeffs.reset();
-    coeffs = (new IIR::Coefficients<double> (b0, b1, b2, a0, a1, a2));
-    coeffs->coefficients =
-        FilterVisualizerHelper<double>::cascadeSecondOrderCoefficients (coeffs->coefficients,
-                                                                        coeffs->coefficients);
-    *lowPassLRCoeffs[i] = *coeffs;
-
-    // Allpass equivalent to 4th order Linkwitz-Riley crossover
-    iirTempAPCoefficients[i] = new IIR::Coefficients<float> (a2, a1, a0, a0, a1, a2);
+    const auto setLinkwitzRiley = [] (IIR::Coefficients<double>& lr,
+                                      const iem::LinkwitzRileyCrossover::Coefficients& section)
+    {
+        IIR::Coefficients<double> butterworth (section.b0,
+                                               section.b1,
+                                               section.b2,
+                                               1.0,
+                                               section.a1,
+                                               section.a2);
+        lr.coefficients = FilterVisualizerHelper<double>::cascadeSecondOrderCoefficients (
+            butterworth.coefficients,
+            butterworth.coefficients);
+    };
+
+    setLinkwitzRiley (*highPassLRCoeffs[i], crossoverCoefficients[i].highPass);
+    setLinkwitzRiley (*lowPassLRCoeffs[i], crossoverCoefficients[i].lowPass);
 }
 
 void MultiBandCompressorAudioProcessor::copyCoeffsToProcessor()
 {
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
-    {
-        *iirLPCoefficients[filterBandIdx] = *iirTempLPCoefficients[filterBandIdx]; // LP
-        *iirHPCoefficients[filterBandIdx] = *iirTempHPCoefficients[filterBandIdx]; // HP
-        *iirAPCoefficients[filterBandIdx] = *iirTempAPCoefficients[filterBandIdx]; // AP
-    }
+    for (int i = 0; i < maxNumFilterBands - 1; ++i)
+        crossover.setCrossover (i, crossoverCoefficients[i]);
 
     userChangedFilterSettings = false;
 }
@@ -402,43 +404,19 @@ void MultiBandCompressorAudioProcessor::prepareToPlay (double sampleRate, int sa
     inputPeak = juce::Decibels::gainToDecibels (-INFINITY);
     outputPeak = juce::Decibels::gainToDecibels (-INFINITY);
 
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
+    for (int filterBandIdx = 0; filterBandIdx < maxNumFilterBands - 1; ++filterBandIdx)
     {
         calculateCoefficients (filterBandIdx);
     }
 
     copyCoeffsToProcessor();
 
-    interleavedData.clear();
-    for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-    {
-        interleavedData.add (
-            new juce::dsp::AudioBlock<IIRfloat> (interleavedBlockData[simdFilterIdx],
-                                                 1,
-                                                 samplesPerBlock));
-        clear (*interleavedData.getLast());
-    }
-
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands - 1; ++filterBandIdx)
-    {
-        for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-        {
-            iirLP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
-            iirLP2[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
-            iirHP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
-            iirHP2[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
-            iirAP[filterBandIdx][simdFilterIdx]->reset (IIRfloat (0.0f));
-            iirLP[filterBandIdx][simdFilterIdx]->prepare (monoSpec);
-            iirLP2[filterBandIdx][simdFilterIdx]->prepare (monoSpec);
-            iirHP[filterBandIdx][simdFilterIdx]->prepare (monoSpec);
-            iirHP2[filterBandIdx][simdFilterIdx]->prepare (monoSpec);
-            iirAP[filterBandIdx][simdFilterIdx]->prepare (monoSpec);
-        }
-    }
+    crossover.reset();
 
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
+    for (int filterBandIdx = 0; filterBandIdx < maxNumFilterBands; ++filterBandIdx)
     {
         compressors[filterBandIdx].prepare (monoSpec);
+        detectors[filterBandIdx].prepare (monoSpec);
         compressors[filterBandIdx].setThreshold (*threshold[filterBandIdx]);
         compressors[filterBandIdx].setKnee (*knee[filterBandIdx]);
         compressors[filterBandIdx].setAttackTime (*attack[filterBandIdx] * 0.001f);
@@ -447,24 +425,12 @@ void MultiBandCompressorAudioProcessor::prepareToPlay (double sampleRate, int sa
             *ratio[filterBandIdx] > 15.9f ? INFINITY : ratio[filterBandIdx]->load());
         compressors[filterBandIdx].setMakeUpGain (*makeUpGain[filterBandIdx]);
 
-        freqBands[filterBandIdx].clear();
-        for (int simdFilterIdx = 0; simdFilterIdx < maxNumFilters; ++simdFilterIdx)
-        {
-            freqBands[filterBandIdx].add (
-                new juce::dsp::AudioBlock<IIRfloat> (freqBandsBlocks[filterBandIdx][simdFilterIdx],
-                                                     1,
-                                                     samplesPerBlock));
-        }
+        freqBands[filterBandIdx].setSize (64, samplesPerBlock, false, true);
     }
 
-    zero = juce::dsp::AudioBlock<float> (zeroData, IIRfloat_elements, samplesPerBlock);
-    zero.clear();
-
     gains = juce::dsp::AudioBlock<float> (gainData, 1, samplesPerBlock);
     gains.clear();
 
-    tempBuffer.setSize (64, samplesPerBlock, false, true);
-
     repaintFilterVisualization = true;
 }
 
@@ -492,142 +458,48 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
         return;
 
     const int L = buffer.getNumSamples();
-    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
     gainChannelPointer = gains.getChannelPointer (0);
 
     gains.clear();
-    zero.clear();
 
     // update iir filter coefficients
     if (userChangedFilterSettings.get())
         copyCoeffsToProcessor();
 
-    inputPeak = juce::Decibels::gainToDecibels (buffer.getMagnitude (0, 0, L));
-
-    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    const int numBands = getNumBands();
+    crossover.setNumBands (numBands);
 
-    //interleave input data
-    int partial = maxNChIn % IIRfloat_elements;
-    if (partial == 0)
+    for (auto& detector : detectors)
     {
-        for (int simdFilterIdx = 0; simdFilterIdx < nSIMDFilters; ++simdFilterIdx)
-        {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> {
-                    buffer.getArrayOfReadPointers() + simdFilterIdx * IIRfloat_elements,
-                    IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (
-                        interleavedData[simdFilterIdx]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
-        }
+        detector.setOrder (static_cast<int> (*detectorOrder));
+        detector.setNormalization (*useSN3D >= 0.5f);
+        detector.setRMSTime (*rmsTime * 0.001f);
     }
-    else
-    {
-        int simdFilterIdx;
-        for (simdFilterIdx = 0; simdFilterIdx < nSIMDFilters - 1; ++simdFilterIdx)
-        {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> {
-                    buffer.getArrayOfReadPointers() + simdFilterIdx * IIRfloat_elements,
-                    IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (
-                        interleavedData[simdFilterIdx]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
-        }
 
-        const float* addr[IIRfloat_elements];
-        int iirElementIdx;
-        for (iirElementIdx = 0; iirElementIdx < partial; ++iirElementIdx)
-        {
-            addr[iirElementIdx] =
-                buffer.getReadPointer (simdFilterIdx * IIRfloat_elements + iirElementIdx);
-        }
-        for (; iirElementIdx < IIRfloat_elements; ++iirElementIdx)
-        {
-            addr[iirElementIdx] = zero.getChannelPointer (iirElementIdx);
-        }
-        juce::AudioData::interleaveSamples (
-            juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
-            juce::AudioData::InterleavedDest<Format> {
-                reinterpret_cast<float*> (interleavedData[simdFilterIdx]->getChannelPointer (0)),
-                IIRfloat_elements },
-            L);
-    }
+    inputPeak = juce::Decibels::gainToDecibels (buffer.getMagnitude (0, 0, L));
 
-    //  filter block diagram
-    //                                | ---> HP3 ---> |
-    //        | ---> HP2 ---> AP1 --->|               + ---> |
-    //        |                       | ---> LP3 ---> |      |
-    //     -->|                                              + --->
-    //        |                       | ---> HP1 ---> |      |
-    //        | ---> LP2 ---> AP3 --->|               + ---> |
-    //                                | ---> LP1 ---> |
-    for (int simdFilterIdx = 0; simdFilterIdx < nSIMDFilters; ++simdFilterIdx)
-    {
-        const IIRfloat* chPtrinterleavedData[1] = {
-            interleavedData[simdFilterIdx]->getChannelPointer (0)
-        };
-        juce::dsp::AudioBlock<IIRfloat> abInterleaved (
-            const_cast<IIRfloat**> (chPtrinterleavedData),
-            1,
-            L);
-
-        const IIRfloat* chPtrLow[1] = {
-            freqBands[FrequencyBands::Low][simdFilterIdx]->getChannelPointer (0)
-        };
-        juce::dsp::AudioBlock<IIRfloat> abLow (const_cast<IIRfloat**> (chPtrLow), 1, L);
-
-        const IIRfloat* chPtrMidLow[1] = {
-            freqBands[FrequencyBands::MidLow][simdFilterIdx]->getChannelPointer (0)
-        };
-        juce::dsp::AudioBlock<IIRfloat> abMidLow (const_cast<IIRfloat**> (chPtrMidLow), 1, L);
-
-        const IIRfloat* chPtrMidHigh[1] = {
-            freqBands[FrequencyBands::MidHigh][simdFilterIdx]->getChannelPointer (0)
-        };
-        juce::dsp::AudioBlock<IIRfloat> abMidHigh (const_cast<IIRfloat**> (chPtrMidHigh), 1, L);
-
-        const IIRfloat* chPtrHigh[1] = {
-            freqBands[FrequencyBands::High][simdFilterIdx]->getChannelPointer (0)
-        };
-        juce::dsp::AudioBlock<IIRfloat> abHigh (const_cast<IIRfloat**> (chPtrHigh), 1, L);
-
-        iirLP[1][simdFilterIdx]->process (
-            juce::dsp::ProcessContextNonReplacing<IIRfloat> (abInterleaved, abLow));
-        iirHP[1][simdFilterIdx]->process (
-            juce::dsp::ProcessContextNonReplacing<IIRfloat> (abInterleaved, abHigh));
-
-        iirLP2[1][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abLow));
-        iirHP2[1][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
-
-        iirAP[2][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abLow));
-        iirAP[0][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
-
-        iirHP[0][simdFilterIdx]->process (
-            juce::dsp::ProcessContextNonReplacing<IIRfloat> (abLow, abMidLow));
-        iirHP2[0][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abMidLow));
-
-        iirLP[0][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abLow));
-        iirLP2[0][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abLow));
-
-        iirLP[2][simdFilterIdx]->process (
-            juce::dsp::ProcessContextNonReplacing<IIRfloat> (abHigh, abMidHigh));
-        iirLP2[2][simdFilterIdx]->process (
-            juce::dsp::ProcessContextReplacing<IIRfloat> (abMidHigh));
-
-        iirHP[2][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
-        iirHP2[2][simdFilterIdx]->process (juce::dsp::ProcessContextReplacing<IIRfloat> (abHigh));
-    }
+    // the bands are split off with a balanced tree of crossovers, see LinkwitzRileyCrossover
+    float* const* bandPointers[maxNumFilterBands];
+    for (int filterBandIdx = 0; filterBandIdx < maxNumFilterBands; ++filterBandIdx)
+        bandPointers[filterBandIdx] = freqBands[filterBandIdx].getArrayOfWritePointers();
+
+    crossover.process (buffer.getArrayOfReadPointers(), bandPointers, maxNChIn, L);
 
     buffer.clear();
 
-    for (int filterBandIdx = 0; filterBandIdx < numFilterBands; ++filterBandIdx)
+    // soloed bands which aren't used don't count
+    const int firstSoloedBand = soloArray.findNextSetBit (0);
+    const bool isAnyBandSoloed = firstSoloedBand >= 0 && firstSoloedBand < numBands;
+
+    for (int filterBandIdx = numBands; filterBandIdx < maxNumFilterBands; ++filterBandIdx)
     {
-        if (! soloArray.isZero())
+        maxGR[filterBandIdx] = 0.0f;
+        maxPeak[filterBandIdx] = juce::Decibels::gainToDecibels (-INFINITY);
+    }
+
+    for (int filterBandIdx = 0; filterBandIdx < numBands; ++filterBandIdx)
+    {
+        if (isAnyBandSoloed)
         {
             if (! soloArray[filterBandIdx])
             {
@@ -637,65 +509,17 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
             }
         }
 
-        tempBuffer.clear();
-
-        // Deinterleave
-        if (partial == 0)
-        {
-            for (int simdFilterIdx = 0; simdFilterIdx < nSIMDFilters; ++simdFilterIdx)
-            {
-                juce::AudioData::deinterleaveSamples (
-                    juce::AudioData::InterleavedSource<Format> {
-                        reinterpret_cast<float*> (
-                            freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
-                        IIRfloat_elements },
-                    juce::AudioData::NonInterleavedDest<Format> {
-                        tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
-                        IIRfloat_elements },
-                    L);
-            }
-        }
-        else
-        {
-            int simdFilterIdx;
-            for (simdFilterIdx = 0; simdFilterIdx < nSIMDFilters - 1; ++simdFilterIdx)
-            {
-                juce::AudioData::deinterleaveSamples (
-                    juce::AudioData::InterleavedSource<Format> {
-                        reinterpret_cast<float*> (
-                            freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
-                        IIRfloat_elements },
-                    juce::AudioData::NonInterleavedDest<Format> {
-                        tempBuffer.getArrayOfWritePointers() + simdFilterIdx * IIRfloat_elements,
-                        IIRfloat_elements },
-                    L);
-            }
-
-            float* addr[IIRfloat_elements];
-            int iirElementIdx;
-            for (iirElementIdx = 0; iirElementIdx < partial; ++iirElementIdx)
-            {
-                addr[iirElementIdx] =
-                    tempBuffer.getWritePointer (simdFilterIdx * IIRfloat_elements + iirElementIdx);
-            }
-            for (; iirElementIdx < IIRfloat_elements; ++iirElementIdx)
-            {
-                addr[iirElementIdx] = zero.getChannelPointer (iirElementIdx);
-            }
-            juce::AudioData::deinterleaveSamples (
-                juce::AudioData::InterleavedSource<Format> {
-                    reinterpret_cast<float*> (
-                        freqBands[filterBandIdx][simdFilterIdx]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                juce::AudioData::NonInterleavedDest<Format> { addr, IIRfloat_elements },
-                L);
-            zero.clear();
-        }
+        const auto& bandBuffer = freqBands[filterBandIdx];
 
         // Compress
         if (*bypass[filterBandIdx] < 0.5f)
         {
-            compressors[filterBandIdx].getGainFromSidechainSignal (tempBuffer.getReadPointer (0),
+            // linked level of the band, the gains are calculated in place
+            detectors[filterBandIdx].process (bandBuffer.getArrayOfReadPointers(),
+                                              maxNChIn,
+                                              gainChannelPointer,
+                                              L);
+            compressors[filterBandIdx].getGainFromSidechainSignal (gainChannelPointer,
                                                                    gainChannelPointer,
                                                                    L);
             maxGR[filterBandIdx] =
@@ -707,7 +531,7 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
             for (int ch = 0; ch < maxNChIn; ++ch)
             {
                 juce::FloatVectorOperations::addWithMultiply (buffer.getWritePointer (ch),
-                                                              tempBuffer.getReadPointer (ch),
+                                                              bandBuffer.getReadPointer (ch),
                                                               gainChannelPointer,
                                                               L);
             }
@@ -717,7 +541,7 @@ void MultiBandCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& b
             for (int ch = 0; ch < maxNChIn; ++ch)
             {
                 juce::FloatVectorOperations::add (buffer.getWritePointer (ch),
-                                                  tempBuffer.getReadPointer (ch),
+                                                  bandBuffer.getReadPointer (ch),
                                                   L);
             }
             maxGR[filterBandIdx] = 0.0f;
@@ -777,7 +601,11 @@ void MultiBandCompressorAudioProcessor::parameterChanged (const juce::String& pa
 {
     DBG ("Parameter with ID " << parameterID << " has changed. New value: " << newValue);
 
-    if (parameterID.startsWith ("crossover"))
+    if (parameterID == "numBands")
+    {
+        repaintFilterVisualization = true;
+    }
+    else if (parameterID.startsWith ("crossover"))
     {
         calculateCoefficients (parameterID.getLastCharacters (1).getIntValue());
         userChangedFilterSettings = true;
@@ -847,12 +675,3 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
     return new MultiBandCompressorAudioProcessor();
 }
 
-inline void MultiBandCompressorAudioProcessor::clear (juce::dsp::AudioBlock<IIRfloat>& ab)
-{
-    const int N = static_cast<int> (ab.getNumSamples()) * IIRfloat_elements;
-    const int nCh = static_cast<int> (ab.getNumChannels());
-
-    for (int ch = 0; ch < nCh; ++ch)
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (ab.getChannelPointer (ch)),
-                                            N);
-}
@@ -27,9 +27,12 @@
 
 #include "../../resources/Compressor.h"
 #include "../../resources/FilterVisualizerHelper.h"
+#include "../../resources/LinkwitzRileyCrossover.h"
+#include "../../resources/LinkedDetector.h"
 
 #define ProcessorClass MultiBandCompressorAudioProcessor
-#define numFilterBands 4
+// the number of bands can be chosen from 2 to 8, the parameters exist for all of them
+#define maxNumFilterBands 8
 
 using namespace juce::dsp;
 using ParameterLayout = juce::AudioProcessorValueTreeState::ParameterLayout;
@@ -76,14 +79,6 @@ public:
     //======= Parameters ===========================================================
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> createParameterLayout();
 
-#if JUCE_USE_SIMD
-    using IIRfloat = SIMDRegister<float>;
-    static constexpr int IIRfloat_elements = SIMDRegister<float>::size();
-#else /* !JUCE_USE_SIMD */
-    using IIRfloat = float;
-    static constexpr int IIRfloat_elements = 1;
-#endif
-
     enum FrequencyBands
     {
         Low,
@@ -94,15 +89,19 @@ public:
 
     // Interface for gui
     double& getSampleRate() { return lastSampleRate; };
-    IIR::Coefficients<double>::Ptr lowPassLRCoeffs[numFilterBands - 1];
-    IIR::Coefficients<double>::Ptr highPassLRCoeffs[numFilterBands - 1];
+    int getNumBands() const
+    {
+        return juce::jlimit (2, maxNumFilterBands, juce::roundToInt (numBandsSetting->load()));
+    }
+    IIR::Coefficients<double>::Ptr lowPassLRCoeffs[maxNumFilterBands - 1];
+    IIR::Coefficients<double>::Ptr highPassLRCoeffs[maxNumFilterBands - 1];
 
     juce::Atomic<bool> repaintFilterVisualization = false;
     juce::Atomic<float> inputPeak = juce::Decibels::gainToDecibels (-INFINITY),
                         outputPeak = juce::Decibels::gainToDecibels (-INFINITY);
-    juce::Atomic<float> maxGR[numFilterBands], maxPeak[numFilterBands];
+    juce::Atomic<float> maxGR[maxNumFilterBands], maxPeak[maxNumFilterBands];
 
-    juce::Atomic<bool> characteristicHasChanged[numFilterBands];
+    juce::Atomic<bool> characteristicHasChanged[maxNumFilterBands];
 
     iem::Compressor* getCompressor (const int i) { return &compressors[i]; };
 
@@ -110,46 +109,37 @@ private:
     void calculateCoefficients (const int index);
     void copyCoeffsToProcessor();
 
-    inline void clear (juce::dsp::AudioBlock<IIRfloat>& ab);
-
     double lastSampleRate { 48000 };
-    const int maxNumFilters;
 
     // list of used audio parameters
     std::atomic<float>* orderSetting;
-    std::atomic<float>* crossovers[numFilterBands - 1];
-    std::atomic<float>* threshold[numFilterBands];
-    std::atomic<float>* knee[numFilterBands];
-    std::atomic<float>* makeUpGain[numFilterBands];
-    std::atomic<float>* ratio[numFilterBands];
-    std::atomic<float>* attack[numFilterBands];
-    std::atomic<float>* release[numFilterBands];
-    std::atomic<float>* bypass[numFilterBands];
+    std::atomic<float>* useSN3D;
+    std::atomic<float>* detectorOrder;
+    std::atomic<float>* rmsTime;
+    std::atomic<float>* numBandsSetting;
+    std::atomic<float>* crossovers[maxNumFilterBands - 1];
+    std::atomic<float>* threshold[maxNumFilterBands];
+    std::atomic<float>* knee[maxNumFilterBands];
+    std::atomic<float>* makeUpGain[maxNumFilterBands];
+    std::atomic<float>* ratio[maxNumFilterBands];
+    std::atomic<float>* attack[maxNumFilterBands];
+    std::atomic<float>* release[maxNumFilterBands];
+    std::atomic<float>* bypass[maxNumFilterBands];
 
     juce::BigInteger soloArray;
 
-    iem::Compressor compressors[numFilterBands];
+    iem::Compressor compressors[maxNumFilterBands];
+    iem::LinkedDetector detectors[maxNumFilterBands];
 
     // filter coefficients
-    juce::dsp::IIR::Coefficients<float>::Ptr iirLPCoefficients[numFilterBands - 1],
-        iirHPCoefficients[numFilterBands - 1], iirAPCoefficients[numFilterBands - 1],
-        iirTempLPCoefficients[numFilterBands - 1], iirTempHPCoefficients[numFilterBands - 1],
-        iirTempAPCoefficients[numFilterBands - 1];
-
-    // filters (cascaded butterworth/linkwitz-riley filters + allpass)
-    juce::OwnedArray<IIR::Filter<IIRfloat>> iirLP[numFilterBands - 1], iirHP[numFilterBands - 1],
-        iirLP2[numFilterBands - 1], iirHP2[numFilterBands - 1], iirAP[numFilterBands - 1];
-
-    // data for interleaving audio
-    juce::HeapBlock<char> zeroData;
-    std::vector<juce::HeapBlock<char>> interleavedBlockData;
-    juce::OwnedArray<juce::dsp::AudioBlock<IIRfloat>> interleavedData;
-    juce::dsp::AudioBlock<float> zero;
-    juce::AudioBuffer<float> tempBuffer;
-
-    // filters for processing
-    juce::OwnedArray<juce::dsp::AudioBlock<IIRfloat>> freqBands[numFilterBands];
-    std::vector<juce::HeapBlock<char>> freqBandsBlocks[numFilterBands];
+    iem::LinkwitzRileyCrossover::Crossover crossoverCoefficients[maxNumFilterBands - 1];
+
+    // Linkwitz-Riley crossovers, writing all bands into the planar band buffers in one pass; it
+    // has states for all bands, changing their number doesn't allocate
+    iem::LinkwitzRileyCrossover crossover;
+
+    // band signals
+    juce::AudioBuffer<float> freqBands[maxNumFilterBands];
 
     // Additional compressor parameters
     float* gainChannelPointer;
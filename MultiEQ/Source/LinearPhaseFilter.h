@@ -0,0 +1,346 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+ Linear-phase filter for all channels: a symmetric FIR is synthesized from a magnitude response on
+ a background thread and applied with a uniformly partitioned overlap-save convolution.
+ All channels share the kernel spectra, each kernel partition is applied to all channels before
+ moving on to the next one.
+ The FIR length scales with the sample rate, so the latency (half the FIR length plus one
+ partition) stays at about 50ms. The audio thread takes over new kernels at partition boundaries
+ and crossfades from the previous one within that partition.
+ */
+class LinearPhaseFilter : private juce::Thread
+{
+public:
+    static constexpr int maxNumChannels = 64;
+    static constexpr int numPartitions = 16;
+
+    /** Writes the magnitudes at the given frequencies, gets called on the background thread. */
+    using MagnitudeFunction = std::function<void (const double* frequencies,
+                                                  double* magnitudes,
+                                                  const size_t numFrequencies,
+                                                  const double sampleRate)>;
+
+    LinearPhaseFilter() : juce::Thread ("MultiEQ Linear Phase") { startThread(); }
+
+    ~LinearPhaseFilter() override { stopThread (1000); }
+
+    void setMagnitudeFunction (MagnitudeFunction newMagnitudeFunction)
+    {
+        const juce::ScopedLock calculationLock (calculating);
+        magnitudeFunction = std::move (newMagnitudeFunction);
+    }
+
+    /**
+     Allocates everything for the given sample rate and calculates the kernel right away. Don't
+     call this concurrently with the audio thread, e.g. use it in prepareToPlay.
+     */
+    void prepare (const double newSampleRate)
+    {
+        const juce::ScopedLock calculationLock (calculating);
+
+        sampleRate = newSampleRate;
+        const int rateFactor =
+            juce::nextPowerOfTwo (juce::jmax (1, juce::roundToInt (sampleRate / 48000.0)));
+        partitionSize = basePartitionSize * rateFactor;
+        firLength = numPartitions * partitionSize;
+        numBins = partitionSize + 1;
+
+        // separate FFT objects for both threads
+        const int partitionOrder = juce::roundToInt (std::log2 (2 * partitionSize));
+        fft = std::make_unique<juce::dsp::FFT> (partitionOrder);
+        partitionFFT = std::make_unique<juce::dsp::FFT> (partitionOrder);
+        designFFT = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (2 * firLength)));
+
+        const size_t kernelSize = static_cast<size_t> (numPartitions * numBins);
+        for (auto* kernel : { &working, &pending, &current, &previous })
+            kernel->assign (kernelSize, {});
+
+        fftBuffer.resize (static_cast<size_t> (2 * partitionSize));
+        accumulators.resize (static_cast<size_t> (maxNumChannels * 2 * partitionSize));
+        frequencyDomainDelayLine.resize (static_cast<size_t> (maxNumChannels) * kernelSize);
+        inputBuffer.setSize (maxNumChannels, 2 * partitionSize);
+        outputBuffer.setSize (maxNumChannels, partitionSize);
+
+        designBuffer.resize (static_cast<size_t> (2 * firLength));
+        partitionBuffer.resize (static_cast<size_t> (2 * partitionSize));
+        frequencies.resize (static_cast<size_t> (firLength + 1));
+        magnitudes.resize (static_cast<size_t> (firLength + 1));
+        for (int k = 0; k <= firLength; ++k)
+            frequencies[static_cast<size_t> (k)] = k * sampleRate / (2 * firLength);
+
+        calculate (current);
+        previous = current;
+        newKernelAvailable = false;
+
+        reset();
+    }
+
+    /** Latency in samples, depends on the sample rate passed to prepare(). */
+    int getLatencyInSamples() const { return firLength / 2 + partitionSize; }
+
+    /** Samples after reset() until the output no longer misses any of the FIR's history. */
+    int getWarmUpInSamples() const { return firLength + partitionSize; }
+
+    void reset()
+    {
+        std::fill (frequencyDomainDelayLine.begin(), frequencyDomainDelayLine.end(), 0.0f);
+        inputBuffer.clear();
+        outputBuffer.clear();
+        fifoPosition = 0;
+        delayLineHead = 0;
+    }
+
+    /** Requests a new kernel, which will be calculated on the background thread. */
+    void requestNewKernel()
+    {
+        kernelChanged = true;
+        notify();
+    }
+
+    void process (float* const* channels, const int numChannels, const int numSamples)
+    {
+        const int nCh = juce::jmin (numChannels, maxNumChannels);
+
+        int done = 0;
+        while (done < numSamples)
+        {
+            const int n = juce::jmin (numSamples - done, partitionSize - fifoPosition);
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                juce::FloatVectorOperations::copy (
+                    inputBuffer.getWritePointer (ch, partitionSize + fifoPosition),
+                    channels[ch] + done,
+                    n);
+                juce::FloatVectorOperations::copy (channels[ch] + done,
+                                                   outputBuffer.getReadPointer (ch, fifoPosition),
+                                                   n);
+            }
+
+            done += n;
+            fifoPosition += n;
+            if (fifoPosition == partitionSize)
+            {
+                processPartition (nCh);
+                fifoPosition = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr int basePartitionSize = 256;
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            while (kernelChanged.exchange (false) && ! threadShouldExit())
+            {
+                const juce::ScopedLock calculationLock (calculating);
+                if (firLength == 0)
+                    continue;
+
+                calculate (working);
+
+                const juce::SpinLock::ScopedLockType lock (pendingLock);
+                std::copy (working.begin(), working.end(), pending.begin());
+                newKernelAvailable = true;
+            }
+        }
+    }
+
+    /**
+     Samples the magnitude response, transforms it into a zero-phase impulse response, which gets
+     delayed by half the FIR length and windowed, and stores the spectra of its partitions.
+     */
+    void calculate (std::vector<std::complex<float>>& kernel)
+    {
+        const size_t numFrequencies = static_cast<size_t> (firLength + 1);
+        if (magnitudeFunction != nullptr)
+            magnitudeFunction (frequencies.data(), magnitudes.data(), numFrequencies, sampleRate);
+        else
+            std::fill (magnitudes.begin(), magnitudes.end(), 1.0);
+
+        std::fill (designBuffer.begin(), designBuffer.end(), 0.0f);
+        for (size_t k = 0; k < numFrequencies; ++k)
+            designBuffer[k] = static_cast<float> (magnitudes[k]);
+
+        float* impulseResponse = reinterpret_cast<float*> (designBuffer.data());
+        designFFT->performRealOnlyInverseTransform (impulseResponse);
+
+        const int designLength = 2 * firLength;
+        const float twoPi = juce::MathConstants<float>::twoPi;
+        float* data = reinterpret_cast<float*> (partitionBuffer.data());
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            juce::FloatVectorOperations::clear (data, 4 * partitionSize);
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const int n = p * partitionSize + i;
+                const float phase = twoPi * n / firLength;
+                const float blackman =
+                    0.42f - 0.5f * std::cos (phase) + 0.08f * std::cos (2 * phase);
+                data[i] = blackman
+                          * impulseResponse[(n - firLength / 2 + designLength) % designLength];
+            }
+
+            partitionFFT->performRealOnlyForwardTransform (data, true);
+            std::copy (partitionBuffer.begin(),
+                       partitionBuffer.begin() + numBins,
+                       kernel.begin() + p * numBins);
+        }
+    }
+
+    /** Realtime-safe: takes over a newly calculated kernel, if there is one. */
+    bool pullNewKernel()
+    {
+        const juce::SpinLock::ScopedTryLockType lock (pendingLock);
+        if (! lock.isLocked() || ! newKernelAvailable)
+            return false;
+
+        std::swap (previous, current);
+        std::swap (current, pending);
+        newKernelAvailable = false;
+        return true;
+    }
+
+    void processPartition (const int nCh)
+    {
+        const bool crossfade = pullNewKernel();
+
+        delayLineHead = (delayLineHead + numPartitions - 1) % numPartitions;
+        float* data = reinterpret_cast<float*> (fftBuffer.data());
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            float* input = inputBuffer.getWritePointer (ch);
+            juce::FloatVectorOperations::copy (data, input, 2 * partitionSize);
+            fft->performRealOnlyForwardTransform (data, true);
+            std::copy (fftBuffer.begin(),
+                       fftBuffer.begin() + numBins,
+                       getSpectrum (ch, delayLineHead));
+
+            // keeping the current partition as first half of the next one
+            juce::FloatVectorOperations::copy (input, input + partitionSize, partitionSize);
+        }
+
+        if (crossfade)
+        {
+            convolve (previous, nCh);
+            for (int ch = 0; ch < nCh; ++ch)
+                outputBuffer.copyFrom (ch, 0, getConvolutionResult (ch), partitionSize);
+
+            convolve (current, nCh);
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                outputBuffer.applyGainRamp (ch, 0, partitionSize, 1.0f, 0.0f);
+                outputBuffer.addFromWithRamp (ch,
+                                              0,
+                                              getConvolutionResult (ch),
+                                              partitionSize,
+                                              0.0f,
+                                              1.0f);
+            }
+        }
+        else
+        {
+            convolve (current, nCh);
+            for (int ch = 0; ch < nCh; ++ch)
+                outputBuffer.copyFrom (ch, 0, getConvolutionResult (ch), partitionSize);
+        }
+    }
+
+    /** Multiplies the delayed input spectra with the kernel partitions, one partition at a time. */
+    void convolve (const std::vector<std::complex<float>>& kernel, const int nCh)
+    {
+        for (int ch = 0; ch < nCh; ++ch)
+            std::fill (getAccumulator (ch), getAccumulator (ch) + numBins, 0.0f);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            const auto* H = kernel.data() + p * numBins;
+            const int slot = (delayLineHead + p) % numPartitions;
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                const auto* X = getSpectrum (ch, slot);
+                auto* accumulator = getAccumulator (ch);
+                for (int k = 0; k < numBins; ++k)
+                    accumulator[k] += X[k] * H[k];
+            }
+        }
+
+        for (int ch = 0; ch < nCh; ++ch)
+            fft->performRealOnlyInverseTransform (reinterpret_cast<float*> (getAccumulator (ch)));
+    }
+
+    /** The second half of the inverse transform is free of circular aliasing. */
+    const float* getConvolutionResult (const int ch)
+    {
+        return reinterpret_cast<float*> (getAccumulator (ch)) + partitionSize;
+    }
+
+    std::complex<float>* getSpectrum (const int ch, const int slot)
+    {
+        return frequencyDomainDelayLine.data() + (ch * numPartitions + slot) * numBins;
+    }
+
+    std::complex<float>* getAccumulator (const int ch)
+    {
+        return accumulators.data() + ch * 2 * partitionSize;
+    }
+
+    double sampleRate = 48000.0;
+    int partitionSize = basePartitionSize;
+    int firLength = 0;
+    int numBins = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+
+    // background thread
+    juce::CriticalSection calculating;
+    std::atomic<bool> kernelChanged { false };
+    MagnitudeFunction magnitudeFunction;
+    std::unique_ptr<juce::dsp::FFT> designFFT, partitionFFT;
+    std::vector<std::complex<float>> designBuffer, partitionBuffer;
+    std::vector<double> frequencies, magnitudes;
+    std::vector<std::complex<float>> working;
+
+    juce::SpinLock pendingLock;
+    std::vector<std::complex<float>> pending;
+    bool newKernelAvailable = false;
+
+    // audio thread
+    std::vector<std::complex<float>> current, previous;
+    std::vector<std::complex<float>> fftBuffer;
+    std::vector<std::complex<float>> accumulators;
+    std::vector<std::complex<float>> frequencyDomainDelayLine;
+    juce::AudioBuffer<float> inputBuffer, outputBuffer;
+    int fifoPosition = 0;
+    int delayLineHead = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseFilter)
+};
@@ -78,6 +78,13 @@ MultiEQAudioProcessorEditor::MultiEQAudioProcessorEditor (MultiEQAudioProcessor&
 
     fv.enableFilter (2, false);
 
+    addAndMakeVisible (&tbLinearPhase);
+    tbLinearPhaseAttachment.reset (
+        new ButtonAttachment (valueTreeState, "linearPhase", tbLinearPhase));
+    tbLinearPhase.setButtonText ("Linear phase");
+    tbLinearPhase.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
+    tbLinearPhase.setTooltip ("Linear-phase filtering, introduces a latency of about 50ms.");
+
     for (int i = 0; i < numFilterBands; ++i)
     {
         addAndMakeVisible (&tbFilterOn[i]);
@@ -210,6 +217,9 @@ void MultiEQAudioProcessorEditor::resized()
             cbArea.removeFromLeft (25);
         }
 
+        tbLinearPhase.setBounds (filterArea.removeFromTop (20).removeFromRight (110));
+        filterArea.removeFromTop (5);
+
         fv.setBounds (filterArea);
     }
 }
@@ -92,6 +92,8 @@ private:
     std::unique_ptr<ComboBoxAttachment> cbNumInputChannelsAttachment;
 
     FilterVisualizer<double> fv;
+    juce::ToggleButton tbLinearPhase;
+    std::unique_ptr<ButtonAttachment> tbLinearPhaseAttachment;
     juce::TooltipWindow tooltipWin;
     OnOffButton tbFilterOn[numFilterBands];
     juce::ComboBox cbFilterType[numFilterBands];
@@ -44,9 +44,11 @@ MultiEQAudioProcessor::MultiEQAudioProcessor() :
 {
     // get pointers to the parameters
     inputChannelsSetting = parameters.getRawParameterValue ("inputChannelsSetting");
+    linearPhase = parameters.getRawParameterValue ("linearPhase");
 
     // add listeners to parameter changes
     parameters.addParameterListener ("inputChannelsSetting", this);
+    parameters.addParameterListener ("linearPhase", this);
 
     for (int i = 0; i < numFilterBands; ++i)
     {
@@ -56,6 +58,7 @@ MultiEQAudioProcessor::MultiEQAudioProcessor() :
         filterQ[i] = parameters.getRawParameterValue ("filterQ" + juce::String (i));
         filterGain[i] = parameters.getRawParameterValue ("filterGain" + juce::String (i));
 
+        parameters.addParameterListener ("filterEnabled" + juce::String (i), this);
         parameters.addParameterListener ("filterType" + juce::String (i), this);
         parameters.addParameterListener ("filterFrequency" + juce::String (i), this);
         parameters.addParameterListener ("filterQ" + juce::String (i), this);
@@ -78,33 +81,56 @@ MultiEQAudioProcessor::MultiEQAudioProcessor() :
     additionalProcessorCoefficients[0] = IIR::Coefficients<float>::makeAllPass (48000.0, 20.0f);
     additionalProcessorCoefficients[1] = IIR::Coefficients<float>::makeAllPass (48000.0, 20.0f);
 
+    filterBank.prepare (64, numFilterBands + 2);
+    filterBank.setCoefficientRamping (true); // smooth automation, also with large blocks
     copyFilterCoefficientsToProcessor();
 
-    for (int i = 0; i < numFilterBands; ++i)
-    {
-        filterArrays[i].clear();
-        for (int ch = 0; ch < ceil (64 / IIRfloat_elements); ++ch)
-            filterArrays[i].add (new IIR::Filter<IIRfloat> (processorCoefficients[i]));
-    }
-
-    additionalFilterArrays[0].clear();
-    for (int ch = 0; ch < ceil (64 / IIRfloat_elements); ++ch)
-        additionalFilterArrays[0].add (
-            new IIR::Filter<IIRfloat> (additionalProcessorCoefficients[0]));
-
-    additionalFilterArrays[1].clear();
-    for (int ch = 0; ch < ceil (64 / IIRfloat_elements); ++ch)
-        additionalFilterArrays[1].add (
-            new IIR::Filter<IIRfloat> (additionalProcessorCoefficients[1]));
+    linearPhaseFilter.setMagnitudeFunction (
+        [this] (const double* frequencies,
+                double* magnitudes,
+                const size_t numFrequencies,
+                const double sampleRate)
+        { calculateMagnitudeResponse (frequencies, magnitudes, numFrequencies, sampleRate); });
 }
 
 MultiEQAudioProcessor::~MultiEQAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 void MultiEQAudioProcessor::updateGuiCoefficients()
 {
     const double sampleRate = getSampleRate() == 0 ? 48000.0 : getSampleRate();
+    createGuiCoefficients (guiCoefficients, sampleRate);
+}
+
+void MultiEQAudioProcessor::calculateMagnitudeResponse (const double* frequencies,
+                                                        double* magnitudes,
+                                                        const size_t numFrequencies,
+                                                        const double sampleRate)
+{
+    IIR::Coefficients<double>::Ptr coefficients[numFilterBands];
+    createGuiCoefficients (coefficients, sampleRate);
+
+    std::fill (magnitudes, magnitudes + numFrequencies, 1.0);
+    std::vector<double> bandMagnitudes (numFrequencies);
+    for (int f = 0; f < numFilterBands; ++f)
+    {
+        if (*filterEnabled[f] < 0.5f || coefficients[f] == nullptr)
+            continue;
+
+        coefficients[f]->getMagnitudeForFrequencyArray (frequencies,
+                                                        bandMagnitudes.data(),
+                                                        numFrequencies,
+                                                        sampleRate);
+        for (size_t k = 0; k < numFrequencies; ++k)
+            magnitudes[k] *= bandMagnitudes[k];
+    }
+}
+
+void MultiEQAudioProcessor::createGuiCoefficients (IIR::Coefficients<double>::Ptr* coefficients,
+                                                   const double sampleRate)
+{
 
     // Low band
     const auto lowBandFrequency =
@@ -119,19 +145,19 @@ void MultiEQAudioProcessor::updateGuiCoefficients()
             coeffs->coefficients = FilterVisualizerHelper<double>::cascadeSecondOrderCoefficients (
                 coeffs->coefficients,
                 coeffs->coefficients);
-            guiCoefficients[0] = coeffs;
+            coefficients[0] = coeffs;
             break;
         }
         case SpecialFilterType::FirstOrderHighPass:
-            guiCoefficients[0] =
+            coefficients[0] =
                 IIR::Coefficients<double>::makeFirstOrderHighPass (sampleRate, lowBandFrequency);
             break;
         case SpecialFilterType::SecondOrderHighPass:
-            guiCoefficients[0] =
+            coefficients[0] =
                 IIR::Coefficients<double>::makeHighPass (sampleRate, lowBandFrequency, *filterQ[0]);
             break;
         case SpecialFilterType::LowShelf:
-            guiCoefficients[0] = IIR::Coefficients<double>::makeLowShelf (
+            coefficients[0] = IIR::Coefficients<double>::makeLowShelf (
                 sampleRate,
                 lowBandFrequency,
                 *filterQ[0],
@@ -155,21 +181,21 @@ void MultiEQAudioProcessor::updateGuiCoefficients()
             coeffs->coefficients = FilterVisualizerHelper<double>::cascadeSecondOrderCoefficients (
                 coeffs->coefficients,
                 coeffs->coefficients);
-            guiCoefficients[numFilterBands - 1] = coeffs;
+            coefficients[numFilterBands - 1] = coeffs;
             break;
         }
         case SpecialFilterType::FirstOrderLowPass:
-            guiCoefficients[numFilterBands - 1] =
+            coefficients[numFilterBands - 1] =
                 IIR::Coefficients<double>::makeFirstOrderLowPass (sampleRate, highBandFrequency);
             break;
         case SpecialFilterType::SecondOrderLowPass:
-            guiCoefficients[numFilterBands - 1] =
+            coefficients[numFilterBands - 1] =
                 IIR::Coefficients<double>::makeLowPass (sampleRate,
                                                         highBandFrequency,
                                                         *filterQ[numFilterBands - 1]);
             break;
         case SpecialFilterType::HighShelf:
-            guiCoefficients[numFilterBands - 1] = IIR::Coefficients<double>::makeHighShelf (
+            coefficients[numFilterBands - 1] = IIR::Coefficients<double>::makeHighShelf (
                 sampleRate,
                 highBandFrequency,
                 *filterQ[numFilterBands - 1],
@@ -189,21 +215,21 @@ void MultiEQAudioProcessor::updateGuiCoefficients()
         switch (type)
         {
             case RegularFilterType::LowShelf:
-                guiCoefficients[f] = IIR::Coefficients<double>::makeLowShelf (
+                coefficients[f] = IIR::Coefficients<double>::makeLowShelf (
                     sampleRate,
                     frequency,
                     *filterQ[f],
                     juce::Decibels::decibelsToGain (filterGain[f]->load()));
                 break;
             case RegularFilterType::PeakFilter:
-                guiCoefficients[f] = IIR::Coefficients<double>::makePeakFilter (
+                coefficients[f] = IIR::Coefficients<double>::makePeakFilter (
                     sampleRate,
                     frequency,
                     *filterQ[f],
                     juce::Decibels::decibelsToGain (filterGain[f]->load()));
                 break;
             case RegularFilterType::HighShelf:
-                guiCoefficients[f] = IIR::Coefficients<double>::makeHighShelf (
+                coefficients[f] = IIR::Coefficients<double>::makeHighShelf (
                     sampleRate,
                     frequency,
                     *filterQ[f],
@@ -383,17 +409,13 @@ void MultiEQAudioProcessor::copyFilterCoefficientsToProcessor()
     *additionalProcessorCoefficients[0] = *additionalTempCoefficients[0];
     *additionalProcessorCoefficients[1] = *additionalTempCoefficients[1];
 
-    userHasChangedFilterSettings = false;
-}
+    for (int b = 0; b < numFilterBands; ++b)
+        filterBank.setCoefficients (b, *processorCoefficients[b]);
 
-inline void MultiEQAudioProcessor::clear (juce::dsp::AudioBlock<IIRfloat>& ab)
-{
-    const int N = static_cast<int> (ab.getNumSamples()) * IIRfloat_elements;
-    const int nCh = static_cast<int> (ab.getNumChannels());
+    filterBank.setCoefficients (numFilterBands, *additionalProcessorCoefficients[0]);
+    filterBank.setCoefficients (numFilterBands + 1, *additionalProcessorCoefficients[1]);
 
-    for (int ch = 0; ch < nCh; ++ch)
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (ab.getChannelPointer (ch)),
-                                            N);
+    userHasChangedFilterSettings = false;
 }
 
 //==============================================================================
@@ -432,24 +454,19 @@ void MultiEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
     }
     copyFilterCoefficientsToProcessor();
 
-    interleavedData.clear();
+    filterBank.reset();
 
-    for (int i = 0; i < ceil (64 / IIRfloat_elements); ++i)
-    {
-        // reset filters
-        for (int f = 0; f < numFilterBands; ++f)
-        {
-            filterArrays[f][i]->reset (IIRfloat (0.0f));
-        }
-
-        interleavedData.add (
-            new juce::dsp::AudioBlock<IIRfloat> (interleavedBlockData[i], 1, samplesPerBlock));
-        //interleavedData.getLast()->clear(); // this one's broken in JUCE 5.4.5
-        clear (*interleavedData.getLast());
-    }
+    linearPhaseFilter.prepare (sampleRate);
+    linearPhaseActive = *linearPhase >= 0.5f;
+    setLatencySamples (linearPhaseActive ? linearPhaseFilter.getLatencyInSamples() : 0);
 
-    zero = juce::dsp::AudioBlock<float> (zeroData, IIRfloat_elements, samplesPerBlock);
-    zero.clear();
+    modeTransitionPosition = -1;
+    modeWarmUp = linearPhaseFilter.getWarmUpInSamples();
+    modeFadeLength = juce::roundToInt (modeFadeTimeInSeconds * sampleRate);
+    modeTransitionBuffer.setSize (64, samplesPerBlock);
+    iirDelayLine.setSize (64, linearPhaseFilter.getLatencyInSamples());
+    iirDelayLine.clear();
+    iirDelayLinePosition = 0;
 }
 
 void MultiEQAudioProcessor::releaseResources()
@@ -470,149 +487,123 @@ void MultiEQAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     if (maxNChIn < 1)
         return;
 
-    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
-
     // update iir filter coefficients
     if (userHasChangedFilterSettings.get())
         copyFilterCoefficientsToProcessor();
 
-    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    // a switch requested during a running transition follows after it
+    const bool useLinearPhase = *linearPhase >= 0.5f;
+    if (modeTransitionPosition < 0 && useLinearPhase != linearPhaseActive)
+        startModeTransition (useLinearPhase);
 
-    //interleave input data
-    int partial = maxNChIn % IIRfloat_elements;
-    if (partial == 0)
+    if (modeTransitionPosition >= 0)
     {
-        for (int i = 0; i < nSIMDFilters; ++i)
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        const int maxChunkSize = modeTransitionBuffer.getNumSamples();
+        for (int start = 0; start < L; start += maxChunkSize)
         {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
+            float* chunk[64];
+            for (int ch = 0; ch < maxNChIn; ++ch)
+                chunk[ch] = channels[ch] + start;
+
+            processModeTransition (chunk, maxNChIn, juce::jmin (maxChunkSize, L - start));
         }
+        return;
     }
+
+    if (linearPhaseActive)
+        linearPhaseFilter.process (buffer.getArrayOfWritePointers(), maxNChIn, L);
     else
-    {
-        int i;
-        for (i = 0; i < nSIMDFilters - 1; ++i)
-        {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
-        }
+        processIIRFilters (buffer.getArrayOfWritePointers(), maxNChIn, L);
+}
 
-        const float* addr[IIRfloat_elements];
-        int ch;
-        for (ch = 0; ch < partial; ++ch)
-        {
-            addr[ch] = buffer.getReadPointer (i * IIRfloat_elements + ch);
-        }
-        for (; ch < IIRfloat_elements; ++ch)
-        {
-            addr[ch] = zero.getChannelPointer (ch);
-        }
-        juce::AudioData::interleaveSamples (
-            juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
-            juce::AudioData::InterleavedDest<Format> {
-                reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                IIRfloat_elements },
-            L);
-    }
+void MultiEQAudioProcessor::startModeTransition (const bool toLinearPhase)
+{
+    // the mode which is switched to starts from scratch
+    if (toLinearPhase)
+        linearPhaseFilter.reset();
+    else
+        filterBank.reset();
 
-    // apply filters
-    for (int f = 0; f < numFilterBands; ++f)
+    iirDelayLine.clear();
+    iirDelayLinePosition = 0;
+    modeTransitionPosition = 0;
+}
+
+void MultiEQAudioProcessor::processModeTransition (float* const* channels,
+                                                   const int nCh,
+                                                   const int L)
+{
+    const bool toLinearPhase = ! linearPhaseActive;
+
+    // both modes process the input: the IIR filters a copy, the linear-phase filter in place
+    for (int ch = 0; ch < nCh; ++ch)
+        modeTransitionBuffer.copyFrom (ch, 0, channels[ch], L);
+
+    processIIRFilters (modeTransitionBuffer.getArrayOfWritePointers(), nCh, L);
+    linearPhaseFilter.process (channels, nCh, L);
+
+    // until the fade starts, the previous mode is heard with its own latency, during the fade
+    // both have the linear-phase latency, afterwards the new mode is heard with its own latency
+    const int delayLength = iirDelayLine.getNumSamples();
+    for (int ch = 0; ch < nCh; ++ch)
     {
-        if (*filterEnabled[f] > 0.5f)
+        const float* iir = modeTransitionBuffer.getReadPointer (ch);
+        float* delayLine = iirDelayLine.getWritePointer (ch);
+        float* out = channels[ch];
+
+        int position = iirDelayLinePosition;
+        for (int i = 0; i < L; ++i)
         {
-            for (int i = 0; i < nSIMDFilters; ++i)
+            const float linear = out[i];
+            const float delayedIIR = delayLine[position];
+            delayLine[position] = iir[i];
+            if (++position == delayLength)
+                position = 0;
+
+            const int t = modeTransitionPosition + i;
+            if (t < modeWarmUp)
+                out[i] = toLinearPhase ? iir[i] : linear;
+            else if (t < modeWarmUp + modeFadeLength)
             {
-                const IIRfloat* chPtr[1] = { interleavedData[i]->getChannelPointer (0) };
-                juce::dsp::AudioBlock<IIRfloat> ab (const_cast<IIRfloat**> (chPtr), 1, L);
-                juce::dsp::ProcessContextReplacing<IIRfloat> context (ab);
-                filterArrays[f][i]->process (context);
+                const float gain = (t - modeWarmUp + 0.5f) / modeFadeLength;
+                out[i] = toLinearPhase ? delayedIIR + gain * (linear - delayedIIR)
+                                       : linear + gain * (delayedIIR - linear);
             }
+            else
+                out[i] = toLinearPhase ? linear : iir[i];
         }
     }
 
-    // check and apply additional filters (Linkwitz Riley -> two BiQuads)
-    if (static_cast<int> (*filterType[0]) == 2 && *filterEnabled[0] > 0.5f)
-    {
-        for (int i = 0; i < nSIMDFilters; ++i)
-        {
-            const IIRfloat* chPtr[1] = { chPtr[0] = interleavedData[i]->getChannelPointer (0) };
-            juce::dsp::AudioBlock<IIRfloat> ab (const_cast<IIRfloat**> (chPtr), 1, L);
-            juce::dsp::ProcessContextReplacing<IIRfloat> context (ab);
-            additionalFilterArrays[0][i]->process (context);
-        }
-    }
-    if (static_cast<int> (*filterType[numFilterBands - 1]) == 2
-        && *filterEnabled[numFilterBands - 1] > 0.5f)
-    {
-        for (int i = 0; i < nSIMDFilters; ++i)
-        {
-            const IIRfloat* chPtr[1] = { interleavedData[i]->getChannelPointer (0) };
-            juce::dsp::AudioBlock<IIRfloat> ab (const_cast<IIRfloat**> (chPtr), 1, L);
-            juce::dsp::ProcessContextReplacing<IIRfloat> context (ab);
-            additionalFilterArrays[1][i]->process (context);
-        }
-    }
+    iirDelayLinePosition = (iirDelayLinePosition + L) % delayLength;
+    modeTransitionPosition += L;
 
-    // deinterleave
-    if (partial == 0)
+    if (modeTransitionPosition >= modeWarmUp + modeFadeLength)
     {
-        for (int i = 0; i < nSIMDFilters; ++i)
-        {
-            juce::AudioData::deinterleaveSamples (
-                juce::AudioData::InterleavedSource<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                juce::AudioData::NonInterleavedDest<Format> { buffer.getArrayOfWritePointers()
-                                                                  + i * IIRfloat_elements,
-                                                              IIRfloat_elements },
-                L);
-        }
+        linearPhaseActive = toLinearPhase;
+        modeTransitionPosition = -1;
+
+        // the previous mode starts from scratch when switched to again
+        if (toLinearPhase)
+            filterBank.reset();
+        else
+            linearPhaseFilter.reset();
     }
-    else
-    {
-        int i;
-        for (i = 0; i < nSIMDFilters - 1; ++i)
-        {
-            juce::AudioData::deinterleaveSamples (
-                juce::AudioData::InterleavedSource<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                juce::AudioData::NonInterleavedDest<Format> { buffer.getArrayOfWritePointers()
-                                                                  + i * IIRfloat_elements,
-                                                              IIRfloat_elements },
-                L);
-        }
+}
 
-        float* addr[IIRfloat_elements];
-        int ch;
-        for (ch = 0; ch < partial; ++ch)
-        {
-            addr[ch] = buffer.getWritePointer (i * IIRfloat_elements + ch);
-        }
-        for (; ch < IIRfloat_elements; ++ch)
-        {
-            addr[ch] = zero.getChannelPointer (ch);
-        }
-        juce::AudioData::deinterleaveSamples (
-            juce::AudioData::InterleavedSource<Format> {
-                reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                IIRfloat_elements },
-            juce::AudioData::NonInterleavedDest<Format> { addr, IIRfloat_elements },
-            L);
-        zero.clear();
-    }
+void MultiEQAudioProcessor::processIIRFilters (float* const* channels, const int nCh, const int L)
+{
+    for (int f = 0; f < numFilterBands; ++f)
+        filterBank.setEnabled (f, *filterEnabled[f] > 0.5f);
+
+    // additional filters (Linkwitz Riley -> two BiQuads)
+    filterBank.setEnabled (numFilterBands,
+                           static_cast<int> (*filterType[0]) == 2 && *filterEnabled[0] > 0.5f);
+    filterBank.setEnabled (numFilterBands + 1,
+                           static_cast<int> (*filterType[numFilterBands - 1]) == 2
+                               && *filterEnabled[numFilterBands - 1] > 0.5f);
+
+    filterBank.process (channels, nCh, L);
 }
 
 //==============================================================================
@@ -665,6 +656,10 @@ void MultiEQAudioProcessor::parameterChanged (const juce::String& parameterID, f
 
     if (parameterID == "inputChannelsSetting")
         userChangedIOSettings = true;
+    else if (parameterID == "linearPhase")
+        triggerAsyncUpdate();
+    else if (parameterID.startsWith ("filterEnabled"))
+        linearPhaseFilter.requestNewKernel();
     else if (parameterID.startsWith ("filter"))
     {
         const int i = parameterID.getLastCharacters (1).getIntValue();
@@ -673,9 +668,15 @@ void MultiEQAudioProcessor::parameterChanged (const juce::String& parameterID, f
 
         repaintFV = true;
         userHasChangedFilterSettings = true;
+        linearPhaseFilter.requestNewKernel();
     }
 }
 
+void MultiEQAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples (*linearPhase >= 0.5f ? linearPhaseFilter.getLatencyInSamples() : 0);
+}
+
 void MultiEQAudioProcessor::updateBuffers()
 {
     DBG ("IOHelper:  input size: " << input.getSize());
@@ -698,6 +699,17 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return value < 0.5f ? "Auto" : juce::String (value); },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "linearPhase",
+        "Linear Phase",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        0.0f,
+        [] (float value) { return value < 0.5 ? juce::String ("OFF") : juce::String ("ON"); },
+        nullptr,
+        false,
+        false)); // changes the latency, which hosts can't compensate during playback
+
     int i = 0;
     params.push_back (OSCParameterInterface::createParameterTheOldWay (
         "filterEnabled" + juce::String (i),
@@ -23,25 +23,20 @@
 #pragma once
 
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/BiquadBank.h"
 #include "../../resources/FilterVisualizerHelper.h"
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "LinearPhaseFilter.h"
 
 #define numFilterBands 6
 using namespace juce::dsp;
 
-#if JUCE_USE_SIMD
-using IIRfloat = juce::dsp::SIMDRegister<float>;
-static constexpr int IIRfloat_elements = juce::dsp::SIMDRegister<float>::size();
-#else /* !JUCE_USE_SIMD */
-using IIRfloat = float;
-static constexpr int IIRfloat_elements = 1;
-#endif /* JUCE_USE_SIMD */
-
 #define ProcessorClass MultiEQAudioProcessor
 
 //==============================================================================
 class MultiEQAudioProcessor
-    : public AudioProcessorBase<IOTypes::AudioChannels<64>, IOTypes::AudioChannels<64>>
+    : public AudioProcessorBase<IOTypes::AudioChannels<64>, IOTypes::AudioChannels<64>>,
+      private juce::AsyncUpdater
 {
 public:
     constexpr static int numberOfInputChannels = 64;
@@ -88,6 +83,12 @@ public:
     };
     void updateGuiCoefficients();
 
+    /** Magnitude response of all enabled bands, used for the linear-phase kernel. */
+    void calculateMagnitudeResponse (const double* frequencies,
+                                     double* magnitudes,
+                                     const size_t numFrequencies,
+                                     const double sampleRate);
+
     // FV repaint flag
     juce::Atomic<bool> repaintFV = true;
 
@@ -116,11 +117,26 @@ private:
         HighShelf
     };
 
+    void createGuiCoefficients (IIR::Coefficients<double>::Ptr* coefficients,
+                                const double sampleRate);
+
+    /** Processes the channels with the IIR filters, the minimum-phase mode. */
+    void processIIRFilters (float* const* channels, const int nCh, const int L);
+
+    /**
+     Switching modes: both run until the linear-phase filter is warmed up and the IIR output fills
+     a delay line of the linear-phase latency, then the two are crossfaded at the same latency.
+     The chunks mustn't be longer than modeTransitionBuffer.
+     */
+    void startModeTransition (const bool toLinearPhase);
+    void processModeTransition (float* const* channels, const int nCh, const int L);
+
+    /** Reports the latency of the selected mode, on the message thread. */
+    void handleAsyncUpdate() override;
+
     void createLinkwitzRileyFilter (const bool isUpperBand);
     void createFilterCoefficients (const int filterIndex, const double sampleRate);
 
-    inline void clear (juce::dsp::AudioBlock<IIRfloat>& ab);
-
     inline juce::dsp::IIR::Coefficients<float>::Ptr
         createFilterCoefficients (const RegularFilterType type,
                                   const double sampleRate,
@@ -144,22 +160,29 @@ private:
     IIR::Coefficients<float>::Ptr tempCoefficients[numFilterBands];
     IIR::Coefficients<float>::Ptr additionalTempCoefficients[2];
 
-    // data for interleaving audio
-    juce::HeapBlock<char> interleavedBlockData[16], zeroData; //todo: dynamically?
-    juce::OwnedArray<juce::dsp::AudioBlock<IIRfloat>> interleavedData;
-    juce::dsp::AudioBlock<float> zero;
-
     // list of used audio parameters
     std::atomic<float>* inputChannelsSetting;
+    std::atomic<float>* linearPhase;
     std::atomic<float>* filterEnabled[numFilterBands];
     std::atomic<float>* filterType[numFilterBands];
     std::atomic<float>* filterFrequency[numFilterBands];
     std::atomic<float>* filterQ[numFilterBands];
     std::atomic<float>* filterGain[numFilterBands];
 
-    // filters for processing
-    juce::OwnedArray<IIR::Filter<IIRfloat>> filterArrays[numFilterBands];
-    juce::OwnedArray<IIR::Filter<IIRfloat>> additionalFilterArrays[2];
+    // filters for processing: the bands, followed by the two additional Linkwitz-Riley stages
+    iem::BiquadBank filterBank;
+
+    // linear-phase mode: FIR synthesized from the magnitude responses of the GUI coefficients
+    LinearPhaseFilter linearPhaseFilter;
+    bool linearPhaseActive = false;
+
+    // switching modes
+    static constexpr double modeFadeTimeInSeconds = 0.02;
+    int modeTransitionPosition = -1; // samples since the switch, -1 if not switching
+    int modeWarmUp = 0, modeFadeLength = 0;
+    juce::AudioBuffer<float> modeTransitionBuffer; // the IIR path's output
+    juce::AudioBuffer<float> iirDelayLine; // the IIR path's output delayed by the latency
+    int iirDelayLinePosition = 0;
 
     juce::Atomic<bool> userHasChangedFilterSettings = true;
 
@@ -24,24 +24,36 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 
 using namespace juce::dsp;
+
+/**
+ Fades gain reduction values (in decibels) in ahead of time, so the delayed signal already is
+ attenuated when a peak arrives.
+ First, the minimum of the next delayInSamples values is held (sliding minimum after van Herk and
+ Gil-Werman, three comparisons per sample, no matter how long the look-ahead is), then the held
+ values get averaged over delayInSamples, which results in linear fades. The result never
+ reduces less than the original value of the delayed sample.
+ Everything is allocated for the maximum delay time in prepare(), so the delay time can change
+ while processing.
+ */
 class LookAheadGainReduction
 {
 public:
     LookAheadGainReduction() {}
     ~LookAheadGainReduction() {}
 
-    void setDelayTime (float delayTimeInSeconds)
+    /** Takes effect with the next call of prepare(). */
+    void setMaximumDelayTime (float maximumDelayTimeInSeconds)
     {
-        if (delayTimeInSeconds <= 0.0f)
-        {
-            delay = 0.0f;
-        }
-        else
-        {
-            delay = delayTimeInSeconds;
-        }
+        maximumDelay = juce::jmax (0.0f, maximumDelayTimeInSeconds);
+    }
 
-        prepare (spec);
+    /** Doesn't allocate, delay times above the maximum delay time get clipped. */
+    void setDelayTime (float delayTimeInSeconds)
+    {
+        delay = juce::jlimit (0.0f, maximumDelay, delayTimeInSeconds);
+        delayInSamples = juce::jlimit (0,
+                                       maximumDelayInSamples,
+                                       static_cast<int> (delay * spec.sampleRate));
     }
 
     const int getDelayInSamples() { return delayInSamples; }
@@ -50,220 +62,120 @@ public:
     {
         spec = specs;
 
-        delayInSamples = delay * specs.sampleRate;
-
-        buffer.setSize (specs.numChannels, specs.maximumBlockSize + delayInSamples);
-        buffer.clear();
-        writePosition = 0;
-    }
-
-    void pushSamples (const float* src, int numSamples)
-    {
-        int startIndex, blockSize1, blockSize2;
-
-        // write in delay line
-        getWritePositions (numSamples, startIndex, blockSize1, blockSize2);
-
-        buffer.copyFrom (0, startIndex, src, blockSize1);
+        maximumDelayInSamples = static_cast<int> (maximumDelay * specs.sampleRate);
+        chunkSize = juce::jmax (1, static_cast<int> (specs.maximumBlockSize));
 
-        if (blockSize2 > 0)
-            buffer.copyFrom (0, 0, src + blockSize1, blockSize2);
+        history.resize (static_cast<size_t> (maximumDelayInSamples + chunkSize));
+        holds.resize (static_cast<size_t> (maximumDelayInSamples + chunkSize));
+        prefixMinimum.resize (history.size());
+        suffixMinimum.resize (history.size());
 
-        writePosition += numSamples;
-        writePosition = writePosition % buffer.getNumSamples();
-
-        lastPushedSamples = numSamples;
+        setDelayTime (delay);
+        reset();
     }
 
-    void readSamples (float* dest, int numSamples)
+    void reset()
     {
-        jassert (numSamples == lastPushedSamples);
-
-        int startIndex, blockSize1, blockSize2;
-
-        // read from delay line
-        getReadPositions (numSamples, startIndex, blockSize1, blockSize2);
-        juce::FloatVectorOperations::copy (dest,
-                                           buffer.getReadPointer (0) + startIndex,
-                                           blockSize1);
-
-        if (blockSize2 > 0)
-            juce::FloatVectorOperations::copy (dest + blockSize1,
-                                               buffer.getReadPointer (0),
-                                               blockSize2);
+        std::fill (history.begin(), history.end(), 0.0f);
+        std::fill (holds.begin(), holds.end(), 0.0f);
     }
 
-    void process()
+    /** Processes gain reduction values in decibels (<= 0), in place processing is allowed. */
+    void process (const float* src, float* dest, int numSamples)
     {
-        jassert (delayInSamples > 0);
-
         juce::ScopedNoDenormals noDenormals;
 
-        float nextGainReductionValue = 0.0f;
-        float step = 0.0f;
-
-        // last pushed samples
-        int startIndex = writePosition - 1;
-        if (startIndex < 0)
-            startIndex += buffer.getNumSamples();
-
-        int size1, size2;
-
-        getProcessPositions (startIndex, lastPushedSamples, size1, size2);
-        for (int i = 0; i < size1; ++i)
+        while (numSamples > 0)
         {
-            float smpl = buffer.getSample (0, startIndex);
-            if (smpl > nextGainReductionValue)
-            {
-                buffer.setSample (0, startIndex, nextGainReductionValue);
-                nextGainReductionValue += step;
-            }
-            else
-            {
-                step = -smpl / delayInSamples;
-                nextGainReductionValue = smpl + step;
-            }
-            --startIndex;
-        }
-        if (size2 > 0)
-        {
-            startIndex = buffer.getNumSamples() - 1;
-            for (int i = 0; i < size2; ++i)
-            {
-                float smpl = buffer.getSample (0, startIndex);
-                if (smpl > nextGainReductionValue)
-                {
-                    buffer.setSample (0, startIndex, nextGainReductionValue);
-                    nextGainReductionValue += step;
-                }
-                else
-                {
-                    step = -smpl / delayInSamples;
-                    nextGainReductionValue = smpl + step;
-                }
-                --startIndex;
-            }
-        }
-
-        if (startIndex < 0)
-            startIndex = buffer.getNumSamples() - 1;
-
-        getProcessPositions (startIndex, delayInSamples, size1, size2);
-        bool breakWasUsed = false;
-
-        for (int i = 0; i < size1; ++i)
-        {
-            float smpl = buffer.getSample (0, startIndex);
-            if (smpl > nextGainReductionValue)
-            {
-                buffer.setSample (0, startIndex, nextGainReductionValue);
-                nextGainReductionValue += step;
-            }
-            else
-            {
-                breakWasUsed = true;
-                break;
-            }
-            --startIndex;
-        }
-        if (! breakWasUsed && size2 > 0)
-        {
-            startIndex = buffer.getNumSamples() - 1;
-            for (int i = 0; i < size2; ++i)
-            {
-                float smpl = buffer.getSample (0, startIndex);
-                if (smpl > nextGainReductionValue)
-                {
-                    buffer.setSample (0, startIndex, nextGainReductionValue);
-                    nextGainReductionValue += step;
-                }
-                else
-                {
-                    break;
-                }
-                --startIndex;
-            }
+            const int n = juce::jmin (numSamples, chunkSize);
+            processChunk (src, dest, n);
+            src += n;
+            dest += n;
+            numSamples -= n;
         }
     }
 
 private:
-    inline void
-        getProcessPositions (int startIndex, int numSamples, int& blockSize1, int& blockSize2)
+    /**
+     Both history and holds keep the last maximumDelayInSamples values in front of the
+     current chunk, which follows at offset maximumDelayInSamples.
+     */
+    void processChunk (const float* src, float* dest, const int numSamples)
     {
-        jassert (startIndex >= 0 && startIndex < buffer.getNumSamples());
+        const int D = delayInSamples;
+        const int offset = maximumDelayInSamples;
+
+        float* newValues = history.data() + offset;
+        juce::FloatVectorOperations::copy (newValues, src, numSamples);
 
-        if (numSamples <= 0)
+        if (D == 0)
         {
-            blockSize1 = 0;
-            blockSize2 = 0;
+            juce::FloatVectorOperations::copy (dest, newValues, numSamples);
         }
         else
         {
-            blockSize1 = juce::jmin (startIndex + 1, numSamples);
-            numSamples -= blockSize1;
-            blockSize2 = numSamples <= 0 ? 0 : numSamples;
+            // sliding minimum over the window of the last D values of each new value
+            const int windowStart = offset - (D - 1);
+            const int length = D - 1 + numSamples;
+            calculateSegmentMinima (history.data() + windowStart, length, D);
+            juce::FloatVectorOperations::min (holds.data() + offset,
+                                              suffixMinimum.data(),
+                                              prefixMinimum.data() + D - 1,
+                                              numSamples);
+
+            // moving average of the D holds before each new value
+            const float* h = holds.data() + offset;
+            double sum = 0.0;
+            for (int j = 1; j <= D; ++j)
+                sum += h[-j];
+
+            const double scale = 1.0 / D;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                dest[i] = static_cast<float> (sum * scale);
+                sum += h[i] - h[i - D];
+            }
         }
+
+        shiftLeft (history, numSamples);
+        shiftLeft (holds, numSamples);
     }
 
-    inline void
-        getWritePositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
+    /** Minima from the segment starts and towards the segment ends, segments of length D. */
+    void calculateSegmentMinima (const float* values, const int length, const int D)
     {
-        const int L = buffer.getNumSamples();
-        int pos = writePosition;
+        float* prefix = prefixMinimum.data();
+        float* suffix = suffixMinimum.data();
 
-        if (pos < 0)
-            pos = pos + L;
-        pos = pos % L;
+        for (int segmentStart = 0; segmentStart < length; segmentStart += D)
+        {
+            const int segmentEnd = juce::jmin (segmentStart + D, length);
 
-        jassert (pos >= 0 && pos < L);
+            prefix[segmentStart] = values[segmentStart];
+            for (int i = segmentStart + 1; i < segmentEnd; ++i)
+                prefix[i] = juce::jmin (prefix[i - 1], values[i]);
 
-        if (numSamples <= 0)
-        {
-            startIndex = 0;
-            blockSize1 = 0;
-            blockSize2 = 0;
-        }
-        else
-        {
-            startIndex = pos;
-            blockSize1 = juce::jmin (L - pos, numSamples);
-            numSamples -= blockSize1;
-            blockSize2 = numSamples <= 0 ? 0 : numSamples;
+            suffix[segmentEnd - 1] = values[segmentEnd - 1];
+            for (int i = segmentEnd - 2; i >= segmentStart; --i)
+                suffix[i] = juce::jmin (suffix[i + 1], values[i]);
         }
     }
 
-    inline void getReadPositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
+    void shiftLeft (std::vector<float>& data, const int numSamples)
     {
-        const int L = buffer.getNumSamples();
-        int pos = writePosition - lastPushedSamples - delayInSamples;
-
-        if (pos < 0)
-            pos = pos + L;
-        pos = pos % L;
-
-        jassert (pos >= 0 && pos < L);
-
-        if (numSamples <= 0)
-        {
-            startIndex = 0;
-            blockSize1 = 0;
-            blockSize2 = 0;
-        }
-        else
-        {
-            startIndex = pos;
-            blockSize1 = juce::jmin (L - pos, numSamples);
-            numSamples -= blockSize1;
-            blockSize2 = numSamples <= 0 ? 0 : numSamples;
-        }
+        std::copy (data.begin() + numSamples,
+                   data.begin() + numSamples + maximumDelayInSamples,
+                   data.begin());
     }
 
-private:
     //==============================================================================
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
-    float delay;
+    float delay = 0.0f;
+    float maximumDelay = 0.02f;
     int delayInSamples = 0;
-    int writePosition = 0;
-    int lastPushedSamples = 0;
-    juce::AudioBuffer<float> buffer;
+    int maximumDelayInSamples = 0;
+    int chunkSize = 1;
+
+    std::vector<float> history, holds;
+    std::vector<float> prefixMinimum, suffixMinimum;
 };
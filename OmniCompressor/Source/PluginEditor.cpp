@@ -33,7 +33,7 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (
     footer (p.getOSCParameterInterface()),
     characteristic (&processor.compressor)
 {
-    setSize (330, 500);
+    setSize (330, 530);
     setLookAndFeel (&globalLaF);
 
     addAndMakeVisible (&title);
@@ -48,6 +48,28 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (
     tbLookAhead.setButtonText ("Look ahead (5ms)");
     tbLookAhead.setColour (juce::ToggleButton::tickColourId, globalLaF.ClWidgetColours[0]);
 
+    addAndMakeVisible (&cbDetectorOrder);
+    cbDetectorOrder.setJustificationType (juce::Justification::centred);
+    cbDetectorOrder.addSectionHeading ("Detector");
+    cbDetectorOrder.addItem ("W only", 1);
+    cbDetectorOrder.addItem ("up to 1st order", 2);
+    cbDetectorOrder.addItem ("up to 2nd order", 3);
+    cbDetectorOrder.addItem ("up to 3rd order", 4);
+    cbDetectorOrder.addItem ("up to 4th order", 5);
+    cbDetectorOrder.addItem ("up to 5th order", 6);
+    cbDetectorOrder.addItem ("up to 6th order", 7);
+    cbDetectorOrder.addItem ("up to 7th order", 8);
+    cbDetectorOrderAttachment.reset (
+        new ComboBoxAttachment (valueTreeState, "detectorOrder", cbDetectorOrder));
+    cbDetectorOrder.setTooltip ("Channels used for the linked level detection.");
+
+    addAndMakeVisible (&slRMSTime);
+    slRMSTimeAttachment.reset (new SliderAttachment (valueTreeState, "rmsTime", slRMSTime));
+    slRMSTime.setSliderStyle (juce::Slider::LinearHorizontal);
+    slRMSTime.setTextBoxStyle (juce::Slider::TextBoxRight, false, 50, 15);
+    slRMSTime.setColour (juce::Slider::rotarySliderOutlineColourId, globalLaF.ClWidgetColours[0]);
+    slRMSTime.setTextValueSuffix (" ms");
+
     addAndMakeVisible (&sliderKnee);
     KnAttachment.reset (new SliderAttachment (valueTreeState, "knee", sliderKnee));
     sliderKnee.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
@@ -132,6 +154,9 @@ OmniCompressorAudioProcessorEditor::OmniCompressorAudioProcessorEditor (
     addAndMakeVisible (&lbRelease);
     lbRelease.setText ("Release");
 
+    addAndMakeVisible (&lbRMSTime);
+    lbRMSTime.setText ("RMS", false, juce::Justification::left);
+
     startTimer (50);
 }
 
@@ -226,7 +251,13 @@ void OmniCompressorAudioProcessorEditor::resized()
     lbRelease.setBounds (sliderRow.removeFromLeft (sliderWidth));
 
     area.removeFromBottom (10);
-    tbLookAhead.setBounds (area.removeFromBottom (20).removeFromLeft (130));
+    sliderRow = area.removeFromBottom (20);
+    lbRMSTime.setBounds (sliderRow.removeFromLeft (40));
+    slRMSTime.setBounds (sliderRow);
+    area.removeFromBottom (5);
+    sliderRow = area.removeFromBottom (20);
+    tbLookAhead.setBounds (sliderRow.removeFromLeft (130));
+    cbDetectorOrder.setBounds (sliderRow.removeFromRight (120));
     area.removeFromBottom (10);
     characteristic.setBounds (area);
 }
@@ -76,10 +76,15 @@ private:
     juce::ToggleButton tbLookAhead;
     std::unique_ptr<ButtonAttachment> tbLookAheadAttachment;
 
+    juce::ComboBox cbDetectorOrder;
+    std::unique_ptr<ComboBoxAttachment> cbDetectorOrderAttachment;
+    ReverseSlider slRMSTime;
+    std::unique_ptr<SliderAttachment> slRMSTimeAttachment;
+
     CompressorVisualizer characteristic;
     LevelMeter inpMeter, dbGRmeter;
 
-    SimpleLabel lbKnee, lbThreshold, lbOutGain, lbRatio, lbAttack, lbRelease;
+    SimpleLabel lbKnee, lbThreshold, lbOutGain, lbRatio, lbAttack, lbRelease, lbRMSTime;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OmniCompressorAudioProcessorEditor)
 };
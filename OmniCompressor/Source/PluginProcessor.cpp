@@ -41,6 +41,7 @@ OmniCompressorAudioProcessor::OmniCompressorAudioProcessor() :
     parameters.addParameterListener ("orderSetting", this);
 
     orderSetting = parameters.getRawParameterValue ("orderSetting");
+    useSN3D = parameters.getRawParameterValue ("useSN3D");
     threshold = parameters.getRawParameterValue ("threshold");
     knee = parameters.getRawParameterValue ("knee");
     outGain = parameters.getRawParameterValue ("outGain");
@@ -49,6 +50,8 @@ OmniCompressorAudioProcessor::OmniCompressorAudioProcessor() :
     release = parameters.getRawParameterValue ("release");
     lookAhead = parameters.getRawParameterValue ("lookAhead");
     reportLatency = parameters.getRawParameterValue ("reportLatency");
+    detectorOrder = parameters.getRawParameterValue ("detectorOrder");
+    rmsTime = parameters.getRawParameterValue ("rmsTime");
     GR = 0.0f;
 
     delay.setDelayTime (0.005f);
@@ -107,6 +110,7 @@ void OmniCompressorAudioProcessor::prepareToPlay (double sampleRate, int samples
     spec.maximumBlockSize = samplesPerBlock;
 
     compressor.prepare (spec);
+    detector.prepare (spec);
     grProcessing.prepare (spec);
     spec.numChannels = getTotalNumInputChannels();
     delay.prepare (spec);
@@ -136,7 +140,6 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
                                   input.getNumberOfChannels(),
                                   output.getNumberOfChannels());
     //const int ambisonicOrder = juce::jmin(input.getOrder(), output.getOrder());
-    const float* bufferReadPtr = buffer.getReadPointer (0);
 
     const bool useLookAhead = *lookAhead >= 0.5f;
 
@@ -153,9 +156,17 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
     compressor.setThreshold (*threshold);
     compressor.setMakeUpGain (*outGain);
 
+    detector.setOrder (static_cast<int> (*detectorOrder));
+    detector.setNormalization (*useSN3D >= 0.5f);
+    detector.setRMSTime (*rmsTime * 0.001f);
+
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    // the gain computation happens in place on the detected level
+    detector.process (buffer.getArrayOfReadPointers(), numCh, gains.getWritePointer (0), bufferSize);
+    const float* bufferReadPtr = gains.getReadPointer (0);
+
     if (useLookAhead)
     {
         compressor.getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (bufferReadPtr,
@@ -170,17 +181,13 @@ void OmniCompressorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer
             delay.process (context);
         }
 
-        grProcessing.pushSamples (gains.getReadPointer (0), bufferSize);
-        grProcessing.process();
-        grProcessing.readSamples (gains.getWritePointer (0), bufferSize);
+        grProcessing.process (gains.getReadPointer (0), gains.getWritePointer (0), bufferSize);
 
         // convert from decibels to gain values
-        for (int i = 0; i < bufferSize; ++i)
-        {
-            gains.setSample (0,
-                             i,
-                             juce::Decibels::decibelsToGain (gains.getSample (0, i) + *outGain));
-        }
+        iem::FastMath::decibelsToGain (gains.getReadPointer (0),
+                                       gains.getWritePointer (0),
+                                       bufferSize,
+                                       *outGain);
     }
     else
     {
@@ -364,6 +371,36 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return value >= 0.5f ? "ON (5ms)" : "OFF"; },
         nullptr));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "detectorOrder",
+        "Detector Order",
+        "",
+        juce::NormalisableRange<float> (0.0f, 7.0f, 1.0f),
+        0.0f,
+        [] (float value)
+        {
+            const char* orders[] = { "W only", "1st", "2nd", "3rd", "4th", "5th", "6th", "7th" };
+            const int order = juce::jlimit (0, 7, juce::roundToInt (value));
+            if (order == 0)
+                return juce::String (orders[0]);
+            return "up to " + juce::String (orders[order]) + " order";
+        },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "rmsTime",
+        "RMS Time",
+        "ms",
+        juce::NormalisableRange<float> (0.0f, 50.0f, 0.1f),
+        0.0f,
+        [] (float value)
+        {
+            if (value < 0.05f)
+                return juce::String ("Peak");
+            return juce::String (value, 1);
+        },
+        nullptr));
+
     params.push_back (OSCParameterInterface::createParameterTheOldWay (
         "reportLatency",
         "Report Latency to DAW",
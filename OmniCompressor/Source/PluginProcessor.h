@@ -25,6 +25,7 @@
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/Compressor.h"
 #include "../../resources/Delay.h"
+#include "../../resources/LinkedDetector.h"
 #include "../../resources/MaxRE.h"
 #include "../../resources/ambisonicTools.h"
 #include "../JuceLibraryCode/JuceHeader.h"
@@ -79,12 +80,14 @@ private:
     //==============================================================================
     Delay delay;
     LookAheadGainReduction grProcessing;
+    iem::LinkedDetector detector;
 
     juce::Array<float> RMS, allGR;
     juce::AudioBuffer<float> gains;
 
     float GR;
     std::atomic<float>* orderSetting;
+    std::atomic<float>* useSN3D;
     std::atomic<float>* threshold;
     std::atomic<float>* outGain;
     std::atomic<float>* ratio;
@@ -93,6 +96,8 @@ private:
     std::atomic<float>* knee;
     std::atomic<float>* lookAhead;
     std::atomic<float>* reportLatency;
+    std::atomic<float>* detectorOrder;
+    std::atomic<float>* rmsTime;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OmniCompressorAudioProcessor)
 };
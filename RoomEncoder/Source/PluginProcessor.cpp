@@ -113,7 +113,7 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
         oldDelay[i] = 44100 / 343.2f * interpMult; //init oldRadius
         allGains[i] = 0.0f;
         juce::FloatVectorOperations::clear (SHcoeffsOld[i], 64);
-        juce::FloatVectorOperations::clear ((float*) &SHsampleOld[i], 64);
+        juce::FloatVectorOperations::clear (SHsampleOld[i], 64);
     }
 
     lowShelfCoefficients = IIR::Coefficients<float>::makeLowShelf (
@@ -127,18 +127,11 @@ RoomEncoderAudioProcessor::RoomEncoderAudioProcessor() :
         0.707f,
         juce::Decibels::decibelsToGain (highShelfGain->load()));
 
-    lowShelfArray.clear();
-    highShelfArray.clear();
-
-    for (int o = 0; o < maxOrderImgSrc; ++o)
+    for (auto& filter : shelfFilters)
     {
-        lowShelfArray.add (new juce::OwnedArray<IIR::Filter<IIRfloat>>);
-        highShelfArray.add (new juce::OwnedArray<IIR::Filter<IIRfloat>>);
-        for (int i = 0; i < 16; ++i)
-        {
-            lowShelfArray[o]->add (new IIR::Filter<IIRfloat> (lowShelfCoefficients));
-            highShelfArray[o]->add (new IIR::Filter<IIRfloat> (highShelfCoefficients));
-        }
+        filter.prepare (64, 2);
+        filter.setCoefficients (0, *lowShelfCoefficients);
+        filter.setCoefficients (1, *highShelfCoefficients);
     }
 
     startTimer (50);
@@ -265,24 +258,10 @@ void RoomEncoderAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     readOffset = 0;
     bufferReadIdx = 0;
 
-    interleavedData.clear();
+    for (auto& filter : shelfFilters)
+        filter.reset();
 
-    for (int i = 0; i < 16; ++i)
-    {
-        for (int o = 0; o < maxOrderImgSrc; ++o)
-        {
-            lowShelfArray[o]->getUnchecked (i)->reset (IIRfloat (0.0f));
-            highShelfArray[o]->getUnchecked (i)->reset (IIRfloat (0.0f));
-        }
-
-        interleavedData.add (
-            new juce::dsp::AudioBlock<IIRfloat> (interleavedBlockData[i], 1, samplesPerBlock));
-        //interleavedData.getLast()->clear(); // broken in JUCE 5.4.5
-        clear (*interleavedData.getLast());
-    }
-
-    zero = juce::dsp::AudioBlock<float> (zeroData, IIRfloat_elements, samplesPerBlock);
-    zero.clear();
+    sampledSignal.setSize (1, samplesPerBlock);
 
     updateFv = true;
 
@@ -400,6 +379,12 @@ void RoomEncoderAudioProcessor::updateFilterCoefficients (double sampleRate)
         0.707f,
         juce::Decibels::decibelsToGain (highShelfGain->load()));
 
+    for (auto& filter : shelfFilters)
+    {
+        filter.setCoefficients (0, *lowShelfCoefficients);
+        filter.setCoefficients (1, *highShelfCoefficients);
+    }
+
     userChangedFilterSettings = false;
     updateFv = true;
 }
@@ -447,10 +432,8 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
 
     const bool doInputSn3dToN3dConversion = *inputIsSN3D > 0.5f;
 
-    float* pBufferWrite = buffer.getWritePointer (0);
-    const float* pBufferRead = buffer.getReadPointer (0);
-
-    const int nSIMDFilters = 1 + (maxNChIn - 1) / IIRfloat_elements;
+    float* pSampledWrite = sampledSignal.getWritePointer (0);
+    const float* pSampledRead = sampledSignal.getReadPointer (0);
 
     const auto delayBufferWritePtrArray = delayBuffer.getArrayOfWritePointers();
 
@@ -461,57 +444,6 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     if (userChangedFilterSettings)
         updateFilterCoefficients (sampleRate);
 
-    using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
-
-    //interleave input data
-    int partial = maxNChIn % IIRfloat_elements;
-    if (partial == 0)
-    {
-        for (int i = 0; i < nSIMDFilters; ++i)
-        {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
-        }
-    }
-    else
-    {
-        int i;
-        for (i = 0; i < nSIMDFilters - 1; ++i)
-        {
-            juce::AudioData::interleaveSamples (
-                juce::AudioData::NonInterleavedSource<Format> { buffer.getArrayOfReadPointers()
-                                                                    + i * IIRfloat_elements,
-                                                                IIRfloat_elements },
-                juce::AudioData::InterleavedDest<Format> {
-                    reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                    IIRfloat_elements },
-                L);
-        }
-
-        const float* addr[IIRfloat_elements];
-        size_t ch;
-        for (ch = 0; ch < partial; ++ch)
-        {
-            addr[ch] = buffer.getReadPointer (i * static_cast<int> (IIRfloat_elements + ch));
-        }
-        for (; ch < IIRfloat_elements; ++ch)
-        {
-            addr[ch] = zero.getChannelPointer (ch);
-        }
-        juce::AudioData::interleaveSamples (
-            juce::AudioData::NonInterleavedSource<Format> { addr, IIRfloat_elements },
-            juce::AudioData::InterleavedDest<Format> {
-                reinterpret_cast<float*> (interleavedData[i]->getChannelPointer (0)),
-                IIRfloat_elements },
-            L);
-    }
-
     int currNumRefl = juce::roundToInt (numRefl->load());
     int workingNumRefl = (currNumRefl < _numRefl) ? _numRefl : currNumRefl;
 
@@ -588,78 +520,28 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         const int idx = filterPoints.indexOf (q);
         if (idx != -1)
         {
-            for (int i = 0; i < nSIMDFilters; ++i)
-            {
-                const IIRfloat* chPtr[1];
-                chPtr[0] = interleavedData[i]->getChannelPointer (0);
-                juce::dsp::AudioBlock<IIRfloat> ab (const_cast<IIRfloat**> (chPtr), 1, L);
-                juce::dsp::ProcessContextReplacing<IIRfloat> context (ab);
-
-                lowShelfArray[idx]->getUnchecked (i)->process (context);
-                highShelfArray[idx]->getUnchecked (i)->process (context);
-            }
+            // the filters are applied cumulatively, in place on the input channels
+            shelfFilters[idx].process (buffer.getArrayOfWritePointers(), maxNChIn, L);
         }
 
         // ========================================   CALCULATE SAMPLED MONO SIGNALS
-        /* JMZ:
-         * the following section is broken, as it hardcodes asumptions about how
-         * many floats can be stored in IIRfloat
-         */
-        IIRfloat SHsample[16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements
-        IIRfloat SHsampleStep[16];
-#if JUCE_USE_SIMD
-        juce::FloatVectorOperations::clear ((float*) &SHsample->value,
-                                            IIRfloat_elements * sizeof (SHsample)
-                                                / sizeof (*SHsample));
-        SHEval (directivityOrder,
-                smx[q],
-                smy[q],
-                smz[q],
-                (float*) &SHsample->value,
-                false); // deoding -> false
-#else /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::clear ((float*) SHsample,
-                                            IIRfloat_elements * sizeof (SHsample)
-                                                / sizeof (*SHsample));
-        SHEval (directivityOrder,
-                smx[q],
-                smy[q],
-                smz[q],
-                (float*) SHsample,
-                false); // deoding -> false
-#endif /* JUCE_USE_SIMD */
+        float SHsample[64];
+        juce::FloatVectorOperations::clear (SHsample, 64);
+        SHEval (directivityOrder, smx[q], smy[q], smz[q], SHsample, false); // deoding -> false
 
         if (doInputSn3dToN3dConversion)
-            juce::FloatVectorOperations::multiply ((float*) SHsample, sn3d2n3d, maxNChIn);
+            juce::FloatVectorOperations::multiply (SHsample, sn3d2n3d, maxNChIn);
 
-        juce::Array<IIRfloat*> interleavedDataPtr;
-        interleavedDataPtr.resize (nSIMDFilters);
-        IIRfloat** intrlvdDataArrayPtr = interleavedDataPtr.getRawDataPointer();
-
-        for (int i = 0; i < nSIMDFilters; ++i)
+        // directivity weighting with coefficients ramped over the block, channel by channel
+        juce::FloatVectorOperations::clear (pSampledWrite, L);
+        for (int ch = 0; ch < maxNChIn; ++ch)
         {
-            intrlvdDataArrayPtr[i] =
-                reinterpret_cast<IIRfloat*> (interleavedData[i]->getChannelPointer (0));
-            SHsampleStep[i] = SHsample[i] - SHsampleOld[q][i];
-            SHsampleStep[i] *= oneOverL;
-            SHsample[i] = SHsampleOld[q][i];
-        }
+            const float* pIn = buffer.getReadPointer (ch);
+            const float start = SHsampleOld[q][ch];
+            const float step = (SHsample[ch] - start) * oneOverL;
 
-        for (int smpl = 0; smpl < L; ++smpl)
-        {
-            IIRfloat SIMDTemp;
-            SIMDTemp = 0.0f;
-
-            for (int i = 0; i < nSIMDFilters; ++i)
-            {
-                SIMDTemp += SHsample[i] * *(intrlvdDataArrayPtr[i]++);
-                SHsample[i] += SHsampleStep[i];
-            }
-#if JUCE_USE_SIMD
-            pBufferWrite[smpl] = SIMDTemp.sum();
-#else /* !JUCE_USE_SIMD */
-            pBufferWrite[smpl] = SIMDTemp;
-#endif /* JUCE_USE_SIMD */
+            for (int smpl = 0; smpl < L; ++smpl)
+                pSampledWrite[smpl] += (start + step * static_cast<float> (smpl)) * pIn[smpl];
         }
 
         // ============================================
@@ -685,7 +567,7 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
 
         float* tempWritePtr =
             pMonoBufferWrite; //reset writePtr as it gets increased during the next for loop
-        const float* readPtr = pBufferRead;
+        const float* readPtr = pSampledRead;
 
         double tempDelay =
             oldDelay[q]; //start from oldDelay and add delayStep after each iteration;
@@ -864,13 +746,7 @@ void RoomEncoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
         }
 
         juce::FloatVectorOperations::copy (SHcoeffsOld[q], SHcoeffs, maxNChOut);
-#if JUCE_USE_SIMD
-        juce::FloatVectorOperations::copy ((float*) &SHsampleOld[q]->value,
-                                           (float*) &SHsample->value,
-                                           maxNChIn);
-#else /* !JUCE_USE_SIMD */
-        juce::FloatVectorOperations::copy ((float*) SHsampleOld[q], (float*) SHsample, maxNChIn);
-#endif /* JUCE_USE_SIMD */
+        juce::FloatVectorOperations::copy (SHsampleOld[q], SHsample, maxNChIn);
         //oldDelay[q] = delay;
         oldDelay[q] = tempDelay;
     }
@@ -1082,11 +958,8 @@ void RoomEncoderAudioProcessor::updateBuffers()
 
     if (input.getSize() != input.getPreviousSize())
     {
-        for (int i = 0; i < interleavedData.size(); ++i)
-        {
-            //interleavedData[i]->clear(); // broken in JUCE 5.4.5
-            clear (*interleavedData[i]);
-        }
+        for (auto& filter : shelfFilters)
+            filter.reset();
     }
 }
 
@@ -1478,16 +1351,6 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
     return params;
 }
 
-inline void RoomEncoderAudioProcessor::clear (juce::dsp::AudioBlock<IIRfloat>& ab)
-{
-    const int N = static_cast<int> (ab.getNumSamples()) * IIRfloat_elements;
-    const int nCh = static_cast<int> (ab.getNumChannels());
-
-    for (int ch = 0; ch < nCh; ++ch)
-        juce::FloatVectorOperations::clear (reinterpret_cast<float*> (ab.getChannelPointer (ch)),
-                                            N);
-}
-
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -27,6 +27,7 @@
 #include "../../resources/AudioProcessorBase.h"
 #include "../../resources/ambisonicTools.h"
 #include "../../resources/customComponents/FilterVisualizer.h"
+#include "../../resources/BiquadBank.h"
 #include "../../resources/efficientSHvanilla.h"
 #include "../../resources/interpLagrangeWeights.h"
 #include "../JuceLibraryCode/JuceHeader.h"
@@ -37,14 +38,6 @@
     #include <Accelerate/Accelerate.h>
 #endif
 
-#if JUCE_USE_SIMD
-using IIRfloat = juce::dsp::SIMDRegister<float>;
-static constexpr int IIRfloat_elements = juce::dsp::SIMDRegister<float>::size();
-#else /* !JUCE_USE_SIMD */
-using IIRfloat = float;
-static constexpr int IIRfloat_elements = 1;
-#endif /* JUCE_USE_SIMD */
-
 #define ProcessorClass RoomEncoderAudioProcessor
 
 const int mSig[] = { 1, -1 };
@@ -156,9 +149,6 @@ public:
     juce::Atomic<bool> repaintPositionPlanes = true;
 
 private:
-    //==============================================================================
-    inline void clear (juce::dsp::AudioBlock<IIRfloat>& ab);
-
     bool readingSharedParams = false;
     ;
 
@@ -210,13 +200,8 @@ private:
 
     juce::SharedResourcePointer<SharedParams> sharedParams;
 
-    //SIMD IIR Filter
-
-    juce::OwnedArray<juce::OwnedArray<IIR::Filter<IIRfloat>>> lowShelfArray;
-    juce::OwnedArray<juce::OwnedArray<IIR::Filter<IIRfloat>>> highShelfArray;
-    juce::HeapBlock<char> interleavedBlockData[16], zeroData; //todo: dynamically?
-    juce::OwnedArray<juce::dsp::AudioBlock<IIRfloat>> interleavedData;
-    juce::dsp::AudioBlock<float> zero;
+    // low- and high-shelf, one cascade per filter point
+    iem::BiquadBank shelfFilters[maxOrderImgSrc];
 
     juce::Array<int> filterPoints { 1, 7, 25, 61, 113, 169, 213 };
 
@@ -238,10 +223,11 @@ private:
     double dist2smpls;
 
     float SHcoeffsOld[nImgSrc][64];
-    IIRfloat SHsampleOld[nImgSrc][16]; //TODO: can be smaller: (N+1)^2/IIRfloat_elements()
+    float SHsampleOld[nImgSrc][64];
 
     juce::AudioBuffer<float> delayBuffer;
     juce::AudioBuffer<float> monoBuffer;
+    juce::AudioBuffer<float> sampledSignal;
 
     juce::OwnedArray<ReflectionProperty> reflectionList;
 
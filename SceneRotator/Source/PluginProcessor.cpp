@@ -321,86 +321,6 @@ void SceneRotatorAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     midiMessages.clear();
 }
 
-double SceneRotatorAudioProcessor::P (int i,
-                                      int l,
-                                      int a,
-                                      int b,
-                                      juce::dsp::Matrix<float>& R1,
-                                      juce::dsp::Matrix<float>& Rlm1)
-{
-    double ri1 = R1 (i + 1, 2);
-    double rim1 = R1 (i + 1, 0);
-    double ri0 = R1 (i + 1, 1);
-
-    if (b == -l)
-        return ri1 * Rlm1 (a + l - 1, 0) + rim1 * Rlm1 (a + l - 1, 2 * l - 2);
-    else if (b == l)
-        return ri1 * Rlm1 (a + l - 1, 2 * l - 2) - rim1 * Rlm1 (a + l - 1, 0);
-    else
-        return ri0 * Rlm1 (a + l - 1, b + l - 1);
-};
-
-double SceneRotatorAudioProcessor::U (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
-{
-    return P (0, l, m, n, Rone, Rlm1);
-}
-
-double SceneRotatorAudioProcessor::V (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
-{
-    if (m == 0)
-    {
-        auto p0 = P (1, l, 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, -1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m > 0)
-    {
-        auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-        if (m == 1) // d = 1;
-            return p0 * sqrt (2);
-        else // d = 0;
-            return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
-    }
-    else
-    {
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        if (m == -1) // d = 1;
-            return p1 * sqrt (2);
-        else // d = 0;
-            return p1 + P (1, l, m + 1, n, Rone, Rlm1);
-    }
-}
-
-double SceneRotatorAudioProcessor::W (int l,
-                                      int m,
-                                      int n,
-                                      juce::dsp::Matrix<float>& Rone,
-                                      juce::dsp::Matrix<float>& Rlm1)
-{
-    if (m > 0)
-    {
-        auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
-        return p0 + p1;
-    }
-    else if (m < 0)
-    {
-        auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
-        auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
-        return p0 - p1;
-    }
-
-    return 0.0;
-}
-
 void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
 {
     const auto yawRadians =
@@ -449,50 +369,7 @@ void SceneRotatorAudioProcessor::calcRotationMatrix (const int order)
         rotMat (2, 2) = cb * cy;
     }
 
-    auto Rl = orderMatrices[1];
-
-    Rl->operator() (0, 0) = rotMat (1, 1);
-    Rl->operator() (0, 1) = rotMat (1, 2);
-    Rl->operator() (0, 2) = rotMat (1, 0);
-    Rl->operator() (1, 0) = rotMat (2, 1);
-    Rl->operator() (1, 1) = rotMat (2, 2);
-    Rl->operator() (1, 2) = rotMat (2, 0);
-    Rl->operator() (2, 0) = rotMat (0, 1);
-    Rl->operator() (2, 1) = rotMat (0, 2);
-    Rl->operator() (2, 2) = rotMat (0, 0);
-
-    for (int l = 2; l <= order; ++l)
-    {
-        auto Rone = orderMatrices[1];
-        auto Rlm1 = orderMatrices[l - 1];
-        auto Rl = orderMatrices[l];
-        for (int m = -l; m <= l; ++m)
-        {
-            for (int n = -l; n <= l; ++n)
-            {
-                const int d = (m == 0) ? 1 : 0;
-                double denom;
-                if (abs (n) == l)
-                    denom = (2 * l) * (2 * l - 1);
-                else
-                    denom = l * l - n * n;
-
-                double u = sqrt ((l * l - m * m) / denom);
-                double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom)
-                           * (1.0 - 2.0 * d) * 0.5;
-                double w = sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
-
-                if (u != 0.0)
-                    u *= U (l, m, n, *Rone, *Rlm1);
-                if (v != 0.0)
-                    v *= V (l, m, n, *Rone, *Rlm1);
-                if (w != 0.0)
-                    w *= W (l, m, n, *Rone, *Rlm1);
-
-                Rl->operator() (m + l, n + l) = u + v + w;
-            }
-        }
-    }
+    SHRotation::calcRotationMatrices (rotMat, orderMatrices, order);
 
     rotationParamsHaveChanged = false;
 }
@@ -28,6 +28,7 @@
 #include "../../resources/Conversions.h"
 #include "../../resources/Quaternion.h"
 #include "../../resources/ReferenceCountedMatrix.h"
+#include "../../resources/SHRotation.h"
 
 #define ProcessorClass SceneRotatorAudioProcessor
 
@@ -150,16 +151,6 @@ private:
     juce::OwnedArray<juce::dsp::Matrix<float>> orderMatrices;
     juce::OwnedArray<juce::dsp::Matrix<float>> orderMatricesCopy;
 
-    double P (int i,
-              int l,
-              int a,
-              int b,
-              juce::dsp::Matrix<float>& R1,
-              juce::dsp::Matrix<float>& Rlm1);
-    double U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-    double W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1);
-
     void timerCallback() override;
 
     // ============ MIDI Device Connection ======================
@@ -0,0 +1,286 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "../../resources/BiquadBank.h"
+#include "../../resources/LinkwitzRileyCrossover.h"
+#include <JuceHeader.h>
+
+/**
+ Bass management of the SimpleDecoder: the omni signal gets low-passed and routed to one or more
+ discrete subwoofers (each with its own gain and delay) or to all loudspeakers (virtual subwoofer),
+ the main signals get high-passed, both with 4th order Linkwitz-Riley filters.
+ Everything is allocated for 64 channels in prepare(), so the audio thread never allocates. New
+ settings are posted from any non-realtime thread and picked up lock-free at the start of the
+ next block. As the high-pass is linear and time-invariant, it can be applied to either the
+ Ambisonic input or the decoded loudspeaker signals, the caller chooses whichever has fewer
+ channels with getFilterDomain().
+ */
+class BassManagement
+{
+public:
+    static constexpr int maxNumChannels = 64;
+    static constexpr int maxNumSubwoofers = 4;
+    static constexpr float maxDelayInSeconds = 0.05f;
+
+    enum class Mode
+    {
+        none,
+        discrete,
+        virtualSubwoofer
+    };
+
+    enum class Domain
+    {
+        ambisonic,
+        loudspeakers
+    };
+
+    struct Settings
+    {
+        Mode mode = Mode::none;
+        float highPassFrequency = 80.0f;
+        float lowPassFrequency = 80.0f;
+        float lowPassGain = 1.0f;
+
+        int numSubwoofers = 0;
+        int channels[maxNumSubwoofers] = {}; // zero-based output channels
+        float gains[maxNumSubwoofers] = {};
+        float delaysInSeconds[maxNumSubwoofers] = {};
+    };
+
+    BassManagement() : fifo (fifoSize) {}
+
+    void prepare (const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+
+        highPass.prepare (maxNumChannels, 2);
+        highPass.setCoefficientRamping (true);
+        lowPass.prepare (1, 2);
+        lowPass.setCoefficientRamping (true);
+
+        bassBuffer.setSize (1, static_cast<int> (spec.maximumBlockSize));
+
+        delayLength = static_cast<int> (std::ceil (maxDelayInSeconds * sampleRate))
+                      + static_cast<int> (spec.maximumBlockSize);
+        delayLine.setSize (1, delayLength);
+
+        // the audio thread isn't running, so take over the latest settings directly
+        {
+            const juce::SpinLock::ScopedLockType lock (producerLock);
+            fifo.reset();
+            settings = latestSettings;
+        }
+
+        updateFilters();
+        reset();
+    }
+
+    void reset()
+    {
+        highPass.reset();
+        lowPass.reset();
+        delayLine.clear();
+        writePosition = 0;
+    }
+
+    /** Posts new settings to the audio thread, don't call this from the audio thread. */
+    void postSettings (const Settings& newSettings)
+    {
+        const juce::SpinLock::ScopedLockType lock (producerLock);
+        latestSettings = newSettings;
+
+        // the queue only runs full while the audio thread is stopped, prepare() catches up then
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+        if (size1 > 0)
+            messages[static_cast<size_t> (start1)] = newSettings;
+        fifo.finishedWrite (size1);
+    }
+
+    /** Applies the most recent posted settings, call this at the start of each block. */
+    void pullSettings()
+    {
+        bool changed = false;
+        while (fifo.getNumReady() > 0)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+            if (size2 > 0)
+                settings = messages[static_cast<size_t> (start2 + size2 - 1)];
+            else if (size1 > 0)
+                settings = messages[static_cast<size_t> (start1 + size1 - 1)];
+            fifo.finishedRead (size1 + size2);
+            changed = true;
+        }
+
+        if (changed)
+            updateFilters();
+    }
+
+    const Settings& getSettings() const { return settings; }
+
+    bool isActive() const { return settings.mode != Mode::none; }
+
+    /**
+     Chooses the domain for the high-pass, the Ambisonic or the loudspeaker signals, whichever
+     has fewer channels. The filter states get cleared when the domain changes.
+     */
+    Domain getFilterDomain (const int numAmbisonicChannels, const int numLoudspeakerChannels)
+    {
+        const auto newDomain = numLoudspeakerChannels < numAmbisonicChannels
+                                   ? Domain::loudspeakers
+                                   : Domain::ambisonic;
+        if (newDomain != domain)
+        {
+            domain = newDomain;
+            highPass.reset();
+        }
+
+        return domain;
+    }
+
+    /** Low-passes the omni signal scaled by gain, call this before the signals get altered. */
+    void extractBass (const float* omni, const float gain, const int numSamples)
+    {
+        auto* bass = bassBuffer.getWritePointer (0);
+        juce::FloatVectorOperations::multiply (bass, omni, gain * settings.lowPassGain, numSamples);
+        lowPass.process (bassBuffer.getArrayOfWritePointers(), 1, numSamples);
+    }
+
+    void applyHighPass (float* const* channels, const int numChannels, const int numSamples)
+    {
+        highPass.process (channels, juce::jmin (numChannels, maxNumChannels), numSamples);
+    }
+
+    /**
+     Writes the bass signal into the subwoofer channels (discrete mode, replacing their content)
+     or adds it to the loudspeaker channels (virtual mode).
+     */
+    void addBass (juce::AudioBuffer<float>& buffer,
+                  const juce::Array<int>& loudspeakerChannels,
+                  const int numSamples)
+    {
+        const auto* bass = bassBuffer.getReadPointer (0);
+
+        if (settings.mode == Mode::virtualSubwoofer)
+        {
+            for (int i = loudspeakerChannels.size(); --i >= 0;)
+            {
+                const int destCh = loudspeakerChannels.getUnchecked (i);
+                if (destCh < buffer.getNumChannels())
+                    buffer.addFrom (destCh, 0, bass, numSamples);
+            }
+        }
+        else if (settings.mode == Mode::discrete)
+        {
+            // one delay line for all subwoofers, each of them reads it with its own delay
+            auto* line = delayLine.getWritePointer (0);
+            writeToDelayLine (line, bass, numSamples);
+
+            for (int sw = 0; sw < settings.numSubwoofers; ++sw)
+            {
+                const int destCh = settings.channels[sw];
+                if (destCh >= buffer.getNumChannels())
+                    continue;
+
+                const int delay = juce::jlimit (
+                    0,
+                    delayLength - numSamples,
+                    juce::roundToInt (settings.delaysInSeconds[sw] * sampleRate));
+                readFromDelayLine (line,
+                                   buffer.getWritePointer (destCh),
+                                   delay,
+                                   settings.gains[sw],
+                                   numSamples);
+            }
+        }
+
+        writePosition = (writePosition + numSamples) % delayLength;
+    }
+
+private:
+    static constexpr int fifoSize = 16;
+
+    void writeToDelayLine (float* line, const float* source, const int numSamples)
+    {
+        const int size1 = juce::jmin (numSamples, delayLength - writePosition);
+        juce::FloatVectorOperations::copy (line + writePosition, source, size1);
+        juce::FloatVectorOperations::copy (line, source + size1, numSamples - size1);
+    }
+
+    void readFromDelayLine (const float* line,
+                            float* dest,
+                            const int delay,
+                            const float gain,
+                            const int numSamples)
+    {
+        int readPosition = writePosition - delay;
+        if (readPosition < 0)
+            readPosition += delayLength;
+
+        const int size1 = juce::jmin (numSamples, delayLength - readPosition);
+        juce::FloatVectorOperations::multiply (dest, line + readPosition, gain, size1);
+        juce::FloatVectorOperations::multiply (dest + size1, line, gain, numSamples - size1);
+    }
+
+    /**
+     4th order Linkwitz-Riley (LR4) low- and high-pass: the same 2nd order Butterworth section
+     applied twice, computed without allocating. Both are -6 dB at their cutoff, so with equal
+     frequencies they sum up flat (not +3 dB as a 4th order Butterworth crossover would).
+     */
+    void updateFilters()
+    {
+        const auto makeCrossover = [this] (const float frequency)
+        {
+            return iem::LinkwitzRileyCrossover::makeCrossover (
+                sampleRate,
+                juce::jlimit (10.0, 0.45 * sampleRate, static_cast<double> (frequency)));
+        };
+
+        const auto hp = makeCrossover (settings.highPassFrequency).highPass;
+        const auto lp = makeCrossover (settings.lowPassFrequency).lowPass;
+        for (int s = 0; s < 2; ++s)
+        {
+            highPass.setCoefficients (s, hp);
+            lowPass.setCoefficients (s, lp);
+        }
+    }
+
+    double sampleRate = 48000.0;
+
+    Settings settings;
+    juce::AbstractFifo fifo;
+    std::array<Settings, fifoSize> messages;
+    juce::SpinLock producerLock;
+    Settings latestSettings;
+
+    iem::BiquadBank highPass, lowPass;
+    Domain domain = Domain::ambisonic;
+
+    juce::AudioBuffer<float> bassBuffer;
+    juce::AudioBuffer<float> delayLine;
+    int delayLength = 1;
+    int writePosition = 0;
+};
@@ -21,6 +21,7 @@
  */
 
 #pragma once
+#include "../../resources/customComponents/ReverseSlider.h"
 #include "ReferenceCountedDecoder.h"
 #include "ambisonicTools.h"
 
@@ -43,6 +44,24 @@ public:
             new juce::AudioProcessorValueTreeState::ComboBoxAttachment (parameters,
                                                                         "weights",
                                                                         cbWeights));
+
+        addAndMakeVisible (tbDualBand);
+        tbDualBand.setButtonText ("dual-band");
+        tbDualBand.setColour (juce::ToggleButton::tickColourId, juce::Colours::orange);
+        tbDualBandAttachment.reset (
+            new juce::AudioProcessorValueTreeState::ButtonAttachment (parameters,
+                                                                      "dualBand",
+                                                                      tbDualBand));
+        tbDualBand.onClick = [this]() { updateEnablement(); };
+
+        addAndMakeVisible (slCrossover);
+        slCrossoverAttachment.reset (
+            new ReverseSlider::SliderAttachment (parameters, "crossoverFrequency", slCrossover));
+        slCrossover.setSliderStyle (juce::Slider::LinearHorizontal);
+        slCrossover.setTextBoxStyle (juce::Slider::TextBoxRight, false, 45, valueHeight);
+        slCrossover.setTextValueSuffix (" Hz");
+
+        updateEnablement();
     }
 
     ~DecoderInfoBox() {}
@@ -50,10 +69,10 @@ public:
     void setDecoderConfig (ReferenceCountedDecoder::Ptr newDecoderConfig)
     {
         decoder = newDecoderConfig;
-        if (decoder == nullptr)
-            cbWeights.setVisible (false);
-        else
-            cbWeights.setVisible (true);
+        const bool decoderLoaded = decoder != nullptr;
+        cbWeights.setVisible (decoderLoaded);
+        tbDualBand.setVisible (decoderLoaded);
+        slCrossover.setVisible (decoderLoaded);
 
         resized();
         repaint();
@@ -95,6 +114,14 @@ public:
                 arr.getBoundingBox (juce::jmax (0, arr.getNumGlyphs() - 1), 1, true).getBottom();
 
             cbWeights.setBounds (valueStart, descriptionEnd + 2 * valueHeight + 2, 80, valueHeight);
+            tbDualBand.setBounds (valueStart + 85,
+                                  descriptionEnd + 2 * valueHeight + 2,
+                                  80,
+                                  valueHeight);
+            slCrossover.setBounds (valueStart,
+                                   descriptionEnd + 3 * valueHeight + 4,
+                                   juce::jmin (valueWidth, 165),
+                                   valueHeight);
         }
     }
 
@@ -175,6 +202,12 @@ public:
                         maxAttributeWidth,
                         valueHeight,
                         juce::Justification::bottomRight);
+            g.drawText ("CROSSOVER:",
+                        0,
+                        descEnd + 3 * valueHeight + 2,
+                        maxAttributeWidth,
+                        valueHeight,
+                        juce::Justification::bottomRight);
 
             g.setFont (valueHeight);
             g.drawText (getOrderString (retainedDecoder->getOrder()),
@@ -199,9 +232,23 @@ public:
     }
 
 private:
+    /** With dual-band decoding the weights are fixed: basic below, max-rE above the crossover. */
+    void updateEnablement()
+    {
+        const bool dualBand = tbDualBand.getToggleState();
+        cbWeights.setEnabled (! dualBand);
+        slCrossover.setEnabled (dualBand);
+    }
+
     juce::ComboBox cbWeights;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> cbWeightsAttachment;
 
+    juce::ToggleButton tbDualBand;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> tbDualBandAttachment;
+
+    ReverseSlider slCrossover;
+    std::unique_ptr<ReverseSlider::SliderAttachment> slCrossoverAttachment;
+
     juce::String errorText { "" };
     ReferenceCountedDecoder::Ptr decoder { nullptr };
 
@@ -46,8 +46,11 @@ SimpleDecoderAudioProcessorEditor::SimpleDecoderAudioProcessorEditor (
     addAndMakeVisible (&footer);
     // ============= END: essentials ========================
 
-    valueTreeState.addParameterListener ("swChannel", this);
     valueTreeState.addParameterListener ("swMode", this);
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+        valueTreeState.addParameterListener (
+            SimpleDecoderAudioProcessor::getSubwooferChannelID (sw),
+            this);
 
     // create the connection between title component's comboBoxes and parameters
     cbOrderSettingAttachment.reset (
@@ -164,8 +167,11 @@ SimpleDecoderAudioProcessorEditor::SimpleDecoderAudioProcessorEditor (
 
 SimpleDecoderAudioProcessorEditor::~SimpleDecoderAudioProcessorEditor()
 {
-    valueTreeState.removeParameterListener ("swChannel", this);
     valueTreeState.removeParameterListener ("swMode", this);
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+        valueTreeState.removeParameterListener (
+            SimpleDecoderAudioProcessor::getSubwooferChannelID (sw),
+            this);
     juce::ModalComponentManager::getInstance()->cancelAllModalComponents();
     setLookAndFeel (nullptr);
 }
@@ -297,7 +303,7 @@ void SimpleDecoderAudioProcessorEditor::timerCallback()
             if (swMode == 1)
                 neededChannels =
                     juce::jmax (currentDecoder->getNumOutputChannels(),
-                                (int) *valueTreeState.getRawParameterValue ("swChannel"));
+                                processor.getHighestSubwooferChannel());
             else
                 neededChannels = currentDecoder->getNumOutputChannels();
 
@@ -317,7 +323,7 @@ void SimpleDecoderAudioProcessorEditor::timerCallback()
         int neededChannels = 0;
         if (swMode == 1)
             neededChannels = juce::jmax (currentDecoder->getNumOutputChannels(),
-                                         (int) *valueTreeState.getRawParameterValue ("swChannel"));
+                                         processor.getHighestSubwooferChannel());
         else
             neededChannels = currentDecoder->getNumOutputChannels();
 
@@ -388,7 +394,7 @@ void SimpleDecoderAudioProcessorEditor::loadPresetFile()
 void SimpleDecoderAudioProcessorEditor::parameterChanged (const juce::String& parameterID,
                                                           float newValue)
 {
-    if (parameterID == "swChannel" || parameterID == "swMode")
+    if (parameterID.startsWith ("swChannel") || parameterID == "swMode")
     {
         ReferenceCountedDecoder::Ptr currentDecoder = processor.getCurrentDecoderConfig();
         if (currentDecoder != nullptr)
@@ -398,7 +404,7 @@ void SimpleDecoderAudioProcessorEditor::parameterChanged (const juce::String& pa
             if (swMode == 1)
                 neededChannels =
                     juce::jmax (currentDecoder->getNumOutputChannels(),
-                                (int) *valueTreeState.getRawParameterValue ("swChannel"));
+                                processor.getHighestSubwooferChannel());
             else
                 neededChannels = currentDecoder->getNumOutputChannels();
 
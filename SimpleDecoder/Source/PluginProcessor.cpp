@@ -47,9 +47,6 @@ SimpleDecoderAudioProcessor::SimpleDecoderAudioProcessor() :
     cascadedLowPassCoeffs = IIR::Coefficients<double>::makeLowPass (48000.0, 100.0f);
     cascadedHighPassCoeffs = IIR::Coefficients<double>::makeHighPass (48000.0, 100.0f);
 
-    lowPassCoeffs = IIR::Coefficients<float>::makeHighPass (48000.0, 100.0f);
-    highPassCoeffs = IIR::Coefficients<float>::makeFirstOrderHighPass (48000.0, 100.0f);
-
     // get pointers to the parameters
     inputOrderSetting = parameters.getRawParameterValue ("inputOrderSetting");
     useSN3D = parameters.getRawParameterValue ("useSN3D");
@@ -59,8 +56,16 @@ SimpleDecoderAudioProcessor::SimpleDecoderAudioProcessor() :
     highPassFrequency = parameters.getRawParameterValue ("highPassFrequency");
 
     swMode = parameters.getRawParameterValue ("swMode");
-    swChannel = parameters.getRawParameterValue ("swChannel");
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+    {
+        const juce::String suffix (sw + 1);
+        swChannel[sw] = parameters.getRawParameterValue (getSubwooferChannelID (sw));
+        swGain[sw] = parameters.getRawParameterValue ("swGain" + suffix);
+        swDelay[sw] = parameters.getRawParameterValue ("swDelay" + suffix);
+    }
     weights = parameters.getRawParameterValue ("weights");
+    dualBand = parameters.getRawParameterValue ("dualBand");
+    crossoverFrequency = parameters.getRawParameterValue ("crossoverFrequency");
 
     // add listeners to parameter changes
 
@@ -76,6 +81,14 @@ SimpleDecoderAudioProcessor::SimpleDecoderAudioProcessor() :
     parameters.addParameterListener ("swMode", this);
     parameters.addParameterListener ("weights", this);
 
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+    {
+        const juce::String suffix (sw + 1);
+        parameters.addParameterListener (getSubwooferChannelID (sw), this);
+        parameters.addParameterListener ("swGain" + suffix, this);
+        parameters.addParameterListener ("swDelay" + suffix, this);
+    }
+
     highPassSpecs.numChannels = 0;
 
     // global settings for all plug-in instances
@@ -88,12 +101,7 @@ SimpleDecoderAudioProcessor::SimpleDecoderAudioProcessor() :
     properties.reset (new juce::PropertiesFile (options));
     lastDir = juce::File (properties->getValue ("presetFolder"));
 
-    // filters
-    highPass1.state = highPassCoeffs;
-    highPass2.state = highPassCoeffs;
-
-    lowPass1.reset (new IIR::Filter<float> (lowPassCoeffs));
-    lowPass2.reset (new IIR::Filter<float> (lowPassCoeffs));
+    postBassManagementSettings();
 }
 
 SimpleDecoderAudioProcessor::~SimpleDecoderAudioProcessor()
@@ -103,7 +111,6 @@ SimpleDecoderAudioProcessor::~SimpleDecoderAudioProcessor()
 void SimpleDecoderAudioProcessor::updateLowPassCoefficients (double sampleRate, float frequency)
 {
     frequency = juce::jmin (static_cast<float> (0.5 * sampleRate), frequency);
-    *lowPassCoeffs = *IIR::Coefficients<float>::makeLowPass (sampleRate, frequency);
 
     auto newCoeffs = IIR::Coefficients<double>::makeLowPass (sampleRate, frequency);
     newCoeffs->coefficients =
@@ -116,7 +123,6 @@ void SimpleDecoderAudioProcessor::updateLowPassCoefficients (double sampleRate,
 void SimpleDecoderAudioProcessor::updateHighPassCoefficients (double sampleRate, float frequency)
 {
     frequency = juce::jmin (static_cast<float> (0.5 * sampleRate), frequency);
-    *highPassCoeffs = *IIR::Coefficients<float>::makeHighPass (sampleRate, frequency);
 
     auto newCoeffs = IIR::Coefficients<double>::makeHighPass (sampleRate, frequency);
     newCoeffs->coefficients =
@@ -241,9 +247,6 @@ void SimpleDecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesP
 {
     checkInputAndOutput (this, *inputOrderSetting, 0, true);
 
-    swBuffer.setSize (1, samplesPerBlock);
-    swBuffer.clear();
-
     juce::dsp::ProcessSpec specs;
     specs.sampleRate = sampleRate;
     specs.maximumBlockSize = samplesPerBlock;
@@ -255,8 +258,6 @@ void SimpleDecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     ReferenceCountedDecoder::Ptr currentDecoder = decoder.getCurrentDecoder();
     if (currentDecoder != nullptr)
     {
-        highPassSpecs.numChannels = currentDecoder->getNumInputChannels();
-
         // calculate mean omni-signal-gain
         juce::dsp::Matrix<float>& decoderMatrix = currentDecoder->getMatrix();
         const int nLsps = (int) decoderMatrix.getNumRows();
@@ -273,17 +274,7 @@ void SimpleDecoderAudioProcessor::prepareToPlay (double sampleRate, int samplesP
     updateHighPassCoefficients (sampleRate, *highPassFrequency);
     updateLowPassCoefficients (sampleRate, *lowPassFrequency);
 
-    highPass1.prepare (highPassSpecs);
-    highPass1.reset();
-
-    highPass2.prepare (highPassSpecs);
-    highPass2.reset();
-
-    lowPass1->prepare (highPassSpecs);
-    lowPass1->reset();
-
-    lowPass2->prepare (highPassSpecs);
-    lowPass2->reset();
+    bassManagement.prepare (specs);
 
     masterGain.setRampDurationSeconds (0.1f);
     masterGain.prepare ({ sampleRate, static_cast<juce::uint32> (samplesPerBlock), 1 });
@@ -309,25 +300,10 @@ void SimpleDecoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     const bool newDecoderWasAvailable = decoder.checkIfNewDecoderAvailable();
     ReferenceCountedDecoder::Ptr retainedDecoder = decoder.getCurrentDecoder();
 
+    // the subwoofer parameters of a new decoder are set by loadConfigFromString() on the
+    // message thread, only the omni gain is updated here
     if (newDecoderWasAvailable && retainedDecoder != nullptr)
     {
-        highPassSpecs.numChannels = decoder.getCurrentDecoder()->getNumInputChannels();
-        highPass1.prepare (highPassSpecs);
-        highPass2.prepare (highPassSpecs);
-        if (decoder.getCurrentDecoder()->getSettings().subwooferChannel != -1)
-        {
-            parameters.getParameter ("swChannel")
-                ->setValueNotifyingHost (
-                    parameters.getParameterRange ("swChannel")
-                        .convertTo0to1 (
-                            decoder.getCurrentDecoder()->getSettings().subwooferChannel));
-            parameters.getParameter ("swMode")->setValueNotifyingHost (
-                parameters.getParameterRange ("swMode").convertTo0to1 (1)); //discrete
-        }
-        else
-            parameters.getParameter ("swMode")->setValueNotifyingHost (
-                parameters.getParameterRange ("swMode").convertTo0to1 (0)); // off
-
         // calculate mean omni-signal-gain
         juce::dsp::Matrix<float>& decoderMatrix = retainedDecoder->getMatrix();
         const int nLsps = (int) decoderMatrix.getNumRows();
@@ -351,49 +327,39 @@ void SimpleDecoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
                                   input.getNumberOfChannels());
     const int nChOut =
         juce::jmin (retainedDecoder->getNumOutputChannels(), buffer.getNumChannels());
-    const int swProcessing = *swMode;
+    const int L = buffer.getNumSamples();
 
     for (int ch = juce::jmax (nChIn, nChOut); ch < buffer.getNumChannels();
          ++ch) // clear all not needed channels
-        buffer.clear (ch, 0, buffer.getNumSamples());
+        buffer.clear (ch, 0, L);
 
-    if (swProcessing > 0)
+    // =================== bass management (before decoding) =====================
+    bassManagement.pullSettings();
+    const auto& bassSettings = bassManagement.getSettings();
+    const bool bassManagementActive = bassManagement.isActive();
+    auto highPassDomain = BassManagement::Domain::ambisonic;
+
+    if (bassManagementActive)
     {
-        swBuffer.copyFrom (0, 0, buffer, 0, 0, buffer.getNumSamples());
-        float correction = sqrt ((static_cast<float> (retainedDecoder->getOrder()) + 1));
-
-        if (swProcessing == 1) // subwoofer-mode: discrete
-            correction *= sqrt (
-                (float) nChOut); // correction for only one subwoofer instead of nChOut loudspeakers
-
-        swBuffer.applyGain (omniGain * correction);
-
-        // low pass filtering
-        juce::dsp::AudioBlock<float> lowPassAudioBlock = juce::dsp::AudioBlock<float> (swBuffer);
-        juce::dsp::ProcessContextReplacing<float> lowPassContext (lowPassAudioBlock);
-        lowPass1->process (lowPassContext);
-        lowPass2->process (lowPassContext);
-        swBuffer.applyGain (0,
-                            0,
-                            swBuffer.getNumSamples(),
-                            juce::Decibels::decibelsToGain (lowPassGain->load()));
-
-        juce::dsp::AudioBlock<float> highPassAudioBlock =
-            juce::dsp::AudioBlock<float> (buffer.getArrayOfWritePointers(),
-                                          nChIn,
-                                          buffer.getNumSamples());
-        juce::dsp::ProcessContextReplacing<float> highPassContext (highPassAudioBlock);
-        highPass1.process (highPassContext);
-        highPass2.process (highPassContext);
-    }
+        float correction = std::sqrt (static_cast<float> (retainedDecoder->getOrder()) + 1);
+
+        // correction for only a few subwoofers instead of nChOut loudspeakers
+        if (bassSettings.mode == BassManagement::Mode::discrete)
+            correction *= std::sqrt (static_cast<float> (nChOut)
+                                     / juce::jmax (1, bassSettings.numSubwoofers));
+
+        bassManagement.extractBass (buffer.getReadPointer (0), omniGain * correction, L);
 
-    // update current weights setting
-    auto settings = retainedDecoder->getSettings();
-    settings.weights = ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load()));
-    retainedDecoder->setSettings (settings);
+        // high-pass whichever has fewer channels, the Ambisonic or the loudspeaker signals
+        highPassDomain = bassManagement.getFilterDomain (nChIn, nChOut);
+        if (highPassDomain == BassManagement::Domain::ambisonic)
+            bassManagement.applyHighPass (buffer.getArrayOfWritePointers(), nChIn, L);
+    }
 
     // ambisonic decoding
-    const int L = buffer.getNumSamples();
+    decoder.setWeights (ReferenceCountedDecoder::Weights (juce::roundToInt (weights->load())));
+    decoder.setDualBand (*dualBand >= 0.5f, *crossoverFrequency);
+
     auto inputAudioBlock =
         juce::dsp::AudioBlock<float> (buffer.getArrayOfWritePointers(), nChIn, L);
     auto outputAudioBlock =
@@ -401,26 +367,17 @@ void SimpleDecoderAudioProcessor::processBlock (juce::AudioSampleBuffer& buffer,
     decoder.process (inputAudioBlock, outputAudioBlock);
 
     for (int ch = nChOut; ch < nChIn; ++ch) // clear all not needed channels
-        buffer.clear (ch, 0, buffer.getNumSamples());
+        buffer.clear (ch, 0, L);
 
-    // =================== subwoofer processing ==================================
-    if (swProcessing == 1)
+    // =================== bass management (after decoding) ======================
+    if (bassManagementActive)
     {
-        const int swCh = ((int) *swChannel) - 1;
-        if (swCh < buffer.getNumChannels())
-            buffer.copyFrom (swCh, 0, swBuffer, 0, 0, buffer.getNumSamples());
-    }
+        if (highPassDomain == BassManagement::Domain::loudspeakers)
+            bassManagement.applyHighPass (buffer.getArrayOfWritePointers(), nChOut, L);
 
-    else if (swProcessing == 2) // virtual subwoofer
-    {
-        juce::Array<int>& rArray = decoder.getCurrentDecoder()->getRoutingArrayReference();
-        for (int ch = rArray.size(); --ch >= 0;)
-        {
-            const int destCh = rArray.getUnchecked (ch);
-            if (destCh < buffer.getNumChannels())
-                buffer.addFrom (destCh, 0, swBuffer, 0, 0, buffer.getNumSamples());
-        }
+        bassManagement.addBass (buffer, retainedDecoder->getRoutingArrayReference(), L);
     }
+
     // =================== Master Gain =========================================
     const float overallGainInDecibels = *parameters.getRawParameterValue ("overallGain");
     masterGain.setGainDecibels (overallGainInDecibels);
@@ -518,14 +475,17 @@ void SimpleDecoderAudioProcessor::parameterChanged (const juce::String& paramete
     else if (parameterID == "highPassFrequency")
     {
         updateHighPassCoefficients (highPassSpecs.sampleRate, *highPassFrequency);
+        postBassManagementSettings();
     }
     else if (parameterID == "lowPassFrequency")
     {
         updateLowPassCoefficients (highPassSpecs.sampleRate, *lowPassFrequency);
+        postBassManagementSettings();
     }
     else if (parameterID == "lowPassGain")
     {
         guiUpdateLowPassGain = true;
+        postBassManagementSettings();
     }
     else if (parameterID == "useSN3D")
     {
@@ -533,6 +493,44 @@ void SimpleDecoderAudioProcessor::parameterChanged (const juce::String& paramete
                                            ? ReferenceCountedDecoder::Normalization::sn3d
                                            : ReferenceCountedDecoder::Normalization::n3d);
     }
+    else if (parameterID == "swMode" || parameterID.startsWith ("swChannel")
+             || parameterID.startsWith ("swGain") || parameterID.startsWith ("swDelay"))
+    {
+        postBassManagementSettings();
+    }
+}
+
+void SimpleDecoderAudioProcessor::postBassManagementSettings()
+{
+    BassManagement::Settings newSettings;
+    newSettings.mode = BassManagement::Mode (juce::roundToInt (swMode->load()));
+    newSettings.highPassFrequency = *highPassFrequency;
+    newSettings.lowPassFrequency = *lowPassFrequency;
+    newSettings.lowPassGain = juce::Decibels::decibelsToGain (lowPassGain->load());
+
+    // subwoofers with channel number 0 are switched off
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+    {
+        const int channel = juce::roundToInt (swChannel[sw]->load());
+        if (channel < 1)
+            continue;
+
+        const int i = newSettings.numSubwoofers++;
+        newSettings.channels[i] = channel - 1;
+        newSettings.gains[i] = juce::Decibels::decibelsToGain (swGain[sw]->load());
+        newSettings.delaysInSeconds[i] = 0.001f * swDelay[sw]->load();
+    }
+
+    bassManagement.postSettings (newSettings);
+}
+
+int SimpleDecoderAudioProcessor::getHighestSubwooferChannel()
+{
+    int highestChannel = 0;
+    for (int sw = 0; sw < BassManagement::maxNumSubwoofers; ++sw)
+        highestChannel = juce::jmax (highestChannel, juce::roundToInt (swChannel[sw]->load()));
+
+    return highestChannel;
 }
 
 void SimpleDecoderAudioProcessor::updateBuffers()
@@ -564,23 +562,49 @@ void SimpleDecoderAudioProcessor::loadConfigFromString (juce::String configStrin
 
     lastConfigString = configString;
 
-    juce::var parsedJson;
-    juce::Result result = juce::JSON::parse (configString, parsedJson);
-
-    if (result.failed())
+    // instances loading the same configuration share one decoder, which is loaded only once
+    const auto sourceHash = ConfigurationHelper::getContentHash (configString);
+    bool isValidJson = true;
+    ReferenceCountedDecoder::Ptr tempDecoder = registry->getOrCreate<ReferenceCountedDecoder> (
+        sourceHash,
+        [&]
+        {
+            // recalling a session usually finds the decoder in the binary cache
+            ReferenceCountedDecoder::Ptr newDecoder =
+                ConfigurationHelper::readDecoderFromBinaryCache (sourceHash);
+
+            if (newDecoder == nullptr)
+            {
+                juce::var parsedJson;
+                juce::Result result = juce::JSON::parse (configString, parsedJson);
+
+                if (result.failed())
+                {
+                    isValidJson = false;
+                    return newDecoder;
+                }
+
+                result = ConfigurationHelper::parseVarForDecoder (parsedJson, &newDecoder);
+                if (result.failed())
+                    messageForEditor = result.getErrorMessage();
+                else
+                    ConfigurationHelper::writeDecoderToBinaryCache (*newDecoder, sourceHash);
+            }
+
+            // the decoder is shared from now on and mustn't be altered anymore
+            if (newDecoder != nullptr)
+                newDecoder->removeAppliedWeights();
+
+            return newDecoder;
+        });
+
+    if (! isValidJson)
         return;
 
-    ReferenceCountedDecoder::Ptr tempDecoder = nullptr;
-
-    result = ConfigurationHelper::parseVarForDecoder (parsedJson, &tempDecoder);
-    if (result.failed())
-        messageForEditor = result.getErrorMessage();
-
     if (tempDecoder != nullptr)
     {
         messageForEditor = "";
 
-        tempDecoder->removeAppliedWeights();
         parameters.getParameterAsValue ("weights").setValue (
             static_cast<int> (tempDecoder->getSettings().weights));
     }
@@ -728,11 +752,72 @@ std::vector<std::unique_ptr<juce::RangedAudioParameter>>
         [] (float value) { return juce::String ((int) value); },
         nullptr));
 
+    for (int sw = 2; sw <= BassManagement::maxNumSubwoofers; ++sw)
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            getSubwooferChannelID (sw - 1),
+            "SW " + juce::String (sw) + " Channel Number",
+            "",
+            juce::NormalisableRange<float> (0.0f, 64.0f, 1.0f),
+            0.0f,
+            [] (float value)
+            {
+                if (value < 0.5f)
+                    return juce::String ("off");
+                else
+                    return juce::String ((int) value);
+            },
+            nullptr));
+
+    for (int sw = 1; sw <= BassManagement::maxNumSubwoofers; ++sw)
+    {
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "swGain" + juce::String (sw),
+            "SW " + juce::String (sw) + " Gain",
+            "dB",
+            juce::NormalisableRange<float> (-20.0f, 10.0f, 0.1f),
+            0.0f,
+            [] (float value) { return juce::String (value, 1); },
+            nullptr));
+
+        params.push_back (OSCParameterInterface::createParameterTheOldWay (
+            "swDelay" + juce::String (sw),
+            "SW " + juce::String (sw) + " Delay",
+            "ms",
+            juce::NormalisableRange<float> (0.0f, 50.0f, 0.1f),
+            0.0f,
+            [] (float value) { return juce::String (value, 1); },
+            nullptr));
+    }
+
     params.push_back (std::make_unique<juce::AudioParameterChoice> ("weights",
                                                                     "Ambisonic Weights",
                                                                     weightsStrings,
                                                                     1));
 
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "dualBand",
+        "Dual-Band Decoding",
+        "",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 1.0f),
+        0.0f,
+        [] (float value)
+        {
+            if (value >= 0.5f)
+                return "on";
+            else
+                return "off";
+        },
+        nullptr));
+
+    params.push_back (OSCParameterInterface::createParameterTheOldWay (
+        "crossoverFrequency",
+        "Dual-Band Crossover Frequency",
+        "Hz",
+        juce::NormalisableRange<float> (100.0f, 2000.0f, 1.0f, 0.5f),
+        400.0f,
+        [] (float value) { return juce::String ((int) value); },
+        nullptr));
+
     params.push_back (std::make_unique<juce::AudioParameterFloat> (
         "overallGain",
         "Overall Gain",
@@ -24,6 +24,7 @@
 
 #include "../../resources/AmbisonicDecoder.h"
 #include "../../resources/AudioProcessorBase.h"
+#include "../../resources/ConfigurationRegistry.h"
 #include <JuceHeader.h>
 
 #define CONFIGURATIONHELPER_ENABLE_DECODER_METHODS 1
@@ -31,6 +32,7 @@
 
 #include "../../resources/FilterVisualizerHelper.h"
 #include "../../resources/ReferenceCountedDecoder.h"
+#include "BassManagement.h"
 
 #define ProcessorClass SimpleDecoderAudioProcessor
 
@@ -90,6 +92,16 @@ public:
 
     ReferenceCountedDecoder::Ptr getCurrentDecoderConfig() { return decoderConfig; }
 
+    /** Returns the highest (one-based) output channel used by a discrete subwoofer. */
+    int getHighestSubwooferChannel();
+
+    /** The first subwoofer keeps the parameter ID of the single-subwoofer versions. */
+    static juce::String getSubwooferChannelID (const int subwooferIndex)
+    {
+        return subwooferIndex == 0 ? juce::String ("swChannel")
+                                   : "swChannel" + juce::String (subwooferIndex + 1);
+    }
+
     IIR::Coefficients<double>::Ptr cascadedHighPassCoeffs, cascadedLowPassCoeffs;
     juce::Atomic<bool> guiUpdateLowPassCoefficients = true;
     juce::Atomic<bool> guiUpdateHighPassCoefficients = true;
@@ -102,6 +114,7 @@ private:
     void updateHighPassCoefficients (double sampleRate, float frequency);
 
     void loadConfigFromString (juce::String string);
+    void postBassManagementSettings();
 
     // list of used audio parameters
     std::atomic<float>* inputOrderSetting;
@@ -111,8 +124,12 @@ private:
     std::atomic<float>* highPassFrequency;
 
     std::atomic<float>* swMode;
-    std::atomic<float>* swChannel;
+    std::atomic<float>* swChannel[BassManagement::maxNumSubwoofers];
+    std::atomic<float>* swGain[BassManagement::maxNumSubwoofers];
+    std::atomic<float>* swDelay[BassManagement::maxNumSubwoofers];
     std::atomic<float>* weights;
+    std::atomic<float>* dualBand;
+    std::atomic<float>* crossoverFrequency;
 
     // =========================================
 
@@ -124,16 +141,8 @@ private:
 
     std::unique_ptr<juce::PropertiesFile> properties;
 
-    juce::AudioBuffer<float> swBuffer;
-
     // processors
-    std::unique_ptr<IIR::Filter<float>> lowPass1;
-    std::unique_ptr<IIR::Filter<float>> lowPass2;
-    IIR::Coefficients<float>::Ptr highPassCoeffs;
-    IIR::Coefficients<float>::Ptr lowPassCoeffs;
-
-    ProcessorDuplicator<IIR::Filter<float>, IIR::Coefficients<float>> highPass1;
-    ProcessorDuplicator<IIR::Filter<float>, IIR::Coefficients<float>> highPass2;
+    BassManagement bassManagement;
 
     juce::dsp::Gain<float> masterGain;
 
@@ -142,6 +151,7 @@ private:
     AmbisonicDecoder decoder;
 
     ReferenceCountedDecoder::Ptr decoderConfig { nullptr };
+    juce::SharedResourcePointer<ConfigurationRegistry> registry;
     juce::String messageForEditor { "" };
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleDecoderAudioProcessor)
@@ -23,6 +23,8 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "ConfigurationRegistry.h"
+#include "LinkwitzRileyCrossover.h"
 #include "MatrixMultiplication.h"
 #include "MaxRE.h"
 #include "ReferenceCountedDecoder.h"
@@ -34,14 +36,29 @@ class AmbisonicDecoder
 public:
     AmbisonicDecoder() {}
 
+    ~AmbisonicDecoder() { releaseRetiredDecoders(); }
+
     void prepare (const juce::dsp::ProcessSpec& newSpec)
     {
         spec = newSpec;
         matMult.prepare (newSpec, false); // we let do this class do the buffering
+        matMultLowBand.prepare (newSpec, false);
+        matMultHighBand.prepare (newSpec, false);
 
         buffer.setSize (buffer.getNumChannels(), spec.maximumBlockSize);
         buffer.clear();
 
+        const int blockSize = static_cast<int> (spec.maximumBlockSize);
+        lowBand.setSize (64, blockSize);
+        highBand.setSize (64, blockSize);
+        highBandOutput.setSize (64, blockSize);
+        singleBandOutput.setSize (64, blockSize);
+
+        crossover.prepare (64, 2);
+        crossover.setCrossover (0, makeCrossover (spec.sampleRate, crossoverFrequency));
+        crossover.setCoefficientRamping (true);
+        lastCrossoverFrequency = crossoverFrequency;
+
         checkIfNewDecoderAvailable();
     }
 
@@ -50,6 +67,37 @@ public:
         inputNormalization = newNormalization;
     }
 
+    /**
+     Overrides the weights setting of the decoders, so the decoder objects don't have to be
+     altered while they are in use. Can be called from any thread.
+     */
+    void setWeights (ReferenceCountedDecoder::Weights newWeights)
+    {
+        weightsOverride = static_cast<int> (newWeights);
+    }
+
+    /**
+     Enables dual-band decoding: basic weights below and max-rE weights above the crossover
+     frequency, regardless of the decoder's weights setting. The Ambisonic input signals are split
+     with a 4th order Linkwitz-Riley crossover, so both bands sum up to an all-pass, and each band
+     is decoded with its own compiled matrix. Frequency changes are interpolated across a block,
+     switching dual-band decoding on or off crossfades both decodings across the next block.
+     Call this from the audio thread, before process().
+     */
+    void setDualBand (const bool shouldBeEnabled, const float newCrossoverFrequency)
+    {
+        if (shouldBeEnabled != dualBand)
+        {
+            if (shouldBeEnabled)
+                crossover.reset();
+
+            crossfadeDualBand = true;
+        }
+
+        dualBand = shouldBeEnabled;
+        crossoverFrequency = newCrossoverFrequency;
+    }
+
     /**
      Decodes the Ambisonic input signals to loudspeaker signals using the current decoder.
      This method takes care of buffering the input data, so inputBlock and outputBlock are
@@ -59,96 +107,248 @@ public:
     {
         checkIfNewDecoderAvailable();
 
-        ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
-
-        auto& T = retainedDecoder->getMatrix();
+        CompiledDecoder::Ptr retainedCompiled = currentCompiled;
+        if (retainedCompiled == nullptr)
+        {
+            outputBlock.clear();
+            return;
+        }
 
-        const int nInputChannels = juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
-                                               static_cast<int> (T.getNumColumns()));
+        const int nInputChannels =
+            juce::jmin (static_cast<int> (inputBlock.getNumChannels()),
+                        retainedCompiled->decoder->getNumInputChannels());
         const int nSamples = static_cast<int> (inputBlock.getNumSamples());
 
-        // copy input data to buffer
-        for (int ch = 0; ch < nInputChannels; ++ch)
-            buffer.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
+        if (nInputChannels < 1)
+        {
+            outputBlock.clear();
+            return;
+        }
 
-        juce::dsp::AudioBlock<float> ab (buffer.getArrayOfWritePointers(),
-                                         nInputChannels,
-                                         0,
-                                         nSamples);
-        processInternal (ab, outputBlock);
-    }
+        // pick the pre-compiled matrix for the current weights, input order and normalization
+        const int order = isqrt (nInputChannels) - 1;
+        const int chAmbi = juce::square (order + 1);
+        const int weightsIndex = weightsOverride.load();
+        const auto weights = weightsIndex < 0 ? retainedCompiled->decoder->getSettings().weights
+                                              : ReferenceCountedDecoder::Weights (weightsIndex);
+        auto* compiledMatrix = retainedCompiled->get (weights, inputNormalization, order);
+        if (matMult.getMatrix() != compiledMatrix)
+            matMult.setMatrix (compiledMatrix, true);
 
-    const bool checkIfNewDecoderAvailable()
-    {
-        if (newDecoderAvailable)
+        const bool crossfade = crossfadeDualBand;
+        crossfadeDualBand = false;
+
+        if (! dualBand && ! crossfade)
         {
-            newDecoderAvailable = false;
-            currentDecoder = newDecoder;
-            newDecoder = nullptr;
+            // copy input data to buffer
+            for (int ch = 0; ch < chAmbi; ++ch)
+                buffer.copyFrom (ch, 0, inputBlock.getChannelPointer (ch), nSamples);
+
+            juce::dsp::AudioBlock<float> ab (buffer.getArrayOfWritePointers(),
+                                             chAmbi,
+                                             0,
+                                             nSamples);
+            matMult.processNonReplacing (ab, outputBlock, false);
+            return;
+        }
 
-            if (currentDecoder != nullptr)
+        const int nOutputChannels = static_cast<int> (outputBlock.getNumChannels());
+
+        // the single-band decoding is faded out or in, the input is still untouched here
+        juce::dsp::AudioBlock<float> singleBandBlock (singleBandOutput.getArrayOfWritePointers(),
+                                                      nOutputChannels,
+                                                      0,
+                                                      nSamples);
+        if (crossfade)
+            matMult.processNonReplacing (
+                inputBlock.getSubsetChannelBlock (0, static_cast<size_t> (chAmbi)),
+                singleBandBlock,
+                false);
+
+        auto* lowBandMatrix = retainedCompiled->get (ReferenceCountedDecoder::Weights::none,
+                                                     inputNormalization,
+                                                     order);
+        if (matMultLowBand.getMatrix() != lowBandMatrix)
+            matMultLowBand.setMatrix (lowBandMatrix, true);
+
+        auto* highBandMatrix = retainedCompiled->get (ReferenceCountedDecoder::Weights::maxrE,
+                                                      inputNormalization,
+                                                      order);
+        if (matMultHighBand.getMatrix() != highBandMatrix)
+            matMultHighBand.setMatrix (highBandMatrix, true);
+
+        if (crossoverFrequency != lastCrossoverFrequency)
+        {
+            crossover.setCrossover (0, makeCrossover (spec.sampleRate, crossoverFrequency));
+            lastCrossoverFrequency = crossoverFrequency;
+        }
+
+        // the band buffers already decouple input and output, no need to copy the input
+        const float* inputChannels[64];
+        for (int ch = 0; ch < chAmbi; ++ch)
+            inputChannels[ch] = inputBlock.getChannelPointer (ch);
+
+        float* const* bands[2] = { lowBand.getArrayOfWritePointers(),
+                                   highBand.getArrayOfWritePointers() };
+        crossover.process (inputChannels, bands, chAmbi, nSamples);
+
+        juce::dsp::AudioBlock<float> lowBlock (lowBand.getArrayOfWritePointers(),
+                                               chAmbi,
+                                               0,
+                                               nSamples);
+        juce::dsp::AudioBlock<float> highBlock (highBand.getArrayOfWritePointers(),
+                                                chAmbi,
+                                                0,
+                                                nSamples);
+        juce::dsp::AudioBlock<float> highOutputBlock (highBandOutput.getArrayOfWritePointers(),
+                                                      nOutputChannels,
+                                                      0,
+                                                      nSamples);
+
+        matMultLowBand.processNonReplacing (lowBlock, outputBlock, false);
+        matMultHighBand.processNonReplacing (highBlock, highOutputBlock, false);
+        outputBlock.add (highOutputBlock);
+
+        if (! crossfade)
+            return;
+
+        // linear crossfade from the previous to the current decoding
+        const float increment = 1.0f / nSamples;
+        for (int ch = 0; ch < nOutputChannels; ++ch)
+        {
+            float* output = outputBlock.getChannelPointer (static_cast<size_t> (ch));
+            const float* single = singleBandOutput.getReadPointer (ch);
+            for (int i = 0; i < nSamples; ++i)
             {
-                currentDecoder->removeAppliedWeights();
-                const int cols = (int) currentDecoder->getMatrix().getNumColumns();
-                buffer.setSize (cols, buffer.getNumSamples());
+                const float ramp = (i + 1) * increment;
+                const float dualBandGain = dualBand ? ramp : 1.0f - ramp;
+                output[i] = single[i] + dualBandGain * (output[i] - single[i]);
             }
+        }
+    }
+
+    /** Takes over a decoder passed to setDecoder(), call this from the audio thread. */
+    const bool checkIfNewDecoderAvailable()
+    {
+        if (! newDecoderAvailable.load (std::memory_order_acquire))
+            return false;
+
+        // setDecoder() only holds the lock while handing over, try again with the next block
+        const juce::SpinLock::ScopedTryLockType handOverLock (newCompiledLock);
+        if (! handOverLock.isLocked())
+            return false;
 
-            matMult.setMatrix (currentDecoder, true);
-            return true;
+        newDecoderAvailable = false;
+        retire (currentCompiled);
+        currentCompiled = newCompiled;
+        newCompiled = nullptr;
+
+        if (currentCompiled != nullptr)
+        {
+            currentDecoder = currentCompiled->decoder;
+            const int cols = (int) currentDecoder->getMatrix().getNumColumns();
+            buffer.setSize (cols, buffer.getNumSamples());
         }
-        return false;
+        else
+            currentDecoder = nullptr;
+
+        matMult.setMatrix (nullptr, true);
+        matMultLowBand.setMatrix (nullptr, true);
+        matMultHighBand.setMatrix (nullptr, true);
+        return true;
     };
 
-    /** Giving the AmbisonicDecoder a new decoder for the audio processing. Note: The AmbisonicDecoder will call the removeAppliedWeights() of the ReferenceCountedDecoder before it processes audio! The matrix elements may change due to this method.
+    /** Giving the AmbisonicDecoder a new decoder for the audio processing. The decoder's weights, the energy correction and the normalization conversion are folded into one matrix per input order and input normalization right here, so call this method from a non-realtime thread. Note: The AmbisonicDecoder will call the removeAppliedWeights() of the ReferenceCountedDecoder! The matrix elements may change due to this method.
+     Any non-realtime thread may call this, also concurrently: SimpleDecoder calls it from the message thread, AllRADecoder from the background thread of its DecoderCalculator. The calls are serialized, the audio thread picks up the latest decoder at the start of the next block without waiting.
      */
     void setDecoder (ReferenceCountedDecoder::Ptr newDecoderToUse)
     {
-        newDecoder = newDecoderToUse;
-        newDecoderAvailable = true;
+        const juce::ScopedLock setDecoderLock (settingDecoder);
+
+        releaseRetiredDecoders();
+
+        CompiledDecoder::Ptr compiled;
+        if (newDecoderToUse != nullptr)
+            compiled = getOrCompile (newDecoderToUse);
+
+        CompiledDecoder::Ptr replacedCompiled; // a decoder which wasn't picked up gets freed here
+        {
+            const juce::SpinLock::ScopedLockType handOverLock (newCompiledLock);
+            replacedCompiled = newCompiled;
+            newCompiled = compiled;
+            newDecoderAvailable.store (true, std::memory_order_release);
+        }
     }
 
     ReferenceCountedDecoder::Ptr getCurrentDecoder() { return currentDecoder; }
 
     /** Checks if a new decoder waiting to be used.
      */
-    const bool isNewDecoderWaiting() { return newDecoderAvailable; }
+    const bool isNewDecoderWaiting() { return newDecoderAvailable.load(); }
 
 private:
     /**
-     Decodes the Ambisonic input signals to loudspeaker signals using the current decoder. Keep in mind that the input data will be changed!
+     Holds the effective matrices of a decoder, one for each weights setting, input normalization and input order up to the decoder's order. Each of them has the weights, the energy correction and the normalization conversion folded into its columns, and the columns of higher orders truncated. All weights settings are compiled, as they can be changed while the decoder is in use.
      */
-    void processInternal (juce::dsp::AudioBlock<float> inputBlock,
-                          juce::dsp::AudioBlock<float> outputBlock)
+    struct CompiledDecoder : public juce::ReferenceCountedObject
     {
-        // you should call the processReplacing instead, it will buffer the input data
-        // this is a weak check, as e.g. if number channels differ, it won't trigger
-        jassert (inputBlock != outputBlock);
+        typedef juce::ReferenceCountedObjectPtr<CompiledDecoder> Ptr;
+
+        explicit CompiledDecoder (ReferenceCountedDecoder::Ptr decoderToCompile) :
+            decoder (decoderToCompile),
+            expectedNormalization (decoder->getSettings().expectedNormalization)
+        {
+            using Weights = ReferenceCountedDecoder::Weights;
+            using Normalization = ReferenceCountedDecoder::Normalization;
+
+            const int decoderOrder = decoder->getOrder();
+            for (auto w : { Weights::none, Weights::maxrE, Weights::inPhase })
+                for (auto n : { Normalization::n3d, Normalization::sn3d })
+                    for (int order = 0; order <= decoderOrder; ++order)
+                        matrices[static_cast<int> (w)][static_cast<int> (n)].add (
+                            compile (w, n, order, decoderOrder));
+        }
 
-        juce::ScopedNoDenormals noDenormals;
+        ReferenceCountedMatrix* get (ReferenceCountedDecoder::Weights weights,
+                                     ReferenceCountedDecoder::Normalization normalization,
+                                     const int order)
+        {
+            auto& forSettings = matrices[juce::jlimit (0, 2, static_cast<int> (weights))]
+                                        [static_cast<int> (normalization)];
+            return forSettings.getObjectPointerUnchecked (
+                juce::jlimit (0, forSettings.size() - 1, order));
+        }
+
+        bool matches (ReferenceCountedDecoder::Ptr& other)
+        {
+            return decoder == other
+                   && expectedNormalization == other->getSettings().expectedNormalization;
+        }
 
-        ReferenceCountedDecoder::Ptr retainedDecoder = currentDecoder;
+        ReferenceCountedDecoder::Ptr decoder;
+        const ReferenceCountedDecoder::Normalization expectedNormalization;
 
-        if (retainedDecoder != nullptr) // if decoder is available, do the pre-processing
+    private:
+        ReferenceCountedMatrix::Ptr compile (ReferenceCountedDecoder::Weights weightsType,
+                                             ReferenceCountedDecoder::Normalization normalization,
+                                             const int order,
+                                             const int decoderOrder)
         {
-            const int order = isqrt (static_cast<int> (inputBlock.getNumChannels())) - 1;
             const int chAmbi = juce::square (order + 1);
-            const int numSamples = static_cast<int> (inputBlock.getNumSamples());
 
             float weights[64];
-            const float correction =
-                std::sqrt (std::sqrt ((static_cast<float> (retainedDecoder->getOrder()) + 1)
-                                      / (static_cast<float> (order) + 1)));
+            const float correction = std::sqrt (std::sqrt (
+                (static_cast<float> (decoderOrder) + 1) / (static_cast<float> (order) + 1)));
             juce::FloatVectorOperations::fill (weights, correction, chAmbi);
 
-            if (retainedDecoder->getSettings().weights == ReferenceCountedDecoder::Weights::maxrE)
+            if (weightsType == ReferenceCountedDecoder::Weights::maxrE)
             {
                 multiplyMaxRE (order, weights);
                 juce::FloatVectorOperations::multiply (weights,
                                                        maxRECorrectionEnergy[order],
                                                        chAmbi);
             }
-            else if (retainedDecoder->getSettings().weights
-                     == ReferenceCountedDecoder::Weights::inPhase)
+            else if (weightsType == ReferenceCountedDecoder::Weights::inPhase)
             {
                 multiplyInPhase (order, weights);
                 juce::FloatVectorOperations::multiply (weights,
@@ -156,35 +356,141 @@ private:
                                                        chAmbi);
             }
 
-            if (retainedDecoder->getSettings().expectedNormalization != inputNormalization)
+            if (expectedNormalization != normalization)
             {
                 const float* conversionPtr (
-                    inputNormalization == ReferenceCountedDecoder::Normalization::sn3d ? sn3d2n3d
-                                                                                       : n3d2sn3d);
+                    normalization == ReferenceCountedDecoder::Normalization::sn3d ? sn3d2n3d
+                                                                                  : n3d2sn3d);
                 juce::FloatVectorOperations::multiply (weights, conversionPtr, chAmbi);
             }
 
-            for (int ch = 0; ch < chAmbi; ++ch)
-                juce::FloatVectorOperations::multiply (inputBlock.getChannelPointer (ch),
-                                                       weights[ch],
-                                                       numSamples);
+            auto& T = decoder->getMatrix();
+            const int nRows = static_cast<int> (T.getNumRows());
+
+            ReferenceCountedMatrix::Ptr compiled =
+                new ReferenceCountedMatrix (decoder->getName(),
+                                            decoder->getDescription(),
+                                            nRows,
+                                            chAmbi);
+            auto& C = compiled->getMatrix();
+            for (int row = 0; row < nRows; ++row)
+                for (int col = 0; col < chAmbi; ++col)
+                    C (row, col) = T (row, col) * weights[col];
+
+            compiled->getRoutingArrayReference() = decoder->getRoutingArrayReference();
+            compiled->analyseStructure();
+            return compiled;
         }
 
-        matMult.processNonReplacing (inputBlock, outputBlock);
+        juce::ReferenceCountedArray<ReferenceCountedMatrix> matrices[3][2];
+    };
+
+    /** The crossover with its frequency clipped to the range the decoder supports. */
+    static iem::LinkwitzRileyCrossover::Crossover makeCrossover (const double sampleRate,
+                                                                 const float frequency)
+    {
+        return iem::LinkwitzRileyCrossover::makeCrossover (
+            sampleRate,
+            juce::jlimit (20.0, 0.45 * sampleRate, static_cast<double> (frequency)));
+    }
+
+    CompiledDecoder::Ptr getOrCompile (ReferenceCountedDecoder::Ptr decoderToCompile)
+    {
+        for (int i = 0; i < compiledCache.size(); ++i)
+        {
+            auto* candidate = compiledCache.getUnchecked (i);
+            if (candidate->matches (decoderToCompile))
+            {
+                compiledCache.move (i, 0);
+                return candidate;
+            }
+        }
+
+        // other instances sharing the same decoder might have compiled it already
+        CompiledDecoder::Ptr compiled = registry->getOrCreateVariant<CompiledDecoder> (
+            decoderToCompile.get(),
+            [&]
+            {
+                decoderToCompile->removeAppliedWeights();
+                return CompiledDecoder::Ptr (new CompiledDecoder (decoderToCompile));
+            });
+
+        compiledCache.insert (0, compiled);
+        while (compiledCache.size() > maxNumCachedDecoders)
+            compiledCache.removeLast();
+
+        return compiled;
+    }
+
+    /**
+     Called on the audio thread before replacing the current decoder: it keeps a reference, so the
+     decoder (which might have been evicted from the cache meanwhile) doesn't get freed on the
+     audio thread. Retired decoders are released by the next call of setDecoder().
+     */
+    void retire (CompiledDecoder::Ptr& decoderToRetire)
+    {
+        if (decoderToRetire == nullptr)
+            return;
+
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToWrite (1, start1, size1, start2, size2);
+        if (size1 + size2 == 0)
+            return; // can't happen, every swap is preceded by a call of setDecoder()
+
+        auto* retired = decoderToRetire.get();
+        retired->incReferenceCount();
+        retiredDecoders[static_cast<size_t> (size1 > 0 ? start1 : start2)] = retired;
+        retiredFifo.finishedWrite (1);
+    }
+
+    void releaseRetiredDecoders()
+    {
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToRead (retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            retiredDecoders[static_cast<size_t> (start1 + i)]->decReferenceCount();
+        for (int i = 0; i < size2; ++i)
+            retiredDecoders[static_cast<size_t> (start2 + i)]->decReferenceCount();
+
+        retiredFifo.finishedRead (size1 + size2);
     }
 
-private:
     //==============================================================================
+    static constexpr int maxNumCachedDecoders = 4;
+    static constexpr int maxNumRetiredDecoders = 8;
+
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
     ReferenceCountedDecoder::Ptr currentDecoder { nullptr };
-    ReferenceCountedDecoder::Ptr newDecoder { nullptr };
-    bool newDecoderAvailable { false };
+    CompiledDecoder::Ptr currentCompiled { nullptr };
+
+    // hand-over from setDecoder() to the audio thread
+    juce::CriticalSection settingDecoder;
+    juce::SpinLock newCompiledLock;
+    CompiledDecoder::Ptr newCompiled { nullptr };
+    std::atomic<bool> newDecoderAvailable { false };
+
+    juce::ReferenceCountedArray<CompiledDecoder> compiledCache;
+
+    juce::AbstractFifo retiredFifo { maxNumRetiredDecoders };
+    std::array<CompiledDecoder*, maxNumRetiredDecoders> retiredDecoders {};
+    juce::SharedResourcePointer<ConfigurationRegistry> registry;
 
     juce::AudioBuffer<float> buffer;
 
     ReferenceCountedDecoder::Normalization inputNormalization {
         ReferenceCountedDecoder::Normalization::sn3d
     };
+    std::atomic<int> weightsOverride { -1 }; // -1: use the decoder's settings
 
     MatrixMultiplication matMult;
+
+    // dual-band decoding
+    bool dualBand { false };
+    bool crossfadeDualBand { false };
+    float crossoverFrequency { 400.0f };
+    float lastCrossoverFrequency { 400.0f };
+    iem::LinkwitzRileyCrossover crossover;
+    juce::AudioBuffer<float> lowBand, highBand, highBandOutput, singleBandOutput;
+    MatrixMultiplication matMultLowBand, matMultHighBand;
 };
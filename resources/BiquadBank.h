@@ -0,0 +1,497 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "SIMDDispatch.h"
+#include <JuceHeader.h>
+
+namespace iem
+{
+
+/**
+ A cascade of biquad sections (transposed direct form II), applied in place to planar
+ multichannel audio, all channels sharing the same coefficients.
+ The channels are processed in groups of numLanes: short tiles of each group are copied into a
+ small interleaved buffer on the stack, so the recursion runs vectorized across the channels
+ without interleaving the whole block. Missing channels of the last group are zero-padded inside
+ the tile, nothing gets allocated while processing.
+ Each tile runs through all active sections at once (sample by sample, with the states kept in
+ registers), disabled and identity sections are removed from the cascade when they are changed,
+ not while processing.
+ With coefficient ramping enabled, new coefficients are linearly interpolated sample by sample
+ across the next processed block instead of being switched at its start.
+ The kernel is compiled for each SIMD tier (see SIMDDispatch.h) and the widest one supported by the
+ CPU is selected in prepare(), so a group of 16 channels takes one AVX-512, two AVX2 or four SSE
+ registers. Groups with fewer channels only process the registers actually needed.
+ */
+class BiquadBank
+{
+public:
+    static constexpr int maxNumSections = 8;
+    static constexpr int numLanes = 16;
+    static constexpr int tileLength = 32;
+
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+        /** Takes over first and second order coefficients (already normalized by JUCE). */
+        static Coefficients fromIIRCoefficients (const juce::dsp::IIR::Coefficients<float>& c)
+        {
+            const auto* raw = c.coefficients.begin();
+            Coefficients result;
+            if (c.coefficients.size() == 3) // first order
+            {
+                result.b0 = raw[0];
+                result.b1 = raw[1];
+                result.a1 = raw[2];
+            }
+            else
+            {
+                jassert (c.coefficients.size() == 5);
+                result.b0 = raw[0];
+                result.b1 = raw[1];
+                result.b2 = raw[2];
+                result.a1 = raw[3];
+                result.a2 = raw[4];
+            }
+            return result;
+        }
+
+        /** Per-sample increment for getting from one set to another within numSteps samples. */
+        static Coefficients getStep (const Coefficients& from,
+                                     const Coefficients& to,
+                                     const int numSteps)
+        {
+            const float scale = 1.0f / static_cast<float> (juce::jmax (1, numSteps));
+            return { (to.b0 - from.b0) * scale,
+                     (to.b1 - from.b1) * scale,
+                     (to.b2 - from.b2) * scale,
+                     (to.a1 - from.a1) * scale,
+                     (to.a2 - from.a2) * scale };
+        }
+
+        Coefficients advancedBy (const Coefficients& step, const float numSteps) const
+        {
+            return { b0 + numSteps * step.b0,
+                     b1 + numSteps * step.b1,
+                     b2 + numSteps * step.b2,
+                     a1 + numSteps * step.a1,
+                     a2 + numSteps * step.a2 };
+        }
+    };
+
+    BiquadBank() {}
+    ~BiquadBank() {}
+
+    /** Allocates the filter states and selects the SIMD kernel, call this before processing. */
+    void prepare (const int maximumNumChannels, const int newNumSections)
+    {
+        setSIMDTier (getBestSIMDTier());
+
+        jassert (newNumSections <= maxNumSections);
+        numSections = juce::jlimit (0, maxNumSections, newNumSections);
+        numGroups = (maximumNumChannels + numLanes - 1) / numLanes;
+
+        // some extra space for aligning the states for SIMD loads
+        const int numStates = numSections * numGroups * 2 * numLanes;
+        states.allocate (static_cast<size_t> (numStates + alignment / sizeof (float)), true);
+        alignedStates = reinterpret_cast<float*> (
+            (reinterpret_cast<std::uintptr_t> (states.get()) + alignment - 1) & ~(alignment - 1));
+
+        for (auto& isActive : active)
+            isActive = false;
+        updateActiveSections();
+    }
+
+    /** Overrides the automatic selection, tiers which aren't compiled in fall back to generic. */
+    void setSIMDTier (const SIMDTier newTier)
+    {
+        tier = SIMDTier::generic;
+        processFunction = &BiquadBank::processGeneric;
+#if IEM_SIMD_AVX2
+        if (newTier == SIMDTier::avx2)
+        {
+            tier = newTier;
+            processFunction = &BiquadBank::processAVX2;
+        }
+#endif
+#if IEM_SIMD_AVX512
+        if (newTier == SIMDTier::avx512)
+        {
+            tier = newTier;
+            processFunction = &BiquadBank::processAVX512;
+        }
+#endif
+    }
+
+    SIMDTier getSIMDTier() const { return tier; }
+
+    /** Clears the states, pending coefficient ramps are skipped. */
+    void reset()
+    {
+        juce::FloatVectorOperations::clear (alignedStates, numSections * numGroups * 2 * numLanes);
+        for (int s = 0; s < maxNumSections; ++s)
+            rampStart[s] = coefficients[s];
+        isRamping = false;
+        updateActiveSections();
+    }
+
+    /** When enabled, changed coefficients get interpolated across the next processed block. */
+    void setCoefficientRamping (const bool shouldRamp)
+    {
+        rampingEnabled = shouldRamp;
+        if (! shouldRamp)
+            reset();
+    }
+
+    void setCoefficients (const int section, const Coefficients& newCoefficients)
+    {
+        jassert (juce::isPositiveAndBelow (section, maxNumSections));
+        if (rampingEnabled && enabled[section])
+            isRamping = true;
+        else
+            rampStart[section] = newCoefficients;
+
+        coefficients[section] = newCoefficients;
+        updateActiveSections();
+    }
+
+    void setCoefficients (const int section, const juce::dsp::IIR::Coefficients<float>& newCoeffs)
+    {
+        setCoefficients (section, Coefficients::fromIIRCoefficients (newCoeffs));
+    }
+
+    /** Disabled sections are skipped, their states are cleared when enabled again. */
+    void setEnabled (const int section, const bool shouldBeEnabled)
+    {
+        jassert (juce::isPositiveAndBelow (section, maxNumSections));
+        if (enabled[section] != shouldBeEnabled)
+        {
+            enabled[section] = shouldBeEnabled;
+            rampStart[section] = coefficients[section];
+            updateActiveSections();
+        }
+    }
+
+    int getNumActiveSections() const { return numActiveSections; }
+
+    void process (float* const* channels, const int numChannels, const int numSamples)
+    {
+        (this->*processFunction) (channels, numChannels, numSamples);
+
+        if (isRamping)
+        {
+            for (int s = 0; s < maxNumSections; ++s)
+                rampStart[s] = coefficients[s];
+            isRamping = false;
+            updateActiveSections();
+        }
+    }
+
+private:
+    using ProcessFunction = void (BiquadBank::*) (float* const*, const int, const int);
+
+    float* getState (const int section, const int group)
+    {
+        return alignedStates + (section * numGroups + group) * 2 * numLanes;
+    }
+
+    static bool isIdentity (const Coefficients& c)
+    {
+        return c.b0 == 1.0f && c.b1 == 0.0f && c.b2 == 0.0f && c.a1 == 0.0f && c.a2 == 0.0f;
+    }
+
+    /**
+     Compiles the list of sections to process, sections becoming active start from silence. Ramping
+     sections stay active until the ramp is finished.
+     */
+    void updateActiveSections()
+    {
+        numActiveSections = 0;
+        for (int s = 0; s < numSections; ++s)
+        {
+            const bool isActive =
+                enabled[s] && ! (isIdentity (coefficients[s]) && isIdentity (rampStart[s]));
+            if (isActive && ! active[s])
+                for (int g = 0; g < numGroups; ++g)
+                    juce::FloatVectorOperations::clear (getState (s, g), 2 * numLanes);
+
+            active[s] = isActive;
+            if (isActive)
+                activeSections[numActiveSections++] = s;
+        }
+    }
+
+    // the kernels are forced inline, so they get compiled with the target of the calling function
+    JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wpsabi")
+
+    template <typename SIMD>
+    forcedinline void processWith (float* const* channels,
+                                   const int numChannels,
+                                   const int numSamples)
+    {
+        static_assert (numLanes % SIMD::size == 0, "numLanes has to be a multiple of SIMD::size");
+        if (numActiveSections == 0)
+            return;
+
+        const int usedGroups = juce::jmin (numGroups, (numChannels + numLanes - 1) / numLanes);
+
+        // the coefficients used for the n-th sample of the block are rampStart + (n + 1) * step
+        Coefficients steps[maxNumSections];
+        if (isRamping)
+            for (int k = 0; k < numActiveSections; ++k)
+                steps[k] = Coefficients::getStep (rampStart[activeSections[k]],
+                                                  coefficients[activeSections[k]],
+                                                  numSamples);
+
+        for (int g = 0; g < usedGroups; ++g)
+        {
+            float* activeStates[maxNumSections];
+            for (int k = 0; k < numActiveSections; ++k)
+                activeStates[k] = getState (activeSections[k], g);
+
+            const int firstChannel = g * numLanes;
+            const int nLanes = juce::jmin (numLanes, numChannels - firstChannel);
+            const int numVectors = (nLanes + SIMD::size - 1) / SIMD::size;
+
+            for (int start = 0; start < numSamples; start += tileLength)
+            {
+                const int n = juce::jmin (tileLength, numSamples - start);
+                alignas (alignment) float tile[tileLength][numLanes];
+
+                for (int lane = 0; lane < nLanes; ++lane)
+                {
+                    const float* src = channels[firstChannel + lane] + start;
+                    for (int i = 0; i < n; ++i)
+                        tile[i][lane] = src[i];
+                }
+                for (int lane = nLanes; lane < numVectors * SIMD::size; ++lane)
+                    for (int i = 0; i < n; ++i)
+                        tile[i][lane] = 0.0f;
+
+                Coefficients tileCoefficients[maxNumSections];
+                for (int k = 0; k < numActiveSections; ++k)
+                {
+                    tileCoefficients[k] = rampStart[activeSections[k]];
+                    if (isRamping)
+                        tileCoefficients[k] =
+                            tileCoefficients[k].advancedBy (steps[k],
+                                                            static_cast<float> (start + 1));
+                }
+
+                if (isRamping)
+                    processCascade<SIMD, true> (tile,
+                                                n,
+                                                tileCoefficients,
+                                                steps,
+                                                activeStates,
+                                                numVectors);
+                else
+                    processCascade<SIMD, false> (tile,
+                                                 n,
+                                                 tileCoefficients,
+                                                 steps,
+                                                 activeStates,
+                                                 numVectors);
+
+                for (int lane = 0; lane < nLanes; ++lane)
+                {
+                    float* dest = channels[firstChannel + lane] + start;
+                    for (int i = 0; i < n; ++i)
+                        dest[i] = tile[i][lane];
+                }
+            }
+        }
+    }
+
+    /**
+     Dispatches to a kernel with a fixed number of sections and registers, so the loops get
+     unrolled and the states stay in registers.
+     */
+    template <typename SIMD,
+              bool ramp,
+              int maxNumActive = maxNumSections,
+              int maxNumVectors = numLanes / SIMD::size>
+    forcedinline void processCascade (float (*tile)[numLanes],
+                                      const int numSamples,
+                                      const Coefficients* activeCoefficients,
+                                      const Coefficients* steps,
+                                      float* const* activeStates,
+                                      const int numVectors) const
+    {
+        if constexpr (maxNumActive > 1)
+            if (numActiveSections < maxNumActive)
+                return processCascade<SIMD, ramp, maxNumActive - 1, maxNumVectors> (
+                    tile,
+                    numSamples,
+                    activeCoefficients,
+                    steps,
+                    activeStates,
+                    numVectors);
+        if constexpr (maxNumVectors > 1)
+            if (numVectors < maxNumVectors)
+                return processCascade<SIMD, ramp, maxNumActive, maxNumVectors - 1> (
+                    tile,
+                    numSamples,
+                    activeCoefficients,
+                    steps,
+                    activeStates,
+                    numVectors);
+
+        processCascadeFixed<SIMD, ramp, maxNumActive, maxNumVectors> (tile,
+                                                                      numSamples,
+                                                                      activeCoefficients,
+                                                                      steps,
+                                                                      activeStates);
+    }
+
+    template <typename SIMD, bool ramp, int numActive, int numVectors>
+    static forcedinline void processCascadeFixed (float (*tile)[numLanes],
+                                                  const int numSamples,
+                                                  const Coefficients* activeCoefficients,
+                                                  const Coefficients* steps,
+                                                  float* const* activeStates)
+    {
+        using Vector = typename SIMD::Vector;
+        Vector b0[numActive], b1[numActive], b2[numActive], a1[numActive], a2[numActive];
+        Vector s1[numActive][numVectors], s2[numActive][numVectors];
+
+        // only used when ramping
+        [[maybe_unused]] Vector db0[numActive], db1[numActive], db2[numActive], da1[numActive],
+            da2[numActive];
+
+        for (int k = 0; k < numActive; ++k)
+        {
+            const auto& c = activeCoefficients[k];
+            b0[k] = SIMD::broadcast (c.b0);
+            b1[k] = SIMD::broadcast (c.b1);
+            b2[k] = SIMD::broadcast (c.b2);
+            a1[k] = SIMD::broadcast (c.a1);
+            a2[k] = SIMD::broadcast (c.a2);
+
+            if constexpr (ramp)
+            {
+                db0[k] = SIMD::broadcast (steps[k].b0);
+                db1[k] = SIMD::broadcast (steps[k].b1);
+                db2[k] = SIMD::broadcast (steps[k].b2);
+                da1[k] = SIMD::broadcast (steps[k].a1);
+                da2[k] = SIMD::broadcast (steps[k].a2);
+            }
+
+            for (int v = 0; v < numVectors; ++v)
+            {
+                s1[k][v] = SIMD::load (activeStates[k] + v * SIMD::size);
+                s2[k][v] = SIMD::load (activeStates[k] + numLanes + v * SIMD::size);
+            }
+        }
+
+        // every sample runs through the whole cascade, the registers are independent
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Vector signal[numVectors];
+            for (int v = 0; v < numVectors; ++v)
+                signal[v] = SIMD::load (tile[i] + v * SIMD::size);
+
+            for (int k = 0; k < numActive; ++k)
+            {
+                for (int v = 0; v < numVectors; ++v)
+                {
+                    const Vector out = SIMD::add (SIMD::mul (b0[k], signal[v]), s1[k][v]);
+                    s1[k][v] = SIMD::add (SIMD::sub (SIMD::mul (b1[k], signal[v]), //
+                                                     SIMD::mul (a1[k], out)),
+                                          s2[k][v]);
+                    s2[k][v] = SIMD::sub (SIMD::mul (b2[k], signal[v]), SIMD::mul (a2[k], out));
+                    signal[v] = out;
+                }
+
+                if constexpr (ramp)
+                {
+                    b0[k] = SIMD::add (b0[k], db0[k]);
+                    b1[k] = SIMD::add (b1[k], db1[k]);
+                    b2[k] = SIMD::add (b2[k], db2[k]);
+                    a1[k] = SIMD::add (a1[k], da1[k]);
+                    a2[k] = SIMD::add (a2[k], da2[k]);
+                }
+            }
+
+            for (int v = 0; v < numVectors; ++v)
+                SIMD::store (signal[v], tile[i] + v * SIMD::size);
+        }
+
+        for (int k = 0; k < numActive; ++k)
+        {
+            for (int v = 0; v < numVectors; ++v)
+            {
+                SIMD::store (s1[k][v], activeStates[k] + v * SIMD::size);
+                SIMD::store (s2[k][v], activeStates[k] + numLanes + v * SIMD::size);
+            }
+        }
+    }
+
+    JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+
+    void processGeneric (float* const* channels, const int numChannels, const int numSamples)
+    {
+        processWith<SIMDGeneric> (channels, numChannels, numSamples);
+    }
+
+#if IEM_SIMD_AVX2
+    IEM_TARGET_AVX2 void processAVX2 (float* const* channels,
+                                      const int numChannels,
+                                      const int numSamples)
+    {
+        processWith<SIMDAVX2> (channels, numChannels, numSamples);
+    }
+#endif
+
+#if IEM_SIMD_AVX512
+    IEM_TARGET_AVX512 void processAVX512 (float* const* channels,
+                                          const int numChannels,
+                                          const int numSamples)
+    {
+        processWith<SIMDAVX512> (channels, numChannels, numSamples);
+    }
+#endif
+
+    int numSections = 0;
+    int numGroups = 0;
+    Coefficients coefficients[maxNumSections]; // targets of a ramp
+    Coefficients rampStart[maxNumSections];
+    bool rampingEnabled = false;
+    bool isRamping = false;
+    bool enabled[maxNumSections] = { true, true, true, true, true, true, true, true };
+    bool active[maxNumSections] = {};
+    int activeSections[maxNumSections] = {};
+    int numActiveSections = 0;
+    static constexpr std::uintptr_t alignment = 64;
+    juce::HeapBlock<float> states;
+    float* alignedStates = nullptr;
+
+    SIMDTier tier = SIMDTier::generic;
+    ProcessFunction processFunction = &BiquadBank::processGeneric;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadBank)
+};
+
+} // namespace iem
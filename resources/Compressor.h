@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "FastMath.h"
 #include <JuceHeader.h>
 namespace iem
 {
@@ -60,6 +61,7 @@ public:
     {
         knee = kneeInDecibels;
         kneeHalf = knee / 2.0f;
+        invTwoKnee = knee > 0.0f ? 0.5f / knee : 0.0f;
     }
 
     const float getKnee() { return knee; }
@@ -76,61 +78,40 @@ public:
 
     const float getMaxLevelInDecibels() { return maxLevel; }
 
-    void applyCharacteristicToOverShoot (float& overShoot)
+    /**
+     Branchless soft knee: the overshoot (level - threshold) is replaced by the resulting gain
+     reduction in decibels. Without knee, invTwoKnee is zero and the knee term vanishes.
+     */
+    inline void applyCharacteristicToOverShoot (float& overShoot)
     {
-        if (overShoot <= -kneeHalf)
-            overShoot = 0.0f; //y_G = levelInDecibels;
-        else if (overShoot > -kneeHalf && overShoot <= kneeHalf)
-            overShoot =
-                0.5f * slope * juce::square (overShoot + kneeHalf)
-                / knee; //y_G = levelInDecibels + 0.5f * slope * square(overShoot + kneeHalf) / knee;
-        else
-            overShoot = slope * overShoot;
+        const float inKnee = std::min (std::max (overShoot + kneeHalf, 0.0f), knee);
+        overShoot =
+            slope * (inKnee * inKnee * invTwoKnee + std::max (overShoot - kneeHalf, 0.0f));
     }
 
     void getGainFromSidechainSignal (const float* sideChainSignal,
                                      float* destination,
                                      const int numSamples)
     {
-        maxLevel = -INFINITY;
-        for (int i = 0; i < numSamples; ++i)
-        {
-            // convert sample to decibels
-            float levelInDecibels = juce::Decibels::gainToDecibels (abs (sideChainSignal[i]));
-            if (levelInDecibels > maxLevel)
-                maxLevel = levelInDecibels;
-            // calculate overshoot and apply knee and ratio
-            float overShoot = levelInDecibels - threshold;
-            applyCharacteristicToOverShoot (overShoot); //y_G = levelInDecibels + slope * overShoot;
-
-            // ballistics
-            const float diff = overShoot - state;
-            if (diff < 0.0f)
-                state += alphaAttack * diff;
-            else
-                state += alphaRelease * diff;
-
-            destination[i] = juce::Decibels::decibelsToGain (state + makeUpGain);
-        }
+        getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (sideChainSignal,
+                                                               destination,
+                                                               numSamples);
+        FastMath::decibelsToGain (destination, destination, numSamples, makeUpGain);
     }
 
     void getGainFromSidechainSignalInDecibelsWithoutMakeUpGain (const float* sideChainSignal,
                                                                 float* destination,
                                                                 const int numSamples)
     {
-        maxLevel = -INFINITY;
+        const auto range = juce::FloatVectorOperations::findMinAndMax (sideChainSignal, numSamples);
+        maxLevel = juce::Decibels::gainToDecibels (juce::jmax (-range.getStart(), range.getEnd()));
+
+        applyStaticCurve (sideChainSignal, destination, numSamples);
+
+        // ballistics (recursive, so it stays scalar)
         for (int i = 0; i < numSamples; ++i)
         {
-            // convert sample to decibels
-            float levelInDecibels = juce::Decibels::gainToDecibels (abs (sideChainSignal[i]));
-            if (levelInDecibels > maxLevel)
-                maxLevel = levelInDecibels;
-            // calculate overshoot and apply knee and ratio
-            float overShoot = levelInDecibels - threshold;
-            applyCharacteristicToOverShoot (overShoot); //y_G = levelInDecibels + slope * overShoot;
-
-            // ballistics
-            const float diff = overShoot - state;
+            const float diff = destination[i] - state;
             if (diff < 0.0f)
                 state += alphaAttack * diff;
             else
@@ -156,10 +137,21 @@ public:
     }
 
 private:
+    /** Gain reduction in decibels without ballistics, this loop gets vectorized. */
+    void applyStaticCurve (const float* sideChainSignal, float* destination, const int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float overShoot = FastMath::gainToDecibels (sideChainSignal[i]) - threshold;
+            applyCharacteristicToOverShoot (overShoot);
+            destination[i] = overShoot;
+        }
+    }
+
     double sampleRate { 0.0 };
     bool prepared;
 
-    float knee { 0.0f }, kneeHalf { 0.0f };
+    float knee { 0.0f }, kneeHalf { 0.0f }, invTwoKnee { 0.0f };
     float threshold { -10.0f };
     float attackTime { 0.01f };
     float releaseTime { 0.15f };
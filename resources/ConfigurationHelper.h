@@ -41,6 +41,10 @@
     #define CONFIGURATIONHELPER_ENABLE_GENERICLAYOUT_METHODS 0
 #endif
 
+#ifndef CONFIGURATIONHELPER_ENABLE_FILTER_METHODS
+    #define CONFIGURATIONHELPER_ENABLE_FILTER_METHODS 0
+#endif
+
 #ifndef CONFIGURATIONHELPER_ENABLE_ALL_METHODS
     #define CONFIGURATIONHELPER_ENABLE_ALL_METHODS 0
 #endif
@@ -62,6 +66,9 @@
 
     #undef CONFIGURATIONHELPER_ENABLE_GENERICLAYOUT_METHODS
     #define CONFIGURATIONHELPER_ENABLE_GENERICLAYOUT_METHODS 1
+
+    #undef CONFIGURATIONHELPER_ENABLE_FILTER_METHODS
+    #define CONFIGURATIONHELPER_ENABLE_FILTER_METHODS 1
 #endif
 
 #if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
@@ -105,15 +112,42 @@ public:
      */
     static juce::Result parseFileForTransformationMatrix (const juce::File& fileToParse,
                                                           ReferenceCountedMatrix::Ptr* dest)
+    {
+        if (! fileToParse.exists())
+            return juce::Result::fail ("File '" + fileToParse.getFullPathName()
+                                       + "' does not exist!");
+
+        return parseStringForTransformationMatrix (fileToParse.loadFileAsString(),
+                                                   dest,
+                                                   "File '" + fileToParse.getFullPathName() + "'");
+    }
+
+    /**
+     Parses the JSON content of a configuration (jsonString) for a TransformationMatrix object. If successful, writes the matrix into the destination (dest). The sourceName is used for error messages.
+     */
+    static juce::Result parseStringForTransformationMatrix (
+        const juce::String& jsonString,
+        ReferenceCountedMatrix::Ptr* dest,
+        const juce::String& sourceName = "Configuration")
     {
         jassert (dest != nullptr);
 
-        // parsing configuration file
+        // a binary cache of the same content saves parsing the configuration
+        const auto sourceHash = getContentHash (jsonString);
+        if (auto cachedMatrix = readMatrixFromBinaryCache (sourceHash))
+        {
+            cachedMatrix->analyseStructure();
+            *dest = cachedMatrix;
+            return juce::Result::ok();
+        }
+
+        // parsing configuration
         juce::var parsedJson;
         {
-            juce::Result result = parseFile (fileToParse, parsedJson);
+            juce::Result result = juce::JSON::parse (jsonString, parsedJson);
             if (! result.wasOk())
-                return juce::Result::fail (result.getErrorMessage());
+                return juce::Result::fail (sourceName + " could not be parsed:\n"
+                                           + result.getErrorMessage());
         }
 
         // looking for a 'TransformationMatrix' object
@@ -127,6 +161,10 @@ public:
         if (! result.wasOk())
             return juce::Result::fail (result.getErrorMessage());
 
+        // lets MatrixMultiplication skip the zeros of e.g. permutation or rotation matrices
+        (*dest)->analyseStructure();
+
+        writeMatrixToBinaryCache (**dest, sourceHash);
         return juce::Result::ok();
     }
 
@@ -357,16 +395,31 @@ public:
     {
         jassert (decoder != nullptr);
 
+        if (! fileToParse.exists())
+            return juce::Result::fail ("File '" + fileToParse.getFullPathName()
+                                       + "' does not exist!");
+
+        // a binary cache of the same content saves parsing the configuration file
+        const juce::String jsonString = fileToParse.loadFileAsString();
+        const auto sourceHash = getContentHash (jsonString);
+        if (auto cachedDecoder = readDecoderFromBinaryCache (sourceHash))
+        {
+            *decoder = cachedDecoder;
+            return juce::Result::ok();
+        }
+
         // parsing configuration file
         juce::var parsedJson;
-        juce::Result result = parseFile (fileToParse, parsedJson);
+        juce::Result result = juce::JSON::parse (jsonString, parsedJson);
         if (! result.wasOk())
-            return juce::Result::fail (result.getErrorMessage());
+            return juce::Result::fail ("File '" + fileToParse.getFullPathName()
+                                       + "' could not be parsed:\n" + result.getErrorMessage());
 
         result = parseVarForDecoder (parsedJson, decoder);
         if (! result.wasOk())
             return juce::Result::fail (result.getErrorMessage());
 
+        writeDecoderToBinaryCache (**decoder, sourceHash);
         return juce::Result::ok();
     }
 
@@ -562,6 +615,68 @@ public:
 
 #endif // #if CONFIGURATIONHELPER_ENABLE_GENERICLAYOUT_METHODS
 
+#if CONFIGURATIONHELPER_ENABLE_FILTER_METHODS
+    /**
+     Loads a JSON-file (fileToParse) and tries to parse for a 'Filters' object, which holds the
+     'SampleRate' and one array of filter coefficients per channel ('Coefficients'). If successful,
+     writes the filters into dest, zero-padded to the longest one.
+     */
+    static juce::Result parseFileForFilters (const juce::File& fileToParse,
+                                             juce::AudioBuffer<float>& dest,
+                                             double& sampleRate)
+    {
+        // parsing configuration file
+        juce::var parsedJson;
+        {
+            juce::Result result = parseFile (fileToParse, parsedJson);
+            if (! result.wasOk())
+                return juce::Result::fail (result.getErrorMessage());
+        }
+
+        juce::var filtersVar = parsedJson.getProperty ("Filters", juce::var());
+        if (! filtersVar.isObject())
+            return juce::Result::fail ("There is no 'Filters' object.");
+
+        juce::var sampleRateVar = filtersVar.getProperty ("SampleRate", juce::var());
+        if (! (sampleRateVar.isDouble() || sampleRateVar.isInt()) || (double) sampleRateVar <= 0.0)
+            return juce::Result::fail ("There is no valid 'SampleRate' in the 'Filters' object.");
+
+        juce::var coefficientsVar = filtersVar.getProperty ("Coefficients", juce::var());
+        if (! coefficientsVar.isArray() || coefficientsVar.size() == 0)
+            return juce::Result::fail ("There is no 'Coefficients' array in the 'Filters' object.");
+
+        const int nCh = coefficientsVar.size();
+        int length = 0;
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            auto channelVar = coefficientsVar.getArray()->getUnchecked (ch);
+            if (! channelVar.isArray())
+                return juce::Result::fail ("Coefficients of channel " + juce::String (ch + 1)
+                                           + " are not an array.");
+            length = juce::jmax (length, channelVar.size());
+        }
+
+        dest.setSize (nCh, length);
+        dest.clear();
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            auto channelVar = coefficientsVar.getArray()->getUnchecked (ch);
+            for (int i = 0; i < channelVar.size(); ++i)
+            {
+                auto coefficientVar = channelVar.getArray()->getUnchecked (i);
+                if (! (coefficientVar.isDouble() || coefficientVar.isInt()))
+                    return juce::Result::fail ("Coefficient " + juce::String (i + 1)
+                                               + " of channel " + juce::String (ch + 1)
+                                               + " could not be parsed.");
+                dest.setSample (ch, i, coefficientVar);
+            }
+        }
+
+        sampleRate = sampleRateVar;
+        return juce::Result::ok();
+    }
+#endif // #if CONFIGURATIONHELPER_ENABLE_FILTER_METHODS
+
 #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
     // =============== EXPORT ======================================================
     /**
@@ -649,6 +764,287 @@ public:
 
 #endif // #if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
 
+#if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+    // =============== BINARY CACHE ================================================
+    /*
+     Parsed matrices and decoders are cached as binary files, so loading the same configuration
+     again (e.g. when a session with many instances gets recalled) skips the JSON parsing. A cache
+     file is named after the hash of the JSON content it was created from. It consists of a
+     header, the name and description (UTF-8), the routing (int32) and the matrix (float32,
+     row-major). When loaded, it's memory-mapped, checked against the source hash and its own
+     checksum, and the matrix is copied in one go. Caching is best effort: whenever a cache file
+     can't be read or written, the JSON configuration gets parsed as usual.
+     */
+    struct BinaryCacheHeader
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 type;
+        juce::uint64 sourceHash;
+        juce::uint64 checksum; // of everything following the header
+        juce::uint32 rows, cols;
+        juce::uint32 nameSize, descriptionSize;
+
+        // decoder settings
+        juce::int32 normalization, weights, weightsAlreadyApplied, subwooferChannel;
+    };
+    static_assert (sizeof (BinaryCacheHeader) == 64, "Header has to be packed.");
+
+    static constexpr juce::uint32 binaryCacheVersion = 1;
+    static constexpr juce::uint32 binaryCacheTypeMatrix = 0;
+    static constexpr juce::uint32 binaryCacheTypeDecoder = 1;
+    static constexpr int maxNumBinaryCacheFiles = 128;
+
+    /** 64-bit FNV-1a hash, identifies JSON sources and validates cache files. */
+    static juce::uint64 getContentHash (const void* data, const size_t numBytes)
+    {
+        const auto* bytes = static_cast<const juce::uint8*> (data);
+        juce::uint64 hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+
+        return hash;
+    }
+
+    static juce::uint64 getContentHash (const juce::String& text)
+    {
+        return getContentHash (text.toRawUTF8(), text.getNumBytesAsUTF8());
+    }
+
+    static juce::File getBinaryCacheDirectory()
+    {
+    #if JUCE_MAC
+        return juce::File::getSpecialLocation (juce::File::userHomeDirectory)
+            .getChildFile ("Library/Caches/IEM/ConfigurationCache");
+    #else
+        return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+            .getChildFile ("IEM")
+            .getChildFile ("ConfigurationCache");
+    #endif
+    }
+
+    static juce::File getBinaryCacheFile (const juce::uint64 sourceHash)
+    {
+        return getBinaryCacheDirectory().getChildFile (
+            juce::String::toHexString (static_cast<juce::int64> (sourceHash)) + ".iemcache");
+    }
+
+    /**
+     Returns the cached matrix of a JSON source with the given hash, or nullptr if there's no
+     valid cache file.
+     */
+    static ReferenceCountedMatrix::Ptr readMatrixFromBinaryCache (const juce::uint64 sourceHash)
+    {
+        return readBinaryCache<ReferenceCountedMatrix::Ptr> (
+            sourceHash,
+            binaryCacheTypeMatrix,
+            [] (const BinaryCacheHeader& header,
+                const juce::String& name,
+                const juce::String& description)
+            {
+                return new ReferenceCountedMatrix (name,
+                                                   description,
+                                                   static_cast<int> (header.rows),
+                                                   static_cast<int> (header.cols));
+            });
+    }
+
+    /** Writes a matrix parsed from a JSON source with the given hash to the cache. */
+    static bool writeMatrixToBinaryCache (ReferenceCountedMatrix& matrix,
+                                          const juce::uint64 sourceHash)
+    {
+        auto header = createBinaryCacheHeader (sourceHash, binaryCacheTypeMatrix);
+        return writeBinaryCache (matrix, header);
+    }
+
+    #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+    /**
+     Returns the cached decoder of a JSON source with the given hash, or nullptr if there's no
+     valid cache file.
+     */
+    static ReferenceCountedDecoder::Ptr readDecoderFromBinaryCache (const juce::uint64 sourceHash)
+    {
+        return readBinaryCache<ReferenceCountedDecoder::Ptr> (
+            sourceHash,
+            binaryCacheTypeDecoder,
+            [] (const BinaryCacheHeader& header,
+                const juce::String& name,
+                const juce::String& description)
+            {
+                auto* decoder = new ReferenceCountedDecoder (name,
+                                                             description,
+                                                             static_cast<int> (header.rows),
+                                                             static_cast<int> (header.cols));
+
+                ReferenceCountedDecoder::Settings settings;
+                settings.expectedNormalization =
+                    static_cast<ReferenceCountedDecoder::Normalization> (header.normalization);
+                settings.weights = static_cast<ReferenceCountedDecoder::Weights> (header.weights);
+                settings.weightsAlreadyApplied = header.weightsAlreadyApplied != 0;
+                settings.subwooferChannel = header.subwooferChannel;
+                decoder->setSettings (settings);
+
+                return decoder;
+            });
+    }
+
+    /**
+     Writes a decoder parsed from a JSON source with the given hash to the cache. Call this before
+     altering the decoder (e.g. with removeAppliedWeights()).
+     */
+    static bool writeDecoderToBinaryCache (ReferenceCountedDecoder& decoder,
+                                           const juce::uint64 sourceHash)
+    {
+        auto header = createBinaryCacheHeader (sourceHash, binaryCacheTypeDecoder);
+
+        const auto settings = decoder.getSettings();
+        header.normalization = static_cast<juce::int32> (settings.expectedNormalization);
+        header.weights = static_cast<juce::int32> (settings.weights);
+        header.weightsAlreadyApplied = settings.weightsAlreadyApplied ? 1 : 0;
+        header.subwooferChannel = settings.subwooferChannel;
+
+        return writeBinaryCache (decoder, header);
+    }
+    #endif // #if CONFIGURATIONHELPER_ENABLE_DECODER_METHODS
+
+    static BinaryCacheHeader createBinaryCacheHeader (const juce::uint64 sourceHash,
+                                                      const juce::uint32 type)
+    {
+        BinaryCacheHeader header {};
+        std::memcpy (header.magic, "IEMCACHE", sizeof (header.magic));
+        header.version = binaryCacheVersion;
+        header.type = type;
+        header.sourceHash = sourceHash;
+        return header;
+    }
+
+    static bool writeBinaryCache (ReferenceCountedMatrix& matrix, BinaryCacheHeader& header)
+    {
+        auto& mat = matrix.getMatrix();
+        const auto name = matrix.getName();
+        const auto description = matrix.getDescription();
+        auto& routing = matrix.getRoutingArrayReference();
+
+        header.rows = static_cast<juce::uint32> (mat.getNumRows());
+        header.cols = static_cast<juce::uint32> (mat.getNumColumns());
+        header.nameSize = static_cast<juce::uint32> (name.getNumBytesAsUTF8());
+        header.descriptionSize = static_cast<juce::uint32> (description.getNumBytesAsUTF8());
+
+        if (routing.size() != static_cast<int> (header.rows))
+            return false;
+
+        juce::MemoryOutputStream payload;
+        payload.write (name.toRawUTF8(), header.nameSize);
+        payload.write (description.toRawUTF8(), header.descriptionSize);
+        for (int r = 0; r < routing.size(); ++r)
+        {
+            const auto channel = static_cast<juce::int32> (routing.getUnchecked (r));
+            payload.write (&channel, sizeof (channel));
+        }
+        payload.write (mat.getRawDataPointer(), header.rows * header.cols * sizeof (float));
+
+        header.checksum = getContentHash (payload.getData(), payload.getDataSize());
+
+        const auto file = getBinaryCacheFile (header.sourceHash);
+        if (file.getParentDirectory().createDirectory().failed())
+            return false;
+
+        pruneBinaryCache();
+
+        // written to a temporary file first, so other instances never read a partial file
+        juce::TemporaryFile tempFile (file);
+        {
+            auto stream = tempFile.getFile().createOutputStream();
+            if (stream == nullptr || ! stream->write (&header, sizeof (header))
+                || ! stream->write (payload.getData(), payload.getDataSize()))
+                return false;
+
+            stream->flush();
+            if (stream->getStatus().failed())
+                return false;
+        }
+
+        return tempFile.overwriteTargetFileWithTemporary();
+    }
+
+    template <typename PtrType, typename CreateFunction>
+    static PtrType readBinaryCache (const juce::uint64 sourceHash,
+                                    const juce::uint32 type,
+                                    CreateFunction&& create)
+    {
+        const auto file = getBinaryCacheFile (sourceHash);
+        if (! file.existsAsFile())
+            return nullptr;
+
+        juce::MemoryMappedFile mappedFile (file, juce::MemoryMappedFile::readOnly);
+        const auto* data = static_cast<const char*> (mappedFile.getData());
+        const auto size = static_cast<juce::uint64> (mappedFile.getSize());
+        if (data == nullptr || size < sizeof (BinaryCacheHeader))
+            return nullptr;
+
+        BinaryCacheHeader header;
+        std::memcpy (&header, data, sizeof (header));
+
+        const juce::uint64 rows = header.rows;
+        const juce::uint64 cols = header.cols;
+        const juce::uint64 payloadSize = juce::uint64 (header.nameSize) + header.descriptionSize
+                                         + rows * sizeof (juce::int32)
+                                         + rows * cols * sizeof (float);
+
+        if (std::memcmp (header.magic, "IEMCACHE", sizeof (header.magic)) != 0
+            || header.version != binaryCacheVersion || header.type != type
+            || header.sourceHash != sourceHash || rows == 0 || cols == 0
+            || size != sizeof (header) + payloadSize)
+            return nullptr;
+
+        const char* payload = data + sizeof (header);
+        if (getContentHash (payload, static_cast<size_t> (payloadSize)) != header.checksum)
+            return nullptr;
+
+        const auto name = juce::String::fromUTF8 (payload, static_cast<int> (header.nameSize));
+        payload += header.nameSize;
+        const auto description =
+            juce::String::fromUTF8 (payload, static_cast<int> (header.descriptionSize));
+        payload += header.descriptionSize;
+
+        PtrType result = create (header, name, description);
+
+        auto& routing = result->getRoutingArrayReference();
+        for (int r = 0; r < static_cast<int> (rows); ++r)
+        {
+            juce::int32 channel;
+            std::memcpy (&channel, payload, sizeof (channel));
+            payload += sizeof (channel);
+            routing.set (r, channel);
+        }
+
+        std::memcpy (result->getMatrix().getRawDataPointer(),
+                     payload,
+                     static_cast<size_t> (rows * cols * sizeof (float)));
+
+        return result;
+    }
+
+    /** Deletes the least recently written cache files, so the cache doesn't grow unbounded. */
+    static void pruneBinaryCache()
+    {
+        auto files = getBinaryCacheDirectory().findChildFiles (juce::File::findFiles,
+                                                               false,
+                                                               "*.iemcache");
+        if (files.size() < maxNumBinaryCacheFiles)
+            return;
+
+        std::sort (files.begin(),
+                   files.end(),
+                   [] (const juce::File& a, const juce::File& b)
+                   { return a.getLastModificationTime() < b.getLastModificationTime(); });
+
+        for (int i = 0; i <= files.size() - maxNumBinaryCacheFiles; ++i)
+            files.getReference (i).deleteFile();
+    }
+
+#endif // #if CONFIGURATIONHELPER_ENABLE_MATRIX_METHODS
+
 #if CONFIGURATIONHELPER_ENABLE_LOUDSPEAKERLAYOUT_METHODS
     /**
      Converts a loudspeakers juce::ValueTree object to a juce::var object. Useful for writing the loudspeakers to a configuration file ('LoudspeakerLayout'). Make sure the juce::ValueTree contains valid loudspeakers.
@@ -0,0 +1,253 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2017 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/**
+ Process-wide registry of the decoders and matrices loaded from configurations and of the variants
+ derived from them (e.g. compiled decoders). Hold it with a juce::SharedResourcePointer, so all
+ plug-in instances within a process use the same registry.
+
+ Loaded objects are identified by the content hash of their source (see
+ ConfigurationHelper::getContentHash()), so instances loading the same configuration share one
+ object instead of parsing and holding their own copy. Variants are identified by the object they
+ were derived from and their type. Shared objects mustn't be altered anymore. Entries are released
+ as soon as no instance holds their object anymore.
+
+ Configuration files can be watched: a background thread checks their modification times and
+ notifies the listeners of a modified file. As all of them load the same new content, it gets
+ parsed only once.
+ */
+class ConfigurationRegistry : private juce::Thread
+{
+public:
+    class FileListener
+    {
+    public:
+        virtual ~FileListener() = default;
+
+        /**
+         Called on the registry's thread after a watched file has been modified. Keep it short
+         (e.g. trigger an update on the message thread), unwatchFile() blocks meanwhile.
+         */
+        virtual void configurationFileChanged (const juce::File& file) = 0;
+    };
+
+    ConfigurationRegistry() : juce::Thread ("IEM Configuration Registry") {}
+
+    ~ConfigurationRegistry() override { stopThread (4000); }
+
+    /**
+     Returns the shared object of type ObjectType loaded from the source with the given hash. If
+     there's none yet, it's created with create(), which may return nullptr if loading fails.
+     Loading doesn't block the registry, in the rare case two instances load the same source at
+     the same time, the first one to finish wins.
+     */
+    template <typename ObjectType, typename CreateFunction>
+    juce::ReferenceCountedObjectPtr<ObjectType> getOrCreate (const juce::uint64 sourceHash,
+                                                             CreateFunction&& create)
+    {
+        {
+            const juce::ScopedLock lock (entriesLock);
+            removeUnusedEntries();
+            if (auto* existing = findObject<ObjectType> (sourceHash))
+                return existing;
+        }
+
+        juce::ReferenceCountedObjectPtr<ObjectType> created = create();
+        if (created == nullptr)
+            return nullptr;
+
+        const juce::ScopedLock lock (entriesLock);
+        if (auto* existing = findObject<ObjectType> (sourceHash))
+            return existing;
+
+        objects.push_back ({ sourceHash, created.get() });
+        return created;
+    }
+
+    /**
+     Returns the shared variant of type VariantType derived from the source object. If there's
+     none yet, it's created with create() while holding the registry's lock, so a source object is
+     never processed by two instances at the same time.
+     */
+    template <typename VariantType, typename CreateFunction>
+    juce::ReferenceCountedObjectPtr<VariantType>
+        getOrCreateVariant (juce::ReferenceCountedObject* source, CreateFunction&& create)
+    {
+        jassert (source != nullptr);
+
+        const juce::ScopedLock lock (entriesLock);
+        removeUnusedEntries();
+
+        for (auto& entry : variants)
+            if (entry.source.get() == source)
+                if (auto* existing = dynamic_cast<VariantType*> (entry.variant.get()))
+                    return existing;
+
+        juce::ReferenceCountedObjectPtr<VariantType> created = create();
+        if (created != nullptr)
+            variants.push_back ({ source, created.get() });
+
+        return created;
+    }
+
+    /**
+     Starts watching a file for the listener, replacing the file it watched before. Call
+     unwatchFile() before the listener gets destroyed.
+     */
+    void watchFile (const juce::File& file, FileListener* listener)
+    {
+        const juce::ScopedLock lock (watchLock);
+        removeWatches (listener);
+        watchedFiles.push_back ({ file, file.getLastModificationTime(), listener });
+
+        if (! isThreadRunning())
+            startThread (juce::Thread::Priority::low);
+    }
+
+    /** Stops watching, blocks while a listener is being notified. */
+    void unwatchFile (FileListener* listener)
+    {
+        const juce::ScopedLock notifyScope (notifyLock);
+        const juce::ScopedLock lock (watchLock);
+        removeWatches (listener);
+    }
+
+private:
+    struct ObjectEntry
+    {
+        juce::uint64 sourceHash;
+        juce::ReferenceCountedObjectPtr<juce::ReferenceCountedObject> object;
+    };
+
+    struct VariantEntry
+    {
+        juce::ReferenceCountedObjectPtr<juce::ReferenceCountedObject> source;
+        juce::ReferenceCountedObjectPtr<juce::ReferenceCountedObject> variant;
+    };
+
+    struct WatchedFile
+    {
+        juce::File file;
+        juce::Time modificationTime;
+        FileListener* listener;
+    };
+
+    static constexpr int checkIntervalMs = 1000;
+
+    template <typename ObjectType>
+    ObjectType* findObject (const juce::uint64 sourceHash)
+    {
+        for (auto& entry : objects)
+            if (entry.sourceHash == sourceHash)
+                if (auto* existing = dynamic_cast<ObjectType*> (entry.object.get()))
+                    return existing;
+
+        return nullptr;
+    }
+
+    /** Releases the entries only referenced by the registry, variants first as they reference
+        their source objects. */
+    void removeUnusedEntries()
+    {
+        variants.erase (std::remove_if (variants.begin(),
+                                        variants.end(),
+                                        [] (const VariantEntry& entry)
+                                        { return entry.variant->getReferenceCount() == 1; }),
+                        variants.end());
+
+        objects.erase (std::remove_if (objects.begin(),
+                                       objects.end(),
+                                       [] (const ObjectEntry& entry)
+                                       { return entry.object->getReferenceCount() == 1; }),
+                       objects.end());
+    }
+
+    void removeWatches (FileListener* listener)
+    {
+        watchedFiles.erase (std::remove_if (watchedFiles.begin(),
+                                            watchedFiles.end(),
+                                            [listener] (const WatchedFile& watched)
+                                            { return watched.listener == listener; }),
+                            watchedFiles.end());
+    }
+
+    bool isWatching (const juce::File& file, FileListener* listener) const
+    {
+        for (auto& watched : watchedFiles)
+            if (watched.listener == listener && watched.file == file)
+                return true;
+
+        return false;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (checkIntervalMs);
+
+            std::vector<WatchedFile> modified;
+            {
+                const juce::ScopedLock lock (watchLock);
+                for (auto& watched : watchedFiles)
+                {
+                    const auto modificationTime = watched.file.getLastModificationTime();
+                    if (modificationTime != watched.modificationTime)
+                    {
+                        watched.modificationTime = modificationTime;
+                        modified.push_back (watched);
+                    }
+                }
+            }
+
+            // listeners are notified without holding watchLock, so they can (un)watch files from
+            // their callback; notifyLock keeps unwatchFile() from returning during a notification
+            const juce::ScopedLock notifyScope (notifyLock);
+            for (auto& watched : modified)
+            {
+                if (threadShouldExit())
+                    break;
+
+                bool stillWatched;
+                {
+                    const juce::ScopedLock lock (watchLock);
+                    stillWatched = isWatching (watched.file, watched.listener);
+                }
+
+                if (stillWatched)
+                    watched.listener->configurationFileChanged (watched.file);
+            }
+        }
+    }
+
+    juce::CriticalSection entriesLock;
+    std::vector<ObjectEntry> objects;
+    std::vector<VariantEntry> variants;
+
+    juce::CriticalSection notifyLock, watchLock;
+    std::vector<WatchedFile> watchedFiles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConfigurationRegistry)
+};
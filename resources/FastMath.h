@@ -0,0 +1,129 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace iem
+{
+
+/**
+ Fast, branchless approximations of log2 and exp2 and the decibel conversions based on them.
+ They only use integer bit manipulations and polynomials, so loops calling them get vectorized by
+ the compiler (SSE, AVX, NEON).
+
+ Error bounds (minimax polynomials):
+ - log2: absolute error < 1.5e-5, i.e. gainToDecibels is off by less than 1e-4 dB
+ - exp2: relative error < 2.6e-6, i.e. decibelsToGain is off by less than 3e-5 dB
+ */
+struct FastMath
+{
+    /** Only valid for positive, finite values. Zero results in roughly -127. */
+    static inline float log2 (const float x) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (float));
+
+        // x = mantissa * 2^exponent, with mantissa in [1, 2)
+        const auto exponent = static_cast<float> (static_cast<std::int32_t> (bits >> 23) - 127);
+        bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+
+        float t;
+        std::memcpy (&t, &bits, sizeof (float));
+        t -= 1.0f;
+
+        const float p =
+            t
+            * (1.441965429f
+               + t * (-0.7096610191f + t * (0.4175903586f + t * (-0.1962631804f + t * 0.0463827083f))));
+        return exponent + p;
+    }
+
+    /** The argument gets clipped to [-126, 127]. */
+    static inline float exp2 (float x) noexcept
+    {
+        x = std::min (std::max (x, -126.0f), 127.0f);
+
+        // floor without relying on SSE4.1
+        auto integer = static_cast<std::int32_t> (x);
+        integer -= static_cast<std::int32_t> (x < static_cast<float> (integer));
+        const float f = x - static_cast<float> (integer);
+
+        const float p =
+            1.000002593f
+            + f * (0.6930038406f + f * (0.2414427237f + f * (0.05201151671f + f * 0.01353413872f)));
+
+        std::uint32_t bits;
+        std::memcpy (&bits, &p, sizeof (float));
+        bits += static_cast<std::uint32_t> (integer) << 23;
+
+        float result;
+        std::memcpy (&result, &bits, sizeof (float));
+        return result;
+    }
+
+    /** Same as juce::Decibels::gainToDecibels, but uses the magnitude of the gain. */
+    static inline float gainToDecibels (float gain, const float minusInfinityDb = -100.0f) noexcept
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, &gain, sizeof (float));
+        bits &= 0x7FFFFFFFu; // abs
+        std::memcpy (&gain, &bits, sizeof (float));
+
+        const float dB = 6.020599913f * log2 (gain);
+        return dB > minusInfinityDb ? dB : minusInfinityDb;
+    }
+
+    /**
+     Like juce::Decibels::decibelsToGain, but without mapping values below -100 dB to zero (which
+     would prevent vectorization), they simply result in tiny gains.
+     */
+    static inline float decibelsToGain (const float dB) noexcept
+    {
+        return exp2 (0.1660964047f * dB);
+    }
+
+    //==============================================================================
+    static void gainToDecibels (const float* src,
+                                float* dest,
+                                const int numSamples,
+                                const float minusInfinityDb = -100.0f) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = gainToDecibels (src[i], minusInfinityDb);
+    }
+
+    /** Adds offsetInDecibels before the conversion, e.g. a make-up gain. */
+    static void decibelsToGain (const float* src,
+                                float* dest,
+                                const int numSamples,
+                                const float offsetInDecibels = 0.0f) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = decibelsToGain (src[i] + offsetInDecibels);
+    }
+};
+
+} // namespace iem
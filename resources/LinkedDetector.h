@@ -0,0 +1,122 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace iem
+{
+
+/**
+ Calculates the sidechain signal for an iem::Compressor, linked across all Ambisonic channels up
+ to a chosen order. The channel energies are summed up and normalized, so a single plane wave
+ results in the same level as its omnidirectional component. With order zero, only the W channel
+ is used, which results in the former (unlinked) behavior.
+ Optionally, the energy gets smoothed with a one-pole filter (RMS detection).
+ */
+class LinkedDetector
+{
+public:
+    LinkedDetector() {}
+    ~LinkedDetector() {}
+
+    void prepare (const juce::dsp::ProcessSpec spec)
+    {
+        sampleRate = spec.sampleRate;
+        setRMSTime (rmsTime);
+        reset();
+    }
+
+    void reset() { state = 0.0f; }
+
+    /** Highest order used for detection, zero means W only. */
+    void setOrder (const int newOrder) { order = juce::jlimit (0, 7, newOrder); }
+
+    void setNormalization (const bool useSN3D) { isSN3D = useSN3D; }
+
+    /** Time constant of the RMS smoothing, zero results in peak detection. */
+    void setRMSTime (const float timeInSeconds)
+    {
+        rmsTime = timeInSeconds;
+        if (rmsTime > 0.0f && sampleRate > 0.0)
+            alpha = static_cast<float> (1.0 - std::exp (-1.0 / (sampleRate * rmsTime)));
+        else
+            alpha = 1.0f;
+    }
+
+    /**
+     Writes the detected level (linear, not in decibels) into destination, which has to hold at
+     least numSamples values. The order gets limited to the available channels.
+     */
+    void process (const float* const* channels,
+                  const int numChannels,
+                  float* destination,
+                  const int numSamples)
+    {
+        if (numChannels < 1)
+        {
+            juce::FloatVectorOperations::clear (destination, numSamples);
+            return;
+        }
+
+        const int usedOrder = juce::jmin (order, isqrt (numChannels) - 1);
+        const int nCh = juce::square (usedOrder + 1);
+
+        juce::FloatVectorOperations::multiply (destination, channels[0], channels[0], numSamples);
+        for (int ch = 1; ch < nCh; ++ch)
+            juce::FloatVectorOperations::addWithMultiply (destination,
+                                                          channels[ch],
+                                                          channels[ch],
+                                                          numSamples);
+
+        // a plane wave has an energy of N + 1 (SN3D) or (N + 1)^2 (N3D)
+        const float normalization =
+            1.0f / (isSN3D ? usedOrder + 1 : juce::square (usedOrder + 1));
+
+        if (alpha < 1.0f)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                state += alpha * (destination[i] - state);
+                destination[i] = state;
+            }
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = std::sqrt (normalization * destination[i]);
+    }
+
+private:
+    static int isqrt (const int x) { return static_cast<int> (std::sqrt (static_cast<float> (x))); }
+
+    double sampleRate { 0.0 };
+
+    int order { 0 };
+    bool isSN3D { true };
+    float rmsTime { 0.0f };
+    float alpha { 1.0f };
+
+    float state { 0.0f };
+};
+
+} // namespace iem
@@ -0,0 +1,623 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "BiquadBank.h"
+#include "SIMDDispatch.h"
+#include <JuceHeader.h>
+
+namespace iem
+{
+
+/**
+ Splits planar multichannel audio into 2 to 8 bands with 4th order Linkwitz-Riley crossovers, all
+ bands are calculated in a single pass over the input.
+ The crossovers have to be in ascending order. They form a balanced tree: the input is split at
+ the middle crossover, each half gets the all-passes of the crossovers of the other half and is
+ split further the same way (see getBandPath()). So all bands have the same phase response and
+ sum up to an all-pass; for 4 bands this is the filter tree MultiBandCompressor always used.
+ Like BiquadBank, the channels are processed in groups of numLanes using short interleaved tiles
+ on the stack, each sample runs through the whole filter network before moving on to the next one
+ and the band outputs are written straight into planar buffers. The kernel is compiled for each
+ SIMD tier, with coefficient ramping enabled changed crossovers are interpolated sample by sample
+ across the next processed block.
+ */
+class LinkwitzRileyCrossover
+{
+public:
+    static constexpr int minNumBands = 2;
+    static constexpr int maxNumBands = 8;
+    static constexpr int maxNumCrossovers = maxNumBands - 1;
+    static constexpr int maxDepth = 3; // splits from the input to a band, for maxNumBands
+    static constexpr int numLanes = BiquadBank::numLanes;
+    static constexpr int tileLength = BiquadBank::tileLength;
+
+    using Coefficients = BiquadBank::Coefficients;
+
+    /** Butterworth low- and high-pass (each applied twice) and the equivalent all-pass. */
+    struct Crossover
+    {
+        Coefficients lowPass, highPass, allPass;
+
+        Crossover getStep (const Crossover& to, const int numSteps) const
+        {
+            return { Coefficients::getStep (lowPass, to.lowPass, numSteps),
+                     Coefficients::getStep (highPass, to.highPass, numSteps),
+                     Coefficients::getStep (allPass, to.allPass, numSteps) };
+        }
+
+        Crossover advancedBy (const Crossover& step, const float numSteps) const
+        {
+            return { lowPass.advancedBy (step.lowPass, numSteps),
+                     highPass.advancedBy (step.highPass, numSteps),
+                     allPass.advancedBy (step.allPass, numSteps) };
+        }
+    };
+
+    /**
+     Bilinear-transformed 2nd order Butterworth low- and high-pass at the given frequency and the
+     all-pass both of them applied twice sum up to. Computed in double precision without
+     allocating, so it can be called on the audio thread; the frequency has to be below Nyquist.
+     */
+    static Crossover makeCrossover (const double sampleRate, const double frequency)
+    {
+        jassert (frequency > 0.0 && frequency < 0.5 * sampleRate);
+
+        const double K = std::tan (juce::MathConstants<double>::pi * frequency / sampleRate);
+        const double den = 1.0 + juce::MathConstants<double>::sqrt2 * K + K * K;
+        const float a1 = static_cast<float> (2.0 * (K * K - 1.0) / den);
+        const float a2 =
+            static_cast<float> ((1.0 - juce::MathConstants<double>::sqrt2 * K + K * K) / den);
+
+        const float lp = static_cast<float> (K * K / den);
+        const float hp = static_cast<float> (1.0 / den);
+
+        return { { lp, 2.0f * lp, lp, a1, a2 },
+                 { hp, -2.0f * hp, hp, a1, a2 },
+                 { a2, a1, 1.0f, a1, a2 } };
+    }
+
+    /** A split on the way from the input to a band: the low- or high-pass of a crossover. */
+    struct Split
+    {
+        int crossover;
+        bool isHighPass;
+    };
+
+    LinkwitzRileyCrossover() {}
+    ~LinkwitzRileyCrossover() {}
+
+    /**
+     Allocates the filter states for up to maxNumBands and selects the SIMD kernel, call this
+     before processing.
+     */
+    void prepare (const int maximumNumChannels, const int newNumBands)
+    {
+        setSIMDTier (getBestSIMDTier());
+
+        numGroups = (maximumNumChannels + numLanes - 1) / numLanes;
+
+        const int numStates = maxNumSections * numGroups * 2 * numLanes;
+        states.allocate (static_cast<size_t> (numStates + alignment / sizeof (float)), true);
+        alignedStates = reinterpret_cast<float*> (
+            (reinterpret_cast<std::uintptr_t> (states.get()) + alignment - 1) & ~(alignment - 1));
+
+        numBands = 0;
+        setNumBands (newNumBands);
+    }
+
+    /** Realtime-safe, resets the filters if the number of bands changes. */
+    void setNumBands (const int newNumBands)
+    {
+        jassert (newNumBands >= minNumBands && newNumBands <= maxNumBands);
+        const int clippedNumBands = juce::jlimit (minNumBands, maxNumBands, newNumBands);
+        if (clippedNumBands == numBands)
+            return;
+
+        numBands = clippedNumBands;
+        numCrossovers = numBands - 1;
+        numSections = 0;
+        numOperations = 0;
+        addSplits (0, numCrossovers, 0);
+
+        reset();
+    }
+
+    int getNumBands() const { return numBands; }
+
+    /**
+     Writes the splits from the input to the given band into path (at most maxDepth), returns
+     their number. The band's magnitude is the product of these low- and high-passes, the
+     all-passes in between don't change it.
+     */
+    static int getBandPath (const int numBands, const int band, Split* path)
+    {
+        // the crossovers of the current subtree are [lowest, highest)
+        int numSplits = 0;
+        int lowest = 0, highest = numBands - 1;
+        while (lowest < highest)
+        {
+            const int middle = (lowest + highest) / 2;
+            const bool isHighPass = band > middle;
+            path[numSplits++] = { middle, isHighPass };
+
+            if (isHighPass)
+                lowest = middle + 1;
+            else
+                highest = middle;
+        }
+        return numSplits;
+    }
+
+    /** Overrides the automatic selection, tiers which aren't compiled in fall back to generic. */
+    void setSIMDTier (const SIMDTier newTier)
+    {
+        tier = SIMDTier::generic;
+        processFunction = &LinkwitzRileyCrossover::processGeneric;
+#if IEM_SIMD_AVX2
+        if (newTier == SIMDTier::avx2)
+        {
+            tier = newTier;
+            processFunction = &LinkwitzRileyCrossover::processAVX2;
+        }
+#endif
+#if IEM_SIMD_AVX512
+        if (newTier == SIMDTier::avx512)
+        {
+            tier = newTier;
+            processFunction = &LinkwitzRileyCrossover::processAVX512;
+        }
+#endif
+    }
+
+    SIMDTier getSIMDTier() const { return tier; }
+
+    /** Clears the states, pending coefficient ramps are skipped. */
+    void reset()
+    {
+        if (alignedStates != nullptr)
+            juce::FloatVectorOperations::clear (alignedStates,
+                                                numSections * numGroups * 2 * numLanes);
+        for (int c = 0; c < maxNumCrossovers; ++c)
+            rampStart[c] = crossovers[c];
+        isRamping = false;
+    }
+
+    /** When enabled, changed crossovers get interpolated across the next processed block. */
+    void setCoefficientRamping (const bool shouldRamp)
+    {
+        rampingEnabled = shouldRamp;
+        if (! shouldRamp)
+            reset();
+    }
+
+    void setCrossover (const int index, const Crossover& newCrossover)
+    {
+        jassert (juce::isPositiveAndBelow (index, maxNumCrossovers));
+        if (rampingEnabled)
+            isRamping = true;
+        else
+            rampStart[index] = newCrossover;
+
+        crossovers[index] = newCrossover;
+    }
+
+    void setCrossover (const int index,
+                       const juce::dsp::IIR::Coefficients<float>& lowPass,
+                       const juce::dsp::IIR::Coefficients<float>& highPass,
+                       const juce::dsp::IIR::Coefficients<float>& allPass)
+    {
+        setCrossover (index,
+                      { Coefficients::fromIIRCoefficients (lowPass),
+                        Coefficients::fromIIRCoefficients (highPass),
+                        Coefficients::fromIIRCoefficients (allPass) });
+    }
+
+    /** Writes band b of channel ch to bands[b][ch], the input isn't altered. */
+    void process (const float* const* input,
+                  float* const* const* bands,
+                  const int numChannels,
+                  const int numSamples)
+    {
+        (this->*processFunction) (input, bands, numChannels, numSamples);
+
+        if (isRamping)
+        {
+            for (int c = 0; c < maxNumCrossovers; ++c)
+                rampStart[c] = crossovers[c];
+            isRamping = false;
+        }
+    }
+
+private:
+    using ProcessFunction = void (LinkwitzRileyCrossover::*) (const float* const*,
+                                                              float* const* const*,
+                                                              const int,
+                                                              const int);
+
+    // four Butterworth sections per crossover, plus the all-passes (fewer than one per crossover
+    // and tree level)
+    static constexpr int maxNumSections = 4 * maxNumCrossovers + maxDepth * maxNumCrossovers;
+    static constexpr int maxNumRegisters = maxDepth + 1;
+
+    /**
+     The tree is processed as a list of operations on a few signal registers: copying a register
+     (source to target), running a section of a crossover on a register (target) or storing a
+     register (source) as band (target).
+     */
+    struct Operation
+    {
+        enum class Type
+        {
+            copy,
+            lowPass,
+            highPass,
+            allPass,
+            store
+        };
+
+        Type type;
+        int crossover, section, source, target;
+    };
+
+    static constexpr int maxNumOperations = maxNumCrossovers + maxNumSections + maxNumBands;
+
+    void addOperation (const Operation::Type type,
+                       const int crossover,
+                       const int source,
+                       const int target)
+    {
+        jassert (numOperations < maxNumOperations);
+        const bool isSection = type != Operation::Type::copy && type != Operation::Type::store;
+        operations[numOperations++] = {
+            type, crossover, isSection ? numSections++ : -1, source, target
+        };
+    }
+
+    /**
+     Splits the signal in the given register at the middle of the crossovers [lowest, highest):
+     the upper half is processed in the next register first, then the lower half in place.
+     */
+    void addSplits (const int lowest, const int highest, const int reg)
+    {
+        using Type = Operation::Type;
+
+        if (lowest == highest)
+        {
+            addOperation (Type::store, -1, reg, lowest);
+            return;
+        }
+
+        jassert (reg + 1 < maxNumRegisters);
+        const int middle = (lowest + highest) / 2;
+
+        addOperation (Type::copy, -1, reg, reg + 1);
+        addOperation (Type::highPass, middle, -1, reg + 1);
+        addOperation (Type::highPass, middle, -1, reg + 1);
+        for (int c = lowest; c < middle; ++c)
+            addOperation (Type::allPass, c, -1, reg + 1);
+        addSplits (middle + 1, highest, reg + 1);
+
+        addOperation (Type::lowPass, middle, -1, reg);
+        addOperation (Type::lowPass, middle, -1, reg);
+        for (int c = middle + 1; c < highest; ++c)
+            addOperation (Type::allPass, c, -1, reg);
+        addSplits (lowest, middle, reg);
+    }
+
+    float* getStates (const int group) { return alignedStates + group * numSections * 2 * numLanes; }
+
+    // the kernels are forced inline, so they get compiled with the target of the calling function
+    JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Wpsabi")
+
+    template <typename SIMD>
+    forcedinline void processWith (const float* const* input,
+                                   float* const* const* bands,
+                                   const int numChannels,
+                                   const int numSamples)
+    {
+        static_assert (numLanes % SIMD::size == 0, "numLanes has to be a multiple of SIMD::size");
+        const int usedGroups = juce::jmin (numGroups, (numChannels + numLanes - 1) / numLanes);
+
+        // the coefficients used for the n-th sample of the block are rampStart + (n + 1) * step
+        Crossover steps[maxNumCrossovers];
+        if (isRamping)
+            for (int c = 0; c < numCrossovers; ++c)
+                steps[c] = rampStart[c].getStep (crossovers[c], numSamples);
+
+        for (int g = 0; g < usedGroups; ++g)
+        {
+            const int firstChannel = g * numLanes;
+            const int nLanes = juce::jmin (numLanes, numChannels - firstChannel);
+            const int numVectors = (nLanes + SIMD::size - 1) / SIMD::size;
+
+            for (int start = 0; start < numSamples; start += tileLength)
+            {
+                const int n = juce::jmin (tileLength, numSamples - start);
+                alignas (alignment) float tile[tileLength][numLanes];
+                alignas (alignment) float bandTiles[maxNumBands][tileLength][numLanes];
+
+                for (int lane = 0; lane < nLanes; ++lane)
+                {
+                    const float* src = input[firstChannel + lane] + start;
+                    for (int i = 0; i < n; ++i)
+                        tile[i][lane] = src[i];
+                }
+                for (int lane = nLanes; lane < numVectors * SIMD::size; ++lane)
+                    for (int i = 0; i < n; ++i)
+                        tile[i][lane] = 0.0f;
+
+                Crossover tileCrossovers[maxNumCrossovers];
+                for (int c = 0; c < numCrossovers; ++c)
+                {
+                    tileCrossovers[c] = rampStart[c];
+                    if (isRamping)
+                        tileCrossovers[c] =
+                            tileCrossovers[c].advancedBy (steps[c], static_cast<float> (start + 1));
+                }
+
+                if (isRamping)
+                    processTile<SIMD, true> (tile,
+                                             bandTiles,
+                                             n,
+                                             tileCrossovers,
+                                             steps,
+                                             getStates (g),
+                                             numVectors);
+                else
+                    processTile<SIMD, false> (tile,
+                                              bandTiles,
+                                              n,
+                                              tileCrossovers,
+                                              steps,
+                                              getStates (g),
+                                              numVectors);
+
+                for (int b = 0; b < numBands; ++b)
+                    for (int lane = 0; lane < nLanes; ++lane)
+                    {
+                        float* dest = bands[b][firstChannel + lane] + start;
+                        for (int i = 0; i < n; ++i)
+                            dest[i] = bandTiles[b][i][lane];
+                    }
+            }
+        }
+    }
+
+    /** Dispatches to a kernel with a fixed number of registers per section. */
+    template <typename SIMD, bool ramp, int maxNumVectors = numLanes / SIMD::size>
+    forcedinline void processTile (float (*tile)[numLanes],
+                                   float (*bandTiles)[tileLength][numLanes],
+                                   const int numSamples,
+                                   const Crossover* tileCrossovers,
+                                   const Crossover* steps,
+                                   float* groupStates,
+                                   const int numVectors) const
+    {
+        if constexpr (maxNumVectors > 1)
+            if (numVectors < maxNumVectors)
+                return processTile<SIMD, ramp, maxNumVectors - 1> (tile,
+                                                                   bandTiles,
+                                                                   numSamples,
+                                                                   tileCrossovers,
+                                                                   steps,
+                                                                   groupStates,
+                                                                   numVectors);
+
+        processTileFixed<SIMD, ramp, maxNumVectors> (tile,
+                                                     bandTiles,
+                                                     numSamples,
+                                                     tileCrossovers,
+                                                     steps,
+                                                     groupStates);
+    }
+
+    template <typename SIMD>
+    struct VectorCoefficients
+    {
+        typename SIMD::Vector b0, b1, b2, a1, a2;
+
+        forcedinline void set (const Coefficients& c)
+        {
+            b0 = SIMD::broadcast (c.b0);
+            b1 = SIMD::broadcast (c.b1);
+            b2 = SIMD::broadcast (c.b2);
+            a1 = SIMD::broadcast (c.a1);
+            a2 = SIMD::broadcast (c.a2);
+        }
+
+        forcedinline void advance (const VectorCoefficients& step)
+        {
+            b0 = SIMD::add (b0, step.b0);
+            b1 = SIMD::add (b1, step.b1);
+            b2 = SIMD::add (b2, step.b2);
+            a1 = SIMD::add (a1, step.a1);
+            a2 = SIMD::add (a2, step.a2);
+        }
+    };
+
+    /** One sample of a biquad section (transposed direct form II), in place. */
+    template <typename SIMD, int numVectors>
+    static forcedinline void tick (const VectorCoefficients<SIMD>& c,
+                                   typename SIMD::Vector* s1,
+                                   typename SIMD::Vector* s2,
+                                   typename SIMD::Vector* signal)
+    {
+        for (int v = 0; v < numVectors; ++v)
+        {
+            const auto in = signal[v];
+            const auto out = SIMD::add (SIMD::mul (c.b0, in), s1[v]);
+            s1[v] = SIMD::add (SIMD::sub (SIMD::mul (c.b1, in), SIMD::mul (c.a1, out)), s2[v]);
+            s2[v] = SIMD::sub (SIMD::mul (c.b2, in), SIMD::mul (c.a2, out));
+            signal[v] = out;
+        }
+    }
+
+    template <typename SIMD, bool ramp, int numVectors>
+    forcedinline void processTileFixed (float (*tile)[numLanes],
+                                        float (*bandTiles)[tileLength][numLanes],
+                                        const int numSamples,
+                                        const Crossover* tileCrossovers,
+                                        const Crossover* steps,
+                                        float* groupStates) const
+    {
+        using Vector = typename SIMD::Vector;
+        using VC = VectorCoefficients<SIMD>;
+
+        VC lowPass[maxNumCrossovers], highPass[maxNumCrossovers], allPass[maxNumCrossovers];
+        [[maybe_unused]] VC lowPassStep[maxNumCrossovers], highPassStep[maxNumCrossovers],
+            allPassStep[maxNumCrossovers];
+
+        for (int c = 0; c < numCrossovers; ++c)
+        {
+            lowPass[c].set (tileCrossovers[c].lowPass);
+            highPass[c].set (tileCrossovers[c].highPass);
+            allPass[c].set (tileCrossovers[c].allPass);
+
+            if constexpr (ramp)
+            {
+                lowPassStep[c].set (steps[c].lowPass);
+                highPassStep[c].set (steps[c].highPass);
+                allPassStep[c].set (steps[c].allPass);
+            }
+        }
+
+        Vector s1[maxNumSections][numVectors], s2[maxNumSections][numVectors];
+        for (int s = 0; s < numSections; ++s)
+            for (int v = 0; v < numVectors; ++v)
+            {
+                s1[s][v] = SIMD::load (groupStates + s * 2 * numLanes + v * SIMD::size);
+                s2[s][v] = SIMD::load (groupStates + s * 2 * numLanes + numLanes + v * SIMD::size);
+            }
+
+        using Type = Operation::Type;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Vector registers[maxNumRegisters][numVectors];
+            for (int v = 0; v < numVectors; ++v)
+                registers[0][v] = SIMD::load (tile[i] + v * SIMD::size);
+
+            for (int o = 0; o < numOperations; ++o)
+            {
+                const auto& op = operations[o];
+                switch (op.type)
+                {
+                    case Type::copy:
+                        for (int v = 0; v < numVectors; ++v)
+                            registers[op.target][v] = registers[op.source][v];
+                        break;
+                    case Type::lowPass:
+                        tick<SIMD, numVectors> (lowPass[op.crossover],
+                                                s1[op.section],
+                                                s2[op.section],
+                                                registers[op.target]);
+                        break;
+                    case Type::highPass:
+                        tick<SIMD, numVectors> (highPass[op.crossover],
+                                                s1[op.section],
+                                                s2[op.section],
+                                                registers[op.target]);
+                        break;
+                    case Type::allPass:
+                        tick<SIMD, numVectors> (allPass[op.crossover],
+                                                s1[op.section],
+                                                s2[op.section],
+                                                registers[op.target]);
+                        break;
+                    case Type::store:
+                        for (int v = 0; v < numVectors; ++v)
+                            SIMD::store (registers[op.source][v],
+                                         bandTiles[op.target][i] + v * SIMD::size);
+                        break;
+                }
+            }
+
+            if constexpr (ramp)
+                for (int c = 0; c < numCrossovers; ++c)
+                {
+                    lowPass[c].advance (lowPassStep[c]);
+                    highPass[c].advance (highPassStep[c]);
+                    allPass[c].advance (allPassStep[c]);
+                }
+        }
+
+        for (int s = 0; s < numSections; ++s)
+            for (int v = 0; v < numVectors; ++v)
+            {
+                SIMD::store (s1[s][v], groupStates + s * 2 * numLanes + v * SIMD::size);
+                SIMD::store (s2[s][v], groupStates + s * 2 * numLanes + numLanes + v * SIMD::size);
+            }
+    }
+
+    JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+
+    void processGeneric (const float* const* input,
+                         float* const* const* bands,
+                         const int numChannels,
+                         const int numSamples)
+    {
+        processWith<SIMDGeneric> (input, bands, numChannels, numSamples);
+    }
+
+#if IEM_SIMD_AVX2
+    IEM_TARGET_AVX2 void processAVX2 (const float* const* input,
+                                      float* const* const* bands,
+                                      const int numChannels,
+                                      const int numSamples)
+    {
+        processWith<SIMDAVX2> (input, bands, numChannels, numSamples);
+    }
+#endif
+
+#if IEM_SIMD_AVX512
+    IEM_TARGET_AVX512 void processAVX512 (const float* const* input,
+                                          float* const* const* bands,
+                                          const int numChannels,
+                                          const int numSamples)
+    {
+        processWith<SIMDAVX512> (input, bands, numChannels, numSamples);
+    }
+#endif
+
+    int numBands = 0;
+    int numCrossovers = 0;
+    int numSections = 0;
+    int numGroups = 0;
+    Operation operations[maxNumOperations];
+    int numOperations = 0;
+    Crossover crossovers[maxNumCrossovers]; // targets of a ramp
+    Crossover rampStart[maxNumCrossovers];
+    bool rampingEnabled = false;
+    bool isRamping = false;
+    static constexpr std::uintptr_t alignment = 64;
+    juce::HeapBlock<float> states;
+    float* alignedStates = nullptr;
+
+    SIMDTier tier = SIMDTier::generic;
+    ProcessFunction processFunction = &LinkwitzRileyCrossover::processGeneric;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinkwitzRileyCrossover)
+};
+
+} // namespace iem
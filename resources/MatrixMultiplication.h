@@ -62,6 +62,15 @@ public:
             return;
         }
 
+        // a diagonal matrix only scales the channels, which works in place
+        if (retainedCurrentMatrix->getStructure().type
+                == ReferenceCountedMatrix::Structure::Type::diagonal
+            && hasIdentityRouting (*retainedCurrentMatrix))
+        {
+            processDiagonalInPlace (*retainedCurrentMatrix, data);
+            return;
+        }
+
         auto& T = retainedCurrentMatrix->getMatrix();
 
         const int nInputChannels = juce::jmin (static_cast<int> (data.getNumChannels()),
@@ -105,22 +114,32 @@ public:
                                                static_cast<int> (T.getNumColumns()));
         const int nSamples = static_cast<int> (inputBlock.getNumSamples());
 
-        for (int row = 0; row < T.getNumRows(); ++row)
+        switch (retainedCurrentMatrix->getStructure().type)
         {
-            const int destCh = retainedCurrentMatrix->getRoutingArrayReference().getUnchecked (row);
-            if (destCh < outputBlock.getNumChannels())
-            {
-                float* dest = outputBlock.getChannelPointer (destCh);
-                juce::FloatVectorOperations::multiply (dest,
-                                                       inputBlock.getChannelPointer (0),
-                                                       T (row, 0),
-                                                       nSamples); // first channel
-                for (int i = 1; i < nInputChannels; ++i) // remaining channels
-                    juce::FloatVectorOperations::addWithMultiply (dest,
-                                                                  inputBlock.getChannelPointer (i),
-                                                                  T (row, i),
-                                                                  nSamples);
-            }
+            case ReferenceCountedMatrix::Structure::Type::permutation:
+            case ReferenceCountedMatrix::Structure::Type::diagonal:
+            case ReferenceCountedMatrix::Structure::Type::sparse:
+                processSparse (*retainedCurrentMatrix,
+                               inputBlock,
+                               outputBlock,
+                               nInputChannels,
+                               nSamples);
+                break;
+            case ReferenceCountedMatrix::Structure::Type::blockDiagonal:
+                processBlockDiagonal (*retainedCurrentMatrix,
+                                      inputBlock,
+                                      outputBlock,
+                                      nInputChannels,
+                                      nSamples);
+                break;
+            case ReferenceCountedMatrix::Structure::Type::dense:
+            default:
+                processDense (*retainedCurrentMatrix,
+                              inputBlock,
+                              outputBlock,
+                              nInputChannels,
+                              nSamples);
+                break;
         }
 
         juce::Array<int> routingCopy (retainedCurrentMatrix->getRoutingArrayReference());
@@ -177,6 +196,152 @@ public:
 
 private:
     //==============================================================================
+    void processDense (ReferenceCountedMatrix& matrix,
+                       const juce::dsp::AudioBlock<float>& inputBlock,
+                       juce::dsp::AudioBlock<float>& outputBlock,
+                       const int nInputChannels,
+                       const int nSamples)
+    {
+        auto& T = matrix.getMatrix();
+        auto& routing = matrix.getRoutingArrayReference();
+
+        for (int row = 0; row < T.getNumRows(); ++row)
+        {
+            const int destCh = routing.getUnchecked (row);
+            if (destCh < outputBlock.getNumChannels())
+            {
+                float* dest = outputBlock.getChannelPointer (destCh);
+                juce::FloatVectorOperations::multiply (dest,
+                                                       inputBlock.getChannelPointer (0),
+                                                       T (row, 0),
+                                                       nSamples); // first channel
+                for (int i = 1; i < nInputChannels; ++i) // remaining channels
+                    juce::FloatVectorOperations::addWithMultiply (dest,
+                                                                  inputBlock.getChannelPointer (i),
+                                                                  T (row, i),
+                                                                  nSamples);
+            }
+        }
+    }
+
+    /** Only the non-zero entries of each row, a row with a single entry of one is a copy. */
+    void processSparse (ReferenceCountedMatrix& matrix,
+                        const juce::dsp::AudioBlock<float>& inputBlock,
+                        juce::dsp::AudioBlock<float>& outputBlock,
+                        const int nInputChannels,
+                        const int nSamples)
+    {
+        auto& structure = matrix.getStructure();
+        auto& routing = matrix.getRoutingArrayReference();
+        const int nRows = static_cast<int> (structure.rowStart.size()) - 1;
+
+        for (int row = 0; row < nRows; ++row)
+        {
+            const int destCh = routing.getUnchecked (row);
+            if (destCh >= static_cast<int> (outputBlock.getNumChannels()))
+                continue;
+
+            float* dest = outputBlock.getChannelPointer (destCh);
+            bool isFirstEntry = true;
+
+            for (int i = structure.rowStart[static_cast<size_t> (row)];
+                 i < structure.rowStart[static_cast<size_t> (row + 1)];
+                 ++i)
+            {
+                const int col = structure.columns[static_cast<size_t> (i)];
+                if (col >= nInputChannels)
+                    break; // columns are sorted
+
+                const float value = structure.values[static_cast<size_t> (i)];
+                const float* src = inputBlock.getChannelPointer (col);
+                if (! isFirstEntry)
+                    juce::FloatVectorOperations::addWithMultiply (dest, src, value, nSamples);
+                else if (value == 1.0f)
+                    juce::FloatVectorOperations::copy (dest, src, nSamples);
+                else
+                    juce::FloatVectorOperations::multiply (dest, src, value, nSamples);
+
+                isFirstEntry = false;
+            }
+
+            if (isFirstEntry)
+                juce::FloatVectorOperations::clear (dest, nSamples);
+        }
+    }
+
+    /** Each block is multiplied densely, but only with the input channels of its columns. */
+    void processBlockDiagonal (ReferenceCountedMatrix& matrix,
+                               const juce::dsp::AudioBlock<float>& inputBlock,
+                               juce::dsp::AudioBlock<float>& outputBlock,
+                               const int nInputChannels,
+                               const int nSamples)
+    {
+        auto& T = matrix.getMatrix();
+        auto& routing = matrix.getRoutingArrayReference();
+
+        for (auto& block : matrix.getStructure().blocks)
+        {
+            const int endColumn =
+                juce::jmin (block.firstColumn + block.numColumns, nInputChannels);
+
+            for (int row = block.firstRow; row < block.firstRow + block.numRows; ++row)
+            {
+                const int destCh = routing.getUnchecked (row);
+                if (destCh >= static_cast<int> (outputBlock.getNumChannels()))
+                    continue;
+
+                float* dest = outputBlock.getChannelPointer (destCh);
+                if (block.firstColumn >= endColumn)
+                {
+                    juce::FloatVectorOperations::clear (dest, nSamples);
+                    continue;
+                }
+
+                juce::FloatVectorOperations::multiply (dest,
+                                                       inputBlock.getChannelPointer (
+                                                           block.firstColumn),
+                                                       T (row, block.firstColumn),
+                                                       nSamples);
+                for (int i = block.firstColumn + 1; i < endColumn; ++i)
+                    juce::FloatVectorOperations::addWithMultiply (dest,
+                                                                  inputBlock.getChannelPointer (i),
+                                                                  T (row, i),
+                                                                  nSamples);
+            }
+        }
+    }
+
+    static bool hasIdentityRouting (ReferenceCountedMatrix& matrix)
+    {
+        auto& routing = matrix.getRoutingArrayReference();
+        for (int row = 0; row < routing.size(); ++row)
+            if (routing.getUnchecked (row) != row)
+                return false;
+
+        return true;
+    }
+
+    /** Scales each channel by its diagonal entry, channels without one are cleared. */
+    void processDiagonalInPlace (ReferenceCountedMatrix& matrix, juce::dsp::AudioBlock<float>& data)
+    {
+        auto& structure = matrix.getStructure();
+        const int nRows = static_cast<int> (structure.rowStart.size()) - 1;
+        const int nSamples = static_cast<int> (data.getNumSamples());
+
+        for (int ch = 0; ch < static_cast<int> (data.getNumChannels()); ++ch)
+        {
+            float* channel = data.getChannelPointer (ch);
+            const int i = ch < nRows ? structure.rowStart[static_cast<size_t> (ch)] : -1;
+
+            if (i < 0 || i == structure.rowStart[static_cast<size_t> (ch + 1)])
+                juce::FloatVectorOperations::clear (channel, nSamples);
+            else if (structure.values[static_cast<size_t> (i)] != 1.0f)
+                juce::FloatVectorOperations::multiply (channel,
+                                                       structure.values[static_cast<size_t> (i)],
+                                                       nSamples);
+        }
+    }
+
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
     ReferenceCountedMatrix::Ptr currentMatrix { nullptr };
     ReferenceCountedMatrix::Ptr newMatrix { nullptr };
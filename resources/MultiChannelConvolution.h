@@ -0,0 +1,384 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+#include "../JuceLibraryCode/JuceHeader.h"
+
+using namespace juce::dsp;
+
+/**
+ Convolves each channel with its own FIR filter (uniformly partitioned overlap-save convolution).
+ The partition size is the next power of two of the maximum block size, which also is the
+ latency. All channels are convolved on the audio thread: waiting for worker threads within the
+ audio callback can't be bounded, and the complex multiply-adds of the partitions vectorize well
+ enough to stay within budget. Channels without a filter are only delayed by the latency.
+ New filters are transformed on the calling thread and taken over by the audio thread at the
+ next partition, the latency stays the same. The new filters start with the input spectra of the
+ previous ones, so they have their full tail right away, and their output is crossfaded with the
+ previous filters' output across that partition, which costs about twice the usual CPU time once.
+ Only a channel which had no filter before starts with an empty history, its tail builds up.
+ */
+class MultiChannelConvolution : private ProcessorBase
+{
+public:
+    static constexpr int maxNumChannels = 64;
+    static constexpr int maxFilterLength = 16384;
+
+    MultiChannelConvolution() {}
+
+    /**
+     Sets the filters, one channel per loudspeaker, longer filters are truncated. Don't call this
+     from the audio thread, the filters get transformed right away.
+     */
+    void setFilters (const juce::AudioBuffer<float>& newFilters)
+    {
+        const juce::ScopedLock designLock (designing);
+
+        const int nCh = juce::jmin (maxNumChannels, newFilters.getNumChannels());
+        const int length = juce::jmin (maxFilterLength, newFilters.getNumSamples());
+        filters.setSize (nCh, length);
+        for (int ch = 0; ch < nCh; ++ch)
+            filters.copyFrom (ch, 0, newFilters, ch, 0, length);
+        filtersLoaded = nCh > 0 && length > 0;
+
+        if (partitionSize == 0) // not prepared yet
+            return;
+
+        auto newKernel = createKernel();
+        const juce::SpinLock::ScopedLockType pendingLockGuard (pendingLock);
+        pending = std::move (newKernel);
+        newKernelAvailable = true;
+    }
+
+    bool hasFilters() const { return filtersLoaded.load(); }
+
+    /**
+     Switches between the filtered and the unfiltered signal, which is delayed by the same
+     latency. The switch is crossfaded within one partition, so it can be automated. Disabled
+     filters still transform the input, so their history is up to date when enabled again.
+     */
+    void setFiltersEnabled (const bool shouldBeEnabled) { filtersEnabled = shouldBeEnabled; }
+
+    /** Latency in samples, depends on the maximum block size passed to prepare(). */
+    int getLatencyInSamples() const { return partitionSize; }
+
+    void prepare (const juce::dsp::ProcessSpec& specs) override
+    {
+        const juce::ScopedLock designLock (designing);
+
+        const int blockSize = static_cast<int> (specs.maximumBlockSize);
+        partitionSize = juce::jlimit (64, 4096, juce::nextPowerOfTwo (blockSize));
+        numBins = partitionSize + 1;
+        const int fftOrder = juce::roundToInt (std::log2 (2 * partitionSize));
+
+        inputBuffer.setSize (maxNumChannels, 2 * partitionSize);
+        outputBuffer.setSize (maxNumChannels, partitionSize);
+
+        fft = std::make_unique<juce::dsp::FFT> (fftOrder);
+        spectrum.resize (static_cast<size_t> (2 * partitionSize));
+        accumulatorReal.resize (static_cast<size_t> (numBins));
+        accumulatorImag.resize (static_cast<size_t> (numBins));
+
+        crossfadeBuffer.resize (static_cast<size_t> (partitionSize));
+
+        kernel = createKernel();
+        previousKernel.reset();
+        pending.reset();
+        newKernelAvailable = false;
+
+        reset();
+    }
+
+    void process (const juce::dsp::ProcessContextReplacing<float>& context) override
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        auto abIn = context.getInputBlock();
+        auto abOut = context.getOutputBlock();
+        const int L = static_cast<int> (abIn.getNumSamples());
+        const int nCh = juce::jmin (maxNumChannels, static_cast<int> (abIn.getNumChannels()));
+
+        int done = 0;
+        while (done < L)
+        {
+            const int n = juce::jmin (L - done, partitionSize - fifoPosition);
+            for (int ch = 0; ch < nCh; ++ch)
+            {
+                juce::FloatVectorOperations::copy (
+                    inputBuffer.getWritePointer (ch, partitionSize + fifoPosition),
+                    abIn.getChannelPointer (ch) + done,
+                    n);
+                juce::FloatVectorOperations::copy (abOut.getChannelPointer (ch) + done,
+                                                   outputBuffer.getReadPointer (ch, fifoPosition),
+                                                   n);
+            }
+
+            done += n;
+            fifoPosition += n;
+            if (fifoPosition == partitionSize)
+            {
+                processPartition (nCh);
+                fifoPosition = 0;
+            }
+        }
+    }
+
+    void reset() override
+    {
+        inputBuffer.clear();
+        outputBuffer.clear();
+        fifoPosition = 0;
+        filterGain = filtersEnabled.load() ? 1.0f : 0.0f;
+
+        if (kernel != nullptr)
+            for (auto& channel : kernel->channels)
+                channel.clearDelayLine();
+    }
+
+private:
+    /** Frequency-domain filter partitions and input spectra of the channels with a filter. */
+    struct Kernel
+    {
+        struct Channel
+        {
+            void clearDelayLine()
+            {
+                std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+                delayLineHead = 0;
+            }
+
+            /** Takes over the latest input spectra of another filter, they don't depend on it. */
+            void copyDelayLineFrom (const Channel& other, const int numBins)
+            {
+                const int n = juce::jmin (numPartitions, other.numPartitions);
+                for (int p = 0; p < n; ++p)
+                {
+                    const int partition = (other.delayLineHead + p) % other.numPartitions;
+                    const auto* source = other.delayLine.data() + partition * numBins;
+                    std::copy (source, source + numBins, delayLine.data() + p * numBins);
+                }
+                delayLineHead = 0;
+            }
+
+            int numPartitions = 0;
+            std::vector<std::complex<float>> partitions;
+            std::vector<std::complex<float>> delayLine;
+            int delayLineHead = 0;
+        };
+
+        std::vector<Channel> channels;
+    };
+
+    std::unique_ptr<Kernel> createKernel()
+    {
+        auto newKernel = std::make_unique<Kernel>();
+        newKernel->channels.resize (static_cast<size_t> (filters.getNumChannels()));
+
+        juce::dsp::FFT fft (juce::roundToInt (std::log2 (2 * partitionSize)));
+        std::vector<std::complex<float>> buffer (static_cast<size_t> (2 * partitionSize));
+        float* data = reinterpret_cast<float*> (buffer.data());
+
+        for (int ch = 0; ch < filters.getNumChannels(); ++ch)
+        {
+            // trailing zeros don't need partitions
+            const float* filter = filters.getReadPointer (ch);
+            int length = filters.getNumSamples();
+            while (length > 0 && filter[length - 1] == 0.0f)
+                --length;
+
+            auto& channel = newKernel->channels[static_cast<size_t> (ch)];
+            channel.numPartitions = (length + partitionSize - 1) / partitionSize;
+            const size_t size = static_cast<size_t> (channel.numPartitions * numBins);
+            channel.partitions.resize (size);
+            channel.delayLine.assign (size, 0.0f);
+
+            for (int p = 0; p < channel.numPartitions; ++p)
+            {
+                const int start = p * partitionSize;
+                const int n = juce::jmin (partitionSize, length - start);
+                juce::FloatVectorOperations::clear (data, 4 * partitionSize);
+                juce::FloatVectorOperations::copy (data, filter + start, n);
+                fft.performRealOnlyForwardTransform (data, true);
+                std::copy (buffer.begin(),
+                           buffer.begin() + numBins,
+                           channel.partitions.begin() + p * numBins);
+            }
+        }
+
+        return newKernel;
+    }
+
+    /** Returns true if a new kernel was taken over, the replaced one is kept in previousKernel. */
+    bool pullNewKernel()
+    {
+        const juce::SpinLock::ScopedTryLockType pendingLockGuard (pendingLock);
+        if (! pendingLockGuard.isLocked() || ! newKernelAvailable)
+            return false;
+
+        // the kernel replaced before gets freed by the next call of setFilters()
+        std::swap (previousKernel, kernel);
+        std::swap (kernel, pending);
+        newKernelAvailable = false;
+
+        if (previousKernel != nullptr)
+        {
+            const size_t n = juce::jmin (kernel->channels.size(), previousKernel->channels.size());
+            for (size_t ch = 0; ch < n; ++ch)
+                if (previousKernel->channels[ch].numPartitions > 0
+                    && kernel->channels[ch].numPartitions > 0)
+                    kernel->channels[ch].copyDelayLineFrom (previousKernel->channels[ch], numBins);
+        }
+
+        return true;
+    }
+
+    void processPartition (const int nCh)
+    {
+        const bool crossfadeKernels = pullNewKernel() && previousKernel != nullptr;
+
+        const float startGain = filterGain;
+        filterGain = filtersEnabled.load() ? 1.0f : 0.0f;
+
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            float* output = outputBuffer.getWritePointer (ch);
+            convolveChannel (*kernel, ch, startGain, filterGain, output);
+
+            if (crossfadeKernels)
+            {
+                float* previousOutput = crossfadeBuffer.data();
+                convolveChannel (*previousKernel, ch, startGain, filterGain, previousOutput);
+
+                const float increment = 1.0f / partitionSize;
+                for (int i = 0; i < partitionSize; ++i)
+                    output[i] = previousOutput[i]
+                                + (i * increment) * (output[i] - previousOutput[i]);
+            }
+
+            // keeping the current partition as first half of the next one
+            float* input = inputBuffer.getWritePointer (ch);
+            juce::FloatVectorOperations::copy (input, input + partitionSize, partitionSize);
+        }
+    }
+
+    /**
+     Convolves a channel with the filter of the given kernel, the output is faded from startGain
+     to endGain of the filtered signal.
+     */
+    void convolveChannel (Kernel& filterKernel,
+                          const int ch,
+                          const float startGain,
+                          const float endGain,
+                          float* output)
+    {
+        const float* input = inputBuffer.getReadPointer (ch);
+
+        const bool hasFilter = ch < static_cast<int> (filterKernel.channels.size())
+                               && filterKernel.channels[static_cast<size_t> (ch)].numPartitions > 0;
+
+        if (! hasFilter)
+        {
+            juce::FloatVectorOperations::copy (output, input + partitionSize, partitionSize);
+            return;
+        }
+
+        auto& channel = filterKernel.channels[static_cast<size_t> (ch)];
+        const int numPartitions = channel.numPartitions;
+        channel.delayLineHead = (channel.delayLineHead + numPartitions - 1) % numPartitions;
+        const int head = channel.delayLineHead;
+
+        auto* bins = spectrum.data();
+        float* data = reinterpret_cast<float*> (bins);
+        juce::FloatVectorOperations::copy (data, input, 2 * partitionSize);
+        fft->performRealOnlyForwardTransform (data, true);
+        std::copy (bins, bins + numBins, channel.delayLine.data() + head * numBins);
+
+        const float* dry = input + partitionSize;
+        if (startGain == 0.0f && endGain == 0.0f)
+        {
+            juce::FloatVectorOperations::copy (output, dry, partitionSize);
+            return;
+        }
+
+        // real and imaginary parts are accumulated separately, std::complex's multiplication
+        // checks for infinities and keeps the loop from being vectorized
+        float* accReal = accumulatorReal.data();
+        float* accImag = accumulatorImag.data();
+        juce::FloatVectorOperations::clear (accReal, numBins);
+        juce::FloatVectorOperations::clear (accImag, numBins);
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            const auto* H = reinterpret_cast<const float*> (channel.partitions.data() + p * numBins);
+            const auto* X = reinterpret_cast<const float*> (
+                channel.delayLine.data() + ((head + p) % numPartitions) * numBins);
+            for (int k = 0; k < numBins; ++k)
+            {
+                const float xr = X[2 * k], xi = X[2 * k + 1];
+                const float hr = H[2 * k], hi = H[2 * k + 1];
+                accReal[k] += xr * hr - xi * hi;
+                accImag[k] += xr * hi + xi * hr;
+            }
+        }
+
+        for (int k = 0; k < numBins; ++k)
+            bins[k] = { accReal[k], accImag[k] };
+
+        // the second half of the inverse transform is free of circular aliasing
+        fft->performRealOnlyInverseTransform (data);
+        const float* wet = data + partitionSize;
+
+        if (startGain == 1.0f && endGain == 1.0f)
+        {
+            juce::FloatVectorOperations::copy (output, wet, partitionSize);
+            return;
+        }
+
+        const float increment = (endGain - startGain) / partitionSize;
+        for (int i = 0; i < partitionSize; ++i)
+            output[i] = dry[i] + (startGain + i * increment) * (wet[i] - dry[i]);
+    }
+
+    //==============================================================================
+    int partitionSize = 0;
+    int numBins = 0;
+
+    juce::CriticalSection designing;
+    juce::AudioBuffer<float> filters;
+    std::atomic<bool> filtersLoaded { false };
+    std::atomic<bool> filtersEnabled { true };
+
+    juce::SpinLock pendingLock;
+    std::unique_ptr<Kernel> pending;
+    bool newKernelAvailable = false;
+
+    // audio thread
+    std::unique_ptr<Kernel> kernel, previousKernel;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<float> accumulatorReal, accumulatorImag;
+    std::vector<float> crossfadeBuffer; // output of the previous kernel while crossfading
+    float filterGain = 1.0f; // of the filtered signal at the end of the last partition
+
+    juce::AudioBuffer<float> inputBuffer, outputBuffer;
+    int fifoPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiChannelConvolution)
+};
@@ -25,6 +25,13 @@
 
 using namespace juce::dsp;
 
+/**
+ Delays each channel by its own delay time. All channels share one contiguous buffer, which is
+ allocated in prepare() for the maximum delay time.
+ With fractional delays enabled, the delay times aren't rounded to samples but interpolated
+ (third-order Lagrange, linear below one sample). Changing a delay time crossfades from the old
+ to the new delay time, so there are no jumps in the output signal.
+ */
 template <typename FloatType>
 class MultiChannelDelay : private ProcessorBase
 {
@@ -38,16 +45,10 @@ public:
 
         if (channel < numChannels)
         {
-            if (delayTimeInSeconds <= 0.0f)
-            {
-                delayInSeconds.setUnchecked (channel, 0.0f);
-            }
-            else
-            {
-                delayInSeconds.setUnchecked (channel, delayTimeInSeconds);
-            }
-            delayInSamples.setUnchecked (channel,
-                                         delayInSeconds.getUnchecked (channel) * spec.sampleRate);
+            const float delay = juce::jlimit (0.0f, maxDelay, delayTimeInSeconds);
+            delayInSeconds.setUnchecked (channel, delay);
+            targetDelayInSamples.setUnchecked (channel,
+                                               delay * static_cast<float> (spec.sampleRate));
         }
     }
 
@@ -55,24 +56,48 @@ public:
     {
         jassert (channel < numChannels);
         if (channel < numChannels)
-            return delayInSamples[channel];
+            return static_cast<int> (targetDelayInSamples[channel]);
         else
             return 0;
     }
 
-    void setMaxDelayTime (const int maxDelayTimeInSeconds) { maxDelay = maxDelayTimeInSeconds; }
+    /** Takes effect with the next call of prepare(). */
+    void setMaxDelayTime (const float maxDelayTimeInSeconds) { maxDelay = maxDelayTimeInSeconds; }
+
+    /** If disabled, delay times are truncated to whole samples. */
+    void setFractionalDelays (const bool shouldUseFractionalDelays)
+    {
+        fractionalDelays = shouldUseFractionalDelays;
+    }
+
+    /** Crossfade time between old and new delay time, takes effect with the next prepare(). */
+    void setCrossfadeTime (const float crossfadeTimeInSeconds)
+    {
+        crossfadeTime = crossfadeTimeInSeconds;
+    }
 
     void prepare (const juce::dsp::ProcessSpec& specs) override
     {
         spec = specs;
-
-        const int maxDelayInSamples = specs.sampleRate * maxDelay;
-        buffer.setSize (specs.numChannels, specs.maximumBlockSize + maxDelayInSamples);
-        buffer.clear();
-        writePosition = 0;
         numChannels = specs.numChannels;
+
+        // interpolation reads up to two samples beyond the delay time
+        const int maxDelayInSamples = static_cast<int> (std::ceil (specs.sampleRate * maxDelay));
+        channelLength = static_cast<int> (specs.maximumBlockSize) + maxDelayInSamples + 2;
+        arena.assign (static_cast<size_t> (numChannels * channelLength), FloatType (0));
+        scratch.resize (specs.maximumBlockSize);
+
+        crossfadeLength = juce::jmax (1, static_cast<int> (crossfadeTime * specs.sampleRate));
+
         delayInSeconds.resize (numChannels);
-        delayInSamples.resize (numChannels);
+        targetDelayInSamples.resize (numChannels);
+        heads.resize (numChannels);
+        for (int ch = 0; ch < numChannels; ++ch)
+            targetDelayInSamples.setUnchecked (ch,
+                                               delayInSeconds.getUnchecked (ch)
+                                                   * static_cast<float> (specs.sampleRate));
+
+        reset();
     }
 
     void process (const juce::dsp::ProcessContextReplacing<FloatType>& context) override
@@ -81,77 +106,183 @@ public:
 
         auto abIn = context.getInputBlock();
         auto abOut = context.getOutputBlock();
-        auto L = abIn.getNumSamples();
-        auto nCh = abIn.getNumChannels();
+        const int L = static_cast<int> (abIn.getNumSamples());
+        const int nCh = juce::jmin (numChannels, static_cast<int> (abIn.getNumChannels()));
+
+        jassert (L <= static_cast<int> (scratch.size()));
 
         // write in delay line
         int startIndex, blockSize1, blockSize2;
-        getWritePositions ((int) L, startIndex, blockSize1, blockSize2);
+        getWritePositions (L, startIndex, blockSize1, blockSize2);
 
-        for (int ch = 0; ch < nCh; ch++)
-            buffer.copyFrom (ch, startIndex, abIn.getChannelPointer (ch), blockSize1);
+        for (int ch = 0; ch < nCh; ++ch)
+        {
+            juce::FloatVectorOperations::copy (getChannel (ch) + startIndex,
+                                               abIn.getChannelPointer (ch),
+                                               blockSize1);
 
-        if (blockSize2 > 0)
-            for (int ch = 0; ch < nCh; ch++)
-                buffer.copyFrom (ch, 0, abIn.getChannelPointer (ch) + blockSize1, blockSize2);
+            if (blockSize2 > 0)
+                juce::FloatVectorOperations::copy (getChannel (ch),
+                                                   abIn.getChannelPointer (ch) + blockSize1,
+                                                   blockSize2);
+        }
 
         // read from delay line
-        for (int ch = 0; ch < nCh; ch++)
+        for (int ch = 0; ch < nCh; ++ch)
         {
-            int startIndex, blockSize1, blockSize2;
-            getReadPositions (ch, (int) L, startIndex, blockSize1, blockSize2);
+            auto& head = heads.getReference (ch);
+            FloatType* out = abOut.getChannelPointer (ch);
 
-            juce::FloatVectorOperations::copy (abOut.getChannelPointer (ch),
-                                               buffer.getReadPointer (ch) + startIndex,
-                                               blockSize1);
+            const float target = getQuantisedDelay (targetDelayInSamples.getUnchecked (ch));
+            if (! head.isFading() && target != head.current)
+            {
+                head.next = target;
+                head.fadePosition = 0;
+            }
 
-            if (blockSize2 > 0)
-                juce::FloatVectorOperations::copy (abOut.getChannelPointer (ch) + blockSize1,
-                                                   buffer.getReadPointer (ch),
-                                                   blockSize2);
+            readHead (ch, head.current, out, L);
+
+            if (head.isFading())
+            {
+                FloatType* next = scratch.data();
+                readHead (ch, head.next, next, L);
+
+                const int numFading = juce::jmin (L, crossfadeLength - head.fadePosition);
+                const FloatType step = FloatType (1) / crossfadeLength;
+                FloatType fade = (head.fadePosition + 1) * step;
+                for (int i = 0; i < numFading; ++i)
+                {
+                    out[i] += fade * (next[i] - out[i]);
+                    fade += step;
+                }
+
+                if (numFading < L)
+                    juce::FloatVectorOperations::copy (out + numFading,
+                                                       next + numFading,
+                                                       L - numFading);
+
+                head.fadePosition += numFading;
+                if (head.fadePosition >= crossfadeLength)
+                {
+                    head.current = head.next;
+                    head.fadePosition = -1;
+                }
+            }
         }
 
         writePosition += L;
-        writePosition = writePosition % buffer.getNumSamples();
+        writePosition = writePosition % channelLength;
     }
 
-    void reset() override {}
+    void reset() override
+    {
+        std::fill (arena.begin(), arena.end(), FloatType (0));
+        writePosition = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& head = heads.getReference (ch);
+            head.current = getQuantisedDelay (targetDelayInSamples.getUnchecked (ch));
+            head.fadePosition = -1;
+        }
+    }
 
     void getWritePositions (int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
     {
-        const int L = buffer.getNumSamples();
-        int pos = writePosition;
-        if (pos < 0)
-            pos = pos + L;
-        pos = pos % L;
+        getPositions (writePosition, numSamples, startIndex, blockSize1, blockSize2);
+    }
 
-        jassert (pos >= 0 && pos < L);
+    void getReadPositions (const int delayInSamples,
+                           int numSamples,
+                           int& startIndex,
+                           int& blockSize1,
+                           int& blockSize2)
+    {
+        getPositions (writePosition - delayInSamples,
+                      numSamples,
+                      startIndex,
+                      blockSize1,
+                      blockSize2);
+    }
 
-        if (numSamples <= 0)
+private:
+    struct ReadHead
+    {
+        bool isFading() const { return fadePosition >= 0; }
+
+        float current = 0.0f;
+        float next = 0.0f;
+        int fadePosition = -1;
+    };
+
+    FloatType* getChannel (const int channel) { return arena.data() + channel * channelLength; }
+
+    float getQuantisedDelay (const float delay) const
+    {
+        return fractionalDelays ? delay : std::floor (delay);
+    }
+
+    /** Reads the whole block with one delay time, interpolating between the taps. */
+    void readHead (const int channel, const float delay, FloatType* dest, const int numSamples)
+    {
+        const int delayInt = static_cast<int> (delay);
+        const FloatType f = static_cast<FloatType> (delay - delayInt);
+
+        if (f == FloatType (0))
         {
-            startIndex = 0;
-            blockSize1 = 0;
-            blockSize2 = 0;
+            readTap (channel, delayInt, FloatType (1), dest, numSamples, false);
+        }
+        else if (delayInt == 0) // no future sample available, linear interpolation
+        {
+            readTap (channel, 0, FloatType (1) - f, dest, numSamples, false);
+            readTap (channel, 1, f, dest, numSamples, true);
         }
         else
         {
-            startIndex = pos;
-            blockSize1 = juce::jmin (L - pos, numSamples);
-            numSamples -= blockSize1;
-            blockSize2 = numSamples <= 0 ? 0 : numSamples;
+            const FloatType fm1 = f - FloatType (1);
+            const FloatType fm2 = f - FloatType (2);
+            const FloatType fp1 = f + FloatType (1);
+            readTap (channel, delayInt - 1, -f * fm1 * fm2 / 6, dest, numSamples, false);
+            readTap (channel, delayInt, fp1 * fm1 * fm2 / 2, dest, numSamples, true);
+            readTap (channel, delayInt + 1, -fp1 * f * fm2 / 2, dest, numSamples, true);
+            readTap (channel, delayInt + 2, fp1 * f * fm1 / 6, dest, numSamples, true);
         }
     }
 
-    void getReadPositions (const int channel,
-                           int numSamples,
-                           int& startIndex,
-                           int& blockSize1,
-                           int& blockSize2)
+    void readTap (const int channel,
+                  const int delayInSamples,
+                  const FloatType weight,
+                  FloatType* dest,
+                  const int numSamples,
+                  const bool accumulate)
+    {
+        int startIndex, blockSize1, blockSize2;
+        getReadPositions (delayInSamples, numSamples, startIndex, blockSize1, blockSize2);
+
+        const FloatType* src = getChannel (channel);
+        readTapSegment (dest, src + startIndex, weight, blockSize1, accumulate);
+
+        if (blockSize2 > 0)
+            readTapSegment (dest + blockSize1, src, weight, blockSize2, accumulate);
+    }
+
+    static void readTapSegment (FloatType* dest,
+                                const FloatType* src,
+                                const FloatType weight,
+                                const int numSamples,
+                                const bool accumulate)
     {
-        jassert (channel < delayInSamples.size());
-        const int L = buffer.getNumSamples();
-        int pos = writePosition - delayInSamples.getUnchecked (channel);
+        if (accumulate)
+            juce::FloatVectorOperations::addWithMultiply (dest, src, weight, numSamples);
+        else if (weight == FloatType (1))
+            juce::FloatVectorOperations::copy (dest, src, numSamples);
+        else
+            juce::FloatVectorOperations::copyWithMultiply (dest, src, weight, numSamples);
+    }
 
+    void getPositions (int pos, int numSamples, int& startIndex, int& blockSize1, int& blockSize2)
+    {
+        const int L = channelLength;
         if (pos < 0)
             pos = pos + L;
         pos = pos % L;
@@ -173,16 +304,21 @@ public:
         }
     }
 
-private:
     //==============================================================================
     juce::dsp::ProcessSpec spec = { -1, 0, 0 };
 
     juce::Array<float> delayInSeconds;
-    juce::Array<int> delayInSamples;
+    juce::Array<float> targetDelayInSamples;
+    juce::Array<ReadHead> heads;
 
     float maxDelay = 1.0f;
+    float crossfadeTime = 0.05f;
+    int crossfadeLength = 1;
+    bool fractionalDelays = false;
     int numChannels = 0;
 
     int writePosition = 0;
-    juce::AudioBuffer<FloatType> buffer;
+    int channelLength = 1;
+    std::vector<FloatType> arena;
+    std::vector<FloatType> scratch;
 };
@@ -0,0 +1,568 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#include "IncrementalHull3D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+// points closer to a face's plane than this count as lying on it
+constexpr double planeTolerance = 1.0e-6;
+
+// neighbouring faces closer to coplanar than this (and points that close to the hull's surface)
+// could be triangulated either way, depending on the order of the edits, so they're left to a
+// build from scratch
+constexpr double coplanarTolerance = 1.0e-4;
+} // namespace
+
+//==============================================================================
+bool IncrementalHull3D::update (const std::vector<R3>& newPoints)
+{
+    const int n = static_cast<int> (newPoints.size());
+    const int m = getNumPoints();
+
+    // a local edit of an ambiguous hull would most likely end up ambiguous and rebuilt anyway
+    if (! valid || ambiguous || std::abs (n - m) > 1)
+        return build (newPoints);
+
+    if (n == m)
+    {
+        std::vector<int> moved;
+        for (int i = 0; i < n; ++i)
+            if (toPoint (newPoints[i]) != points[i])
+                moved.push_back (i);
+
+        if (static_cast<int> (moved.size()) > maxNumLocalMoves)
+            return build (newPoints);
+
+        for (const int i : moved)
+            movePoint (i, newPoints[i]);
+
+        return valid;
+    }
+
+    // a single point was inserted or removed: find it, all others have to be unchanged
+    const int numCommon = std::min (n, m);
+    int index = 0;
+    while (index < numCommon && toPoint (newPoints[index]) == points[index])
+        ++index;
+
+    if (n > m)
+    {
+        for (int i = index; i < m; ++i)
+            if (toPoint (newPoints[i + 1]) != points[i])
+                return build (newPoints);
+
+        return insertPoint (index, newPoints[index]);
+    }
+
+    for (int i = index; i < n; ++i)
+        if (toPoint (newPoints[i]) != points[i + 1])
+            return build (newPoints);
+
+    return removePoint (index);
+}
+
+bool IncrementalHull3D::build (const std::vector<R3>& newPoints)
+{
+    points.clear();
+    for (const auto& p : newPoints)
+        points.push_back (toPoint (p));
+
+    return buildFromScratch();
+}
+
+bool IncrementalHull3D::insertPoint (const int index, const R3& point)
+{
+    points.insert (points.begin() + index, toPoint (point));
+    shiftIndices (index, 1);
+
+    if (valid)
+    {
+        const int firstNewFace = insertLocally (index);
+        if (firstNewFace >= 0 && isConvex (firstNewFace))
+            return finishLocalEdit();
+    }
+
+    return buildFromScratch();
+}
+
+bool IncrementalHull3D::removePoint (const int index)
+{
+    const int firstNewFace = valid ? removeLocally (index) : -1;
+
+    points.erase (points.begin() + index);
+    shiftIndices (index + 1, -1);
+
+    if (firstNewFace >= 0 && isConvex (firstNewFace))
+        return finishLocalEdit();
+
+    return buildFromScratch();
+}
+
+bool IncrementalHull3D::movePoint (const int index, const R3& point)
+{
+    if (valid)
+    {
+        // the removed point is still stored, so it's left out of the check
+        const int firstNewFace = removeLocally (index);
+        if (firstNewFace >= 0 && isConvex (firstNewFace, index))
+        {
+            points[static_cast<size_t> (index)] = toPoint (point);
+            const int firstInsertedFace = insertLocally (index);
+            if (firstInsertedFace >= 0 && isConvex (firstInsertedFace))
+                return finishLocalEdit();
+        }
+    }
+
+    points[static_cast<size_t> (index)] = toPoint (point);
+    return buildFromScratch();
+}
+
+//==============================================================================
+R3 IncrementalHull3D::toR3 (const int index) const
+{
+    const auto& p = points[static_cast<size_t> (index)];
+    R3 r3 (p.x, p.y, p.z);
+    r3.id = index;
+    r3.lspNum = index;
+    r3.azimuth = 0.0f;
+    r3.elevation = 0.0f;
+    r3.radius = 1.0f;
+    r3.isImaginary = false;
+    r3.gain = 1.0f;
+    return r3;
+}
+
+void IncrementalHull3D::normal (const Face& face, double& nx, double& ny, double& nz) const
+{
+    const auto& a = points[static_cast<size_t> (face.a)];
+    const auto& b = points[static_cast<size_t> (face.b)];
+    const auto& c = points[static_cast<size_t> (face.c)];
+
+    const double abx = b.x - a.x, aby = b.y - a.y, abz = b.z - a.z;
+    const double acx = c.x - a.x, acy = c.y - a.y, acz = c.z - a.z;
+
+    nx = aby * acz - abz * acy;
+    ny = abz * acx - abx * acz;
+    nz = abx * acy - aby * acx;
+}
+
+double IncrementalHull3D::signedDistance (const Face& face, const Point& p) const
+{
+    double nx, ny, nz;
+    normal (face, nx, ny, nz);
+    const double length = std::sqrt (nx * nx + ny * ny + nz * nz);
+    if (length == 0.0)
+        return 0.0;
+
+    const auto& a = points[static_cast<size_t> (face.a)];
+    return (nx * (p.x - a.x) + ny * (p.y - a.y) + nz * (p.z - a.z)) / length;
+}
+
+bool IncrementalHull3D::isVisible (const Face& face, const Point& p) const
+{
+    return signedDistance (face, p) > planeTolerance;
+}
+
+bool IncrementalHull3D::buildFromScratch()
+{
+    faces.clear();
+    triangles.clear();
+    valid = false;
+    ambiguous = false;
+
+    const int n = getNumPoints();
+    if (n < 4)
+        return false;
+
+    std::vector<R3> sorted;
+    sorted.reserve (points.size());
+    double cx = 0.0, cy = 0.0, cz = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        const auto& p = points[static_cast<size_t> (i)];
+        sorted.push_back (toR3 (i));
+
+        cx += p.x;
+        cy += p.y;
+        cz += p.z;
+    }
+
+    std::vector<Tri> hull;
+    // degenerate point sets (e.g. all of them in one plane) can give an empty hull
+    if (NewtonApple_hull_3D (sorted, hull) != 1 || hull.size() < 4)
+        return false;
+
+    // the centroid lies within the hull, all normals have to point away from it
+    const Point centroid { static_cast<float> (cx / n),
+                           static_cast<float> (cy / n),
+                           static_cast<float> (cz / n) };
+    for (const auto& tri : hull)
+    {
+        Face face { sorted[static_cast<size_t> (tri.a)].id,
+                    sorted[static_cast<size_t> (tri.b)].id,
+                    sorted[static_cast<size_t> (tri.c)].id };
+        if (signedDistance (face, centroid) > 0.0)
+            std::swap (face.b, face.c);
+        faces.push_back (face);
+    }
+
+    valid = true;
+    updateTriangles();
+    ambiguous = isAmbiguous();
+    return true;
+}
+
+int IncrementalHull3D::insertLocally (const int index)
+{
+    const auto& p = points[static_cast<size_t> (index)];
+
+    std::vector<Face> keptFaces;
+    std::vector<Edge> visibleEdges;
+    for (const auto& face : faces)
+    {
+        if (isVisible (face, p))
+        {
+            visibleEdges.push_back ({ face.a, face.b });
+            visibleEdges.push_back ({ face.b, face.c });
+            visibleEdges.push_back ({ face.c, face.a });
+        }
+        else
+            keptFaces.push_back (face);
+    }
+
+    if (visibleEdges.empty()) // the point lies within the hull
+        return static_cast<int> (faces.size());
+
+    // the horizon consists of the visible faces' edges shared with invisible ones, each of them
+    // gets connected to the new point
+    std::vector<Edge> horizon;
+    for (const auto& edge : visibleEdges)
+        if (! contains (visibleEdges, { edge.second, edge.first }))
+            horizon.push_back (edge);
+
+    if (! isSingleCycle (horizon))
+        return -1;
+
+    const int firstNewFace = static_cast<int> (keptFaces.size());
+    for (const auto& edge : horizon)
+        keptFaces.push_back ({ edge.first, edge.second, index });
+
+    faces.swap (keptFaces);
+    return firstNewFace;
+}
+
+int IncrementalHull3D::removeLocally (const int index)
+{
+    const int n = getNumPoints();
+    const auto& p = points[static_cast<size_t> (index)];
+
+    std::vector<Face> keptFaces;
+    std::vector<Edge> border; // edges of the hole, oriented as in the removed faces
+    std::vector<char> isOnHull (static_cast<size_t> (n), 0);
+    for (const auto& face : faces)
+    {
+        for (const int v : { face.a, face.b, face.c })
+            isOnHull[static_cast<size_t> (v)] = 1;
+
+        if (face.a == index)
+            border.push_back ({ face.b, face.c });
+        else if (face.b == index)
+            border.push_back ({ face.c, face.a });
+        else if (face.c == index)
+            border.push_back ({ face.a, face.b });
+        else
+            keptFaces.push_back (face);
+    }
+
+    if (border.empty()) // the point lies within the hull, removing it changes nothing
+        return static_cast<int> (faces.size());
+
+    // the hole gets filled with the faces of the candidates' hull which are visible from the
+    // removed point, candidates are the hole's border and all points within the hull
+    std::vector<char> isCandidate (static_cast<size_t> (n), 0);
+    for (const auto& edge : border)
+        isCandidate[static_cast<size_t> (edge.first)] = 1;
+
+    std::vector<int> candidates;
+    for (int i = 0; i < n; ++i)
+    {
+        const auto k = static_cast<size_t> (i);
+        if (i != index && (isCandidate[k] || ! isOnHull[k]))
+            candidates.push_back (i);
+    }
+
+    std::vector<Face> newFaces;
+    if (candidates.size() < 3)
+        return -1;
+    else if (candidates.size() == 3)
+    {
+        Face face { candidates[0], candidates[1], candidates[2] };
+        if (signedDistance (face, p) < 0.0)
+            std::swap (face.b, face.c);
+        newFaces.push_back (face);
+    }
+    else
+    {
+        std::vector<R3> subset;
+        double cx = 0.0, cy = 0.0, cz = 0.0;
+        for (const int i : candidates)
+        {
+            const auto& q = points[static_cast<size_t> (i)];
+            subset.push_back (toR3 (i));
+
+            cx += q.x;
+            cy += q.y;
+            cz += q.z;
+        }
+
+        std::vector<Tri> subHull;
+        if (NewtonApple_hull_3D (subset, subHull) != 1)
+            return -1;
+
+        const double numCandidates = static_cast<double> (candidates.size());
+        const Point centroid { static_cast<float> (cx / numCandidates),
+                               static_cast<float> (cy / numCandidates),
+                               static_cast<float> (cz / numCandidates) };
+        for (const auto& tri : subHull)
+        {
+            Face face { subset[static_cast<size_t> (tri.a)].id,
+                        subset[static_cast<size_t> (tri.b)].id,
+                        subset[static_cast<size_t> (tri.c)].id };
+            if (signedDistance (face, centroid) > 0.0)
+                std::swap (face.b, face.c);
+
+            if (isVisible (face, p))
+                newFaces.push_back (face);
+        }
+    }
+
+    // the new faces have to fill the hole exactly: each of their edges is either shared with
+    // another new face or one of the border's edges, and every border edge is covered once
+    std::vector<Edge> newEdges;
+    for (const auto& face : newFaces)
+    {
+        newEdges.push_back ({ face.a, face.b });
+        newEdges.push_back ({ face.b, face.c });
+        newEdges.push_back ({ face.c, face.a });
+    }
+
+    auto sortedEdges = newEdges;
+    std::sort (sortedEdges.begin(), sortedEdges.end());
+    if (std::adjacent_find (sortedEdges.begin(), sortedEdges.end()) != sortedEdges.end())
+        return -1;
+
+    size_t numBorderEdges = 0;
+    for (const auto& edge : newEdges)
+    {
+        if (contains (newEdges, { edge.second, edge.first }))
+            continue;
+
+        if (! contains (border, edge))
+            return -1;
+
+        ++numBorderEdges;
+    }
+
+    if (numBorderEdges != border.size())
+        return -1;
+
+    const int firstNewFace = static_cast<int> (keptFaces.size());
+    keptFaces.insert (keptFaces.end(), newFaces.begin(), newFaces.end());
+    faces.swap (keptFaces);
+    return firstNewFace;
+}
+
+bool IncrementalHull3D::isConvex (const int firstNewFace, const int ignoredPoint) const
+{
+    // the other faces haven't changed and still support the hull
+    const int n = getNumPoints();
+    for (size_t f = static_cast<size_t> (firstNewFace); f < faces.size(); ++f)
+        for (int i = 0; i < n; ++i)
+            if (i != ignoredPoint && isVisible (faces[f], points[static_cast<size_t> (i)]))
+                return false;
+
+    return true;
+}
+
+bool IncrementalHull3D::contains (const std::vector<Edge>& edges, const Edge& edge)
+{
+    return std::find (edges.begin(), edges.end(), edge) != edges.end();
+}
+
+bool IncrementalHull3D::isSingleCycle (const std::vector<Edge>& edges)
+{
+    if (edges.size() < 3)
+        return false;
+
+    // follow the edges from the first one, each step has to continue with a unique edge
+    int current = edges.front().second;
+    for (size_t step = 1; step < edges.size(); ++step)
+    {
+        int numNext = 0;
+        int next = -1;
+        for (const auto& edge : edges)
+            if (edge.first == current)
+            {
+                ++numNext;
+                next = edge.second;
+            }
+
+        if (numNext != 1 || current == edges.front().first)
+            return false;
+
+        current = next;
+    }
+
+    return current == edges.front().first;
+}
+
+void IncrementalHull3D::shiftIndices (const int from, const int offset)
+{
+    for (auto& face : faces)
+        for (int* v : { &face.a, &face.b, &face.c })
+            if (*v >= from)
+                *v += offset;
+}
+
+bool IncrementalHull3D::finishLocalEdit()
+{
+    updateTriangles();
+
+    // the triangulation of coplanar faces (e.g. the quads of a cube) and points on the hull's
+    // surface depend on the edits which led to them, only a build from scratch gives the same
+    // triangles for the same points
+    if (isAmbiguous())
+        return buildFromScratch();
+
+    ambiguous = false;
+    return true;
+}
+
+bool IncrementalHull3D::isAmbiguous() const
+{
+    const auto isOnPlane = [this] (const Face& face, const int v)
+    {
+        return v != face.a && v != face.b && v != face.c
+               && std::abs (signedDistance (face, points[static_cast<size_t> (v)]))
+                      <= coplanarTolerance;
+    };
+
+    std::vector<bool> isVertex (points.size(), false);
+    for (const auto& tri : triangles)
+    {
+        const auto& face = faces[static_cast<size_t> (tri.id)];
+        for (const int v : { face.a, face.b, face.c })
+            isVertex[static_cast<size_t> (v)] = true;
+
+        for (const int f : { tri.ab, tri.bc, tri.ac })
+        {
+            if (f < 0)
+                continue;
+
+            const auto& other = faces[static_cast<size_t> (f)];
+            for (const int v : { other.a, other.b, other.c })
+                if (isOnPlane (face, v))
+                    return true;
+        }
+    }
+
+    // all other points lie inside the hull, on a face's plane means on the hull's surface
+    for (const auto& face : faces)
+        for (int v = 0; v < getNumPoints(); ++v)
+            if (! isVertex[static_cast<size_t> (v)] && isOnPlane (face, v))
+                return true;
+
+    return false;
+}
+
+void IncrementalHull3D::updateTriangles()
+{
+    // canonical order, so the triangles don't depend on how the hull was computed: each face
+    // starts with its smallest index (keeping the orientation), faces are sorted by their indices
+    for (auto& face : faces)
+    {
+        if (face.b < face.a && face.b < face.c)
+            face = { face.b, face.c, face.a };
+        else if (face.c < face.a && face.c < face.b)
+            face = { face.c, face.a, face.b };
+    }
+    std::sort (faces.begin(),
+               faces.end(),
+               [] (const Face& lhs, const Face& rhs) {
+                   return std::tie (lhs.a, lhs.b, lhs.c) < std::tie (rhs.a, rhs.b, rhs.c);
+               });
+
+    // outgoing edges (end point and face) of each vertex, for looking up the face on the other side
+    // of an edge
+    const int n = getNumPoints();
+    std::vector<int> start (static_cast<size_t> (n + 1), 0);
+    for (const auto& face : faces)
+        for (const int v : { face.a, face.b, face.c })
+            ++start[static_cast<size_t> (v + 1)];
+    std::partial_sum (start.begin(), start.end(), start.begin());
+
+    std::vector<Edge> outgoing (3 * faces.size());
+    std::vector<int> position (start.begin(), start.end() - 1);
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+        const auto& face = faces[f];
+        const int edges[3][2] = { { face.a, face.b }, { face.b, face.c }, { face.c, face.a } };
+        for (const auto& edge : edges)
+            outgoing[static_cast<size_t> (position[static_cast<size_t> (edge[0])]++)] =
+                { edge[1], static_cast<int> (f) };
+    }
+
+    const auto neighbour = [&] (const int from, const int to)
+    {
+        for (int k = start[static_cast<size_t> (to)]; k < start[static_cast<size_t> (to + 1)]; ++k)
+            if (outgoing[static_cast<size_t> (k)].first == from)
+                return outgoing[static_cast<size_t> (k)].second;
+        return -1;
+    };
+
+    triangles.clear();
+    triangles.reserve (faces.size());
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+        const auto& face = faces[f];
+        Tri tri (face.a, face.b, face.c);
+        tri.id = static_cast<int> (f);
+        tri.ab = neighbour (face.a, face.b);
+        tri.bc = neighbour (face.b, face.c);
+        tri.ac = neighbour (face.c, face.a);
+
+        double nx, ny, nz;
+        normal (face, nx, ny, nz);
+        tri.er = static_cast<float> (nx);
+        tri.ec = static_cast<float> (ny);
+        tri.ez = static_cast<float> (nz);
+
+        triangles.push_back (tri);
+    }
+}
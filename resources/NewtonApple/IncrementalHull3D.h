@@ -0,0 +1,130 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include "NewtonApple_hull3D.h"
+#include <utility>
+#include <vector>
+
+/**
+ Convex hull of a point set which can be edited point by point.
+
+ build() computes the hull from scratch with NewtonApple_hull_3D. Inserting a point only
+ replaces the faces visible from it, removing a hull vertex only re-triangulates the hole of
+ its adjacent faces (with the hull of the hole's border vertices and the points inside the
+ hull), moving a point is a removal followed by an insertion. The triangles' indices refer to
+ the points in the order they were given, their normals (er, ec, ez) point outwards. Triangles
+ are sorted by their indices, so for the same points they're the same no matter which edits led
+ to them.
+
+ update() compares new points to the current ones and applies a single insertion, removal or a
+ few moves locally, anything else is built from scratch. Whenever a local edit fails or leaves
+ coplanar neighbouring faces or points on the hull's surface (whose triangulation would depend on
+ the order of the edits), the hull is built from scratch as well. Such patches aren't
+ re-triangulated canonically, so layouts with coplanar loudspeakers, e.g. cubes or stacked rings
+ at the same azimuths (whose neighbouring rings form planar quads), always get a full rebuild:
+ update() skips the local edit while the current hull is ambiguous. Local edits only pay off for
+ layouts in general position, like t-designs or irregular domes.
+ */
+class IncrementalHull3D
+{
+public:
+    IncrementalHull3D() = default;
+
+    /** Brings the hull up to date with the given points, returns false if there's no valid hull. */
+    bool update (const std::vector<R3>& newPoints);
+
+    /** Computes the hull from scratch, returns false if there's no valid hull. */
+    bool build (const std::vector<R3>& newPoints);
+
+    bool insertPoint (int index, const R3& point);
+    bool removePoint (int index);
+    bool movePoint (int index, const R3& point);
+
+    bool isValid() const { return valid; }
+    int getNumPoints() const { return static_cast<int> (points.size()); }
+
+    const std::vector<Tri>& getTriangles() const { return triangles; }
+
+private:
+    struct Point
+    {
+        float x, y, z;
+
+        bool operator== (const Point& other) const
+        {
+            return x == other.x && y == other.y && z == other.z;
+        }
+        bool operator!= (const Point& other) const { return ! operator== (other); }
+    };
+
+    struct Face
+    {
+        int a, b, c; // counter-clockwise seen from outside
+    };
+
+    using Edge = std::pair<int, int>; // directed, from first to second
+
+    /** Local edits only for up to this many moved points, otherwise the hull gets rebuilt. */
+    static constexpr int maxNumLocalMoves = 4;
+
+    static Point toPoint (const R3& p) { return { p.x, p.y, p.z }; }
+
+    /** The point as input for NewtonApple_hull_3D, its id is the index. */
+    R3 toR3 (int index) const;
+
+    void normal (const Face& face, double& nx, double& ny, double& nz) const;
+    double signedDistance (const Face& face, const Point& p) const;
+    bool isVisible (const Face& face, const Point& p) const;
+
+    bool buildFromScratch();
+
+    /**
+     Local edits, both return the index of the first new face or -1 if they failed. The new faces
+     are checked to be connected properly to the rest of the hull.
+     */
+    int insertLocally (int index);
+    int removeLocally (int index);
+
+    /** Checks that no point (but the ignored one) lies outside of the new faces. */
+    bool isConvex (int firstNewFace, int ignoredPoint = -1) const;
+
+    static bool contains (const std::vector<Edge>& edges, const Edge& edge);
+    static bool isSingleCycle (const std::vector<Edge>& edges);
+    void shiftIndices (int from, int offset);
+
+    /** Updates the triangles after a successful local edit, or rebuilds if they're ambiguous. */
+    bool finishLocalEdit();
+
+    /** Checks for coplanar neighbouring faces and for points on the hull which aren't vertices. */
+    bool isAmbiguous() const;
+
+    /** Sorts the faces into their canonical order and computes the triangles from them. */
+    void updateTriangles();
+
+    std::vector<Point> points;
+    std::vector<Face> faces;
+    std::vector<Tri> triangles;
+    bool valid = false;
+    bool ambiguous = false; // the last built hull has coplanar neighbouring faces or surface points
+};
@@ -27,6 +27,38 @@ class ReferenceCountedMatrix : public juce::ReferenceCountedObject
 public:
     typedef juce::ReferenceCountedObjectPtr<ReferenceCountedMatrix> Ptr;
 
+    /**
+     Describes which entries of the matrix are non-zero, so MatrixMultiplication can skip the
+     others. A matrix is treated as dense until analyseStructure() is called.
+     */
+    struct Structure
+    {
+        enum class Type
+        {
+            dense,
+            permutation, // each row holds at most one entry, e.g. a channel reordering
+            diagonal, // each row holds at most the entry of its own input channel
+            blockDiagonal, // rows only read the columns of their block, e.g. rotations by order
+            sparse
+        };
+
+        struct Block
+        {
+            int firstRow, numRows, firstColumn, numColumns;
+        };
+
+        Type type = Type::dense;
+
+        // non-zero entries in compressed sparse rows (all types but dense and blockDiagonal), the
+        // entries of row r are at [rowStart[r], rowStart[r + 1])
+        std::vector<int> rowStart;
+        std::vector<int> columns;
+        std::vector<float> values;
+
+        // blockDiagonal only, the entries are read from the matrix
+        std::vector<Block> blocks;
+    };
+
     ReferenceCountedMatrix (const juce::String& nameToUse,
                             const juce::String& descriptionToUse,
                             int rows,
@@ -73,10 +105,148 @@ public:
 
     juce::Array<int>& getRoutingArrayReference() { return routingArray; }
 
+    const Structure& getStructure() const { return structure; }
+
+    /**
+     Classifies the matrix as permutation, diagonal, block-diagonal, sparse or dense, whichever
+     needs the fewest multiplications. Has to be called again after changing the matrix, so only
+     call it for matrices which won't be changed anymore.
+     */
+    void analyseStructure()
+    {
+        const int nRows = static_cast<int> (matrix.getNumRows());
+        const int nCols = static_cast<int> (matrix.getNumColumns());
+
+        Structure newStructure;
+        newStructure.rowStart.reserve (static_cast<size_t> (nRows + 1));
+        newStructure.rowStart.push_back (0);
+
+        bool atMostOnePerRow = true;
+        bool onlyDiagonal = true;
+
+        for (int row = 0; row < nRows; ++row)
+        {
+            for (int col = 0; col < nCols; ++col)
+            {
+                const float value = matrix (row, col);
+                if (value != 0.0f)
+                {
+                    newStructure.columns.push_back (col);
+                    newStructure.values.push_back (value);
+                    onlyDiagonal = onlyDiagonal && col == row;
+                }
+            }
+
+            newStructure.rowStart.push_back (static_cast<int> (newStructure.columns.size()));
+            atMostOnePerRow = atMostOnePerRow
+                              && newStructure.rowStart[static_cast<size_t> (row + 1)]
+                                         - newStructure.rowStart[static_cast<size_t> (row)]
+                                     <= 1;
+        }
+
+        const int numEntries = static_cast<int> (newStructure.columns.size());
+        const int numDenseEntries = nRows * nCols;
+
+        if (onlyDiagonal)
+            newStructure.type = Structure::Type::diagonal;
+        else if (atMostOnePerRow)
+            newStructure.type = Structure::Type::permutation;
+        else
+        {
+            // blocks only pay off if they are mostly filled, otherwise the sparse rows are cheaper
+            newStructure.blocks = findBlocks (newStructure);
+            int numBlocks = 0;
+            int numBlockEntries = 0;
+            for (auto& block : newStructure.blocks)
+            {
+                numBlocks += block.numColumns > 0 ? 1 : 0;
+                numBlockEntries += block.numRows * block.numColumns;
+            }
+
+            if (numBlocks > 1 && 4 * numBlockEntries <= 5 * numEntries)
+                newStructure.type = Structure::Type::blockDiagonal;
+            else if (2 * numEntries <= numDenseEntries)
+                newStructure.type = Structure::Type::sparse;
+            else
+                newStructure.type = Structure::Type::dense;
+
+            if (newStructure.type != Structure::Type::blockDiagonal)
+                newStructure.blocks.clear();
+        }
+
+        if (newStructure.type == Structure::Type::dense
+            || newStructure.type == Structure::Type::blockDiagonal)
+        {
+            newStructure.rowStart.clear();
+            newStructure.columns.clear();
+            newStructure.values.clear();
+        }
+
+        structure = std::move (newStructure);
+    }
+
 protected:
     juce::String name;
     juce::String description;
     juce::dsp::Matrix<float> matrix;
     juce::Array<int> routingArray;
+    Structure structure;
+
+private:
+    /**
+     Splits the rows into the most blocks, so the rows of a block only read columns no other
+     block reads. A block ends after a row, if none of the following rows read any of the columns
+     read so far.
+     */
+    std::vector<Structure::Block> findBlocks (const Structure& sparseRows) const
+    {
+        const int nRows = static_cast<int> (matrix.getNumRows());
+        const int nCols = static_cast<int> (matrix.getNumColumns());
+
+        // smallest column read by any of the rows from r on
+        std::vector<int> minColumnFrom (static_cast<size_t> (nRows + 1), nCols);
+        for (int row = nRows; --row >= 0;)
+        {
+            int minColumn = minColumnFrom[static_cast<size_t> (row + 1)];
+            for (int i = sparseRows.rowStart[static_cast<size_t> (row)];
+                 i < sparseRows.rowStart[static_cast<size_t> (row + 1)];
+                 ++i)
+                minColumn = juce::jmin (minColumn, sparseRows.columns[static_cast<size_t> (i)]);
+            minColumnFrom[static_cast<size_t> (row)] = minColumn;
+        }
+
+        std::vector<Structure::Block> blocks;
+        int firstRow = 0;
+        int maxColumn = -1; // of all rows so far
+        int blockMinColumn = nCols;
+        int blockMaxColumn = -1;
+        for (int row = 0; row < nRows; ++row)
+        {
+            for (int i = sparseRows.rowStart[static_cast<size_t> (row)];
+                 i < sparseRows.rowStart[static_cast<size_t> (row + 1)];
+                 ++i)
+            {
+                const int col = sparseRows.columns[static_cast<size_t> (i)];
+                blockMinColumn = juce::jmin (blockMinColumn, col);
+                blockMaxColumn = juce::jmax (blockMaxColumn, col);
+            }
+            maxColumn = juce::jmax (maxColumn, blockMaxColumn);
+
+            if (maxColumn < minColumnFrom[static_cast<size_t> (row + 1)])
+            {
+                const bool isEmpty = blockMaxColumn < 0;
+                blocks.push_back ({ firstRow,
+                                    row + 1 - firstRow,
+                                    isEmpty ? 0 : blockMinColumn,
+                                    isEmpty ? 0 : blockMaxColumn + 1 - blockMinColumn });
+                firstRow = row + 1;
+                blockMinColumn = nCols;
+                blockMaxColumn = -1;
+            }
+        }
+
+        return blocks;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReferenceCountedMatrix)
 };
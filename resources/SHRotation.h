@@ -0,0 +1,189 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstdlib>
+
+/**
+ Calculates the real spherical harmonics rotation matrices for each order (ACN ordering) from a
+ 3x3 cartesian rotation matrix, using the recursion by Ivanic and Ruedenberg. Rotating an
+ Ambisonic signal with these matrices moves a source from direction v to rotMat * v.
+ */
+class SHRotation
+{
+public:
+    /**
+     Fills orderMatrices[1] ... orderMatrices[order] with the (2l+1)x(2l+1) rotation matrices.
+     The array has to hold matrices with the right sizes, orderMatrices[0] is not touched.
+     */
+    static void calcRotationMatrices (const juce::dsp::Matrix<float>& rotMat,
+                                      juce::OwnedArray<juce::dsp::Matrix<float>>& orderMatrices,
+                                      const int order)
+    {
+        auto Rl = orderMatrices[1];
+
+        Rl->operator() (0, 0) = rotMat (1, 1);
+        Rl->operator() (0, 1) = rotMat (1, 2);
+        Rl->operator() (0, 2) = rotMat (1, 0);
+        Rl->operator() (1, 0) = rotMat (2, 1);
+        Rl->operator() (1, 1) = rotMat (2, 2);
+        Rl->operator() (1, 2) = rotMat (2, 0);
+        Rl->operator() (2, 0) = rotMat (0, 1);
+        Rl->operator() (2, 1) = rotMat (0, 2);
+        Rl->operator() (2, 2) = rotMat (0, 0);
+
+        for (int l = 2; l <= order; ++l)
+        {
+            auto Rone = orderMatrices[1];
+            auto Rlm1 = orderMatrices[l - 1];
+            auto Rl = orderMatrices[l];
+            for (int m = -l; m <= l; ++m)
+            {
+                for (int n = -l; n <= l; ++n)
+                {
+                    const int d = (m == 0) ? 1 : 0;
+                    double denom;
+                    if (abs (n) == l)
+                        denom = (2 * l) * (2 * l - 1);
+                    else
+                        denom = l * l - n * n;
+
+                    double u = sqrt ((l * l - m * m) / denom);
+                    double v = sqrt ((1.0 + d) * (l + abs (m) - 1.0) * (l + abs (m)) / denom)
+                               * (1.0 - 2.0 * d) * 0.5;
+                    double w =
+                        sqrt ((l - abs (m) - 1.0) * (l - abs (m)) / denom) * (1.0 - d) * (-0.5);
+
+                    if (u != 0.0)
+                        u *= U (l, m, n, *Rone, *Rlm1);
+                    if (v != 0.0)
+                        v *= V (l, m, n, *Rone, *Rlm1);
+                    if (w != 0.0)
+                        w *= W (l, m, n, *Rone, *Rlm1);
+
+                    Rl->operator() (m + l, n + l) = u + v + w;
+                }
+            }
+        }
+    }
+
+    /**
+     Returns the rotation matrix which rotates the north pole (0, 0, 1) to the direction given by
+     azimuth and elevation.
+     */
+    static juce::dsp::Matrix<float> rotationFromNorthPole (const float azimuthInRadians,
+                                                           const float elevationInRadians)
+    {
+        const float ca = std::cos (azimuthInRadians);
+        const float sa = std::sin (azimuthInRadians);
+        const float cb = std::sin (elevationInRadians); // cos (pi/2 - elevation)
+        const float sb = std::cos (elevationInRadians); // sin (pi/2 - elevation)
+
+        // rotation around y by (pi/2 - elevation) followed by rotation around z by azimuth
+        juce::dsp::Matrix<float> rotMat (3, 3);
+        rotMat (0, 0) = ca * cb;
+        rotMat (0, 1) = -sa;
+        rotMat (0, 2) = ca * sb;
+        rotMat (1, 0) = sa * cb;
+        rotMat (1, 1) = ca;
+        rotMat (1, 2) = sa * sb;
+        rotMat (2, 0) = -sb;
+        rotMat (2, 1) = 0.0f;
+        rotMat (2, 2) = cb;
+        return rotMat;
+    }
+
+private:
+    static double P (int i,
+                     int l,
+                     int a,
+                     int b,
+                     juce::dsp::Matrix<float>& R1,
+                     juce::dsp::Matrix<float>& Rlm1)
+    {
+        double ri1 = R1 (i + 1, 2);
+        double rim1 = R1 (i + 1, 0);
+        double ri0 = R1 (i + 1, 1);
+
+        if (b == -l)
+            return ri1 * Rlm1 (a + l - 1, 0) + rim1 * Rlm1 (a + l - 1, 2 * l - 2);
+        else if (b == l)
+            return ri1 * Rlm1 (a + l - 1, 2 * l - 2) - rim1 * Rlm1 (a + l - 1, 0);
+        else
+            return ri0 * Rlm1 (a + l - 1, b + l - 1);
+    }
+
+    static double
+        U (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        return P (0, l, m, n, Rone, Rlm1);
+    }
+
+    static double
+        V (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m == 0)
+        {
+            auto p0 = P (1, l, 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, -1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m > 0)
+        {
+            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
+            if (m == 1) // d = 1;
+                return p0 * sqrt (2);
+            else // d = 0;
+                return p0 - P (-1, l, 1 - m, n, Rone, Rlm1);
+        }
+        else
+        {
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            if (m == -1) // d = 1;
+                return p1 * sqrt (2);
+            else // d = 0;
+                return p1 + P (1, l, m + 1, n, Rone, Rlm1);
+        }
+    }
+
+    static double
+        W (int l, int m, int n, juce::dsp::Matrix<float>& Rone, juce::dsp::Matrix<float>& Rlm1)
+    {
+        if (m > 0)
+        {
+            auto p0 = P (1, l, m + 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, -m - 1, n, Rone, Rlm1);
+            return p0 + p1;
+        }
+        else if (m < 0)
+        {
+            auto p0 = P (1, l, m - 1, n, Rone, Rlm1);
+            auto p1 = P (-1, l, 1 - m, n, Rone, Rlm1);
+            return p0 - p1;
+        }
+
+        return 0.0;
+    }
+};
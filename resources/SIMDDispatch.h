@@ -0,0 +1,148 @@
+/*
+ ==============================================================================
+ This file is part of the IEM plug-in suite.
+ Author: Daniel Rudrich
+ Copyright (c) 2018 - Institute of Electronic Music and Acoustics (IEM)
+ https://iem.at
+
+ The IEM plug-in suite is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ The IEM plug-in suite is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this software.  If not, see <https://www.gnu.org/licenses/>.
+ ==============================================================================
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/*
+ Runtime dispatch between SIMD instruction set tiers.
+
+ juce::dsp::SIMDRegister is fixed at compile time (SSE on x86-64, NEON on arm64). Kernels which
+ profit from wider registers get compiled additionally for AVX2 and AVX-512 (selected with the
+ IEM_SIMD_TIERS CMake option) and the best tier supported by the CPU gets chosen at runtime.
+ The kernels are written once as templates over one of the vector types below and instantiated
+ inside functions carrying the IEM_TARGET_* attribute.
+ */
+
+#if ! (defined(__x86_64__) || defined(_M_X64))
+    #undef IEM_SIMD_AVX2
+    #undef IEM_SIMD_AVX512
+#endif
+
+#ifndef IEM_SIMD_AVX2
+    #define IEM_SIMD_AVX2 0
+#endif
+
+#ifndef IEM_SIMD_AVX512
+    #define IEM_SIMD_AVX512 0
+#endif
+
+#if IEM_SIMD_AVX2 || IEM_SIMD_AVX512
+    #include <immintrin.h>
+#endif
+
+#if JUCE_GCC || JUCE_CLANG
+    #define IEM_TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+    #define IEM_TARGET_AVX512 __attribute__ ((target ("avx512f")))
+#else
+    #define IEM_TARGET_AVX2
+    #define IEM_TARGET_AVX512
+#endif
+
+namespace iem
+{
+enum class SIMDTier
+{
+    generic, // juce::dsp::SIMDRegister (SSE, NEON) or plain floats
+    avx2,
+    avx512
+};
+
+/** Returns the widest tier which is both compiled in and supported by the CPU. */
+inline SIMDTier getBestSIMDTier()
+{
+#if IEM_SIMD_AVX512
+    if (juce::SystemStats::hasAVX512F())
+        return SIMDTier::avx512;
+#endif
+#if IEM_SIMD_AVX2
+    if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+        return SIMDTier::avx2;
+#endif
+    return SIMDTier::generic;
+}
+
+inline const char* getSIMDTierName (const SIMDTier tier)
+{
+    switch (tier)
+    {
+        case SIMDTier::avx512:
+            return "AVX-512";
+        case SIMDTier::avx2:
+            return "AVX2";
+        default:
+            return "generic";
+    }
+}
+
+//==============================================================================
+/** Vector types used by the dispatched kernels, all loads and stores have to be aligned. */
+struct SIMDGeneric
+{
+#if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<float>;
+    static constexpr int size = static_cast<int> (Vector::size());
+    static forcedinline Vector broadcast (const float value) { return Vector::expand (value); }
+    static forcedinline Vector load (const float* ptr) { return Vector::fromRawArray (ptr); }
+    static forcedinline void store (const Vector& value, float* ptr) { value.copyToRawArray (ptr); }
+#else /* !JUCE_USE_SIMD */
+    using Vector = float;
+    static constexpr int size = 1;
+    static forcedinline Vector broadcast (const float value) { return value; }
+    static forcedinline Vector load (const float* ptr) { return *ptr; }
+    static forcedinline void store (const Vector& value, float* ptr) { *ptr = value; }
+#endif /* JUCE_USE_SIMD */
+    static forcedinline Vector add (const Vector& a, const Vector& b) { return a + b; }
+    static forcedinline Vector sub (const Vector& a, const Vector& b) { return a - b; }
+    static forcedinline Vector mul (const Vector& a, const Vector& b) { return a * b; }
+};
+
+#if IEM_SIMD_AVX2
+struct SIMDAVX2
+{
+    using Vector = __m256;
+    static constexpr int size = 8;
+    IEM_TARGET_AVX2 static Vector broadcast (const float v) { return _mm256_set1_ps (v); }
+    IEM_TARGET_AVX2 static Vector load (const float* ptr) { return _mm256_load_ps (ptr); }
+    IEM_TARGET_AVX2 static void store (Vector v, float* ptr) { _mm256_store_ps (ptr, v); }
+    IEM_TARGET_AVX2 static Vector add (Vector a, Vector b) { return _mm256_add_ps (a, b); }
+    IEM_TARGET_AVX2 static Vector sub (Vector a, Vector b) { return _mm256_sub_ps (a, b); }
+    IEM_TARGET_AVX2 static Vector mul (Vector a, Vector b) { return _mm256_mul_ps (a, b); }
+};
+#endif /* IEM_SIMD_AVX2 */
+
+#if IEM_SIMD_AVX512
+struct SIMDAVX512
+{
+    using Vector = __m512;
+    static constexpr int size = 16;
+    IEM_TARGET_AVX512 static Vector broadcast (const float v) { return _mm512_set1_ps (v); }
+    IEM_TARGET_AVX512 static Vector load (const float* ptr) { return _mm512_load_ps (ptr); }
+    IEM_TARGET_AVX512 static void store (Vector v, float* ptr) { _mm512_store_ps (ptr, v); }
+    IEM_TARGET_AVX512 static Vector add (Vector a, Vector b) { return _mm512_add_ps (a, b); }
+    IEM_TARGET_AVX512 static Vector sub (Vector a, Vector b) { return _mm512_sub_ps (a, b); }
+    IEM_TARGET_AVX512 static Vector mul (Vector a, Vector b) { return _mm512_mul_ps (a, b); }
+};
+#endif /* IEM_SIMD_AVX512 */
+
+} // namespace iem